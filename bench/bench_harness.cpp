@@ -0,0 +1,369 @@
+#include "bench_harness.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define IO1_BENCH_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define IO1_BENCH_TSC 1
+#else
+#define IO1_BENCH_TSC 0
+#endif
+
+namespace
+{
+  // Allocations of the whole program, counted by the replacements of operator new below.
+  std::atomic<std::uint64_t> allocation_count{0};
+  std::atomic<std::uint64_t> allocation_bytes{0};
+
+  void * allocate(std::size_t size, std::size_t alignment) noexcept
+  {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    size = std::max<std::size_t>(size, 1);
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) { return std::malloc(size); }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+  }
+
+  void deallocate(void * p, std::size_t alignment) noexcept
+  {
+#ifdef _WIN32
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+      _aligned_free(p);
+      return;
+    }
+#else
+    static_cast<void>(alignment);
+#endif
+    std::free(p);
+  }
+
+  void * allocate_or_throw(std::size_t size, std::size_t alignment)
+  {
+    if (auto * const p = allocate(size, alignment)) { return p; }
+    throw std::bad_alloc();
+  }
+} // namespace
+
+// NOLINTBEGIN(misc-new-delete-overloads)
+void * operator new(std::size_t size) { return allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void * operator new[](std::size_t size) { return allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void * operator new(std::size_t size, std::align_val_t al)
+{
+  return allocate_or_throw(size, static_cast<std::size_t>(al));
+}
+void * operator new[](std::size_t size, std::align_val_t al)
+{
+  return allocate_or_throw(size, static_cast<std::size_t>(al));
+}
+void * operator new(std::size_t size, std::nothrow_t const &) noexcept
+{
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void * operator new[](std::size_t size, std::nothrow_t const &) noexcept
+{
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void operator delete(void * p) noexcept { deallocate(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void * p) noexcept { deallocate(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void * p, std::size_t) noexcept { deallocate(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void * p, std::size_t) noexcept { deallocate(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void * p, std::align_val_t al) noexcept { deallocate(p, static_cast<std::size_t>(al)); }
+void operator delete[](void * p, std::align_val_t al) noexcept { deallocate(p, static_cast<std::size_t>(al)); }
+void operator delete(void * p, std::size_t, std::align_val_t al) noexcept
+{
+  deallocate(p, static_cast<std::size_t>(al));
+}
+void operator delete[](void * p, std::size_t, std::align_val_t al) noexcept
+{
+  deallocate(p, static_cast<std::size_t>(al));
+}
+// NOLINTEND(misc-new-delete-overloads)
+
+namespace bench
+{
+  namespace
+  {
+    std::vector<benchmark> & benchmarks()
+    {
+      static std::vector<benchmark> all;
+      return all;
+    }
+
+    // Time stamp counter: reference cycles, at a constant rate whatever the frequency of the core.
+    std::uint64_t cycles() noexcept
+    {
+#if IO1_BENCH_TSC
+      return __rdtsc();
+#else
+      return 0;
+#endif
+    }
+
+    struct options
+    {
+      std::string filter;
+      std::size_t samples{15};
+      std::chrono::nanoseconds min_sample_time{std::chrono::milliseconds{20}};
+      std::string json; // output file, - for the standard output
+      bool list{false};
+    };
+
+    struct statistics
+    {
+      double median;
+      double minimum;
+      double mean;
+      double deviation; // standard deviation
+    };
+
+    struct result
+    {
+      std::string name;
+      std::uint64_t items;
+      std::uint64_t iterations; // per sample
+      std::size_t samples;
+      statistics nanoseconds;   // per item
+      double cycles;            // per item, median, negative without cycle counter
+      double allocations;       // per item
+      double allocated_bytes;   // per item
+    };
+
+    [[nodiscard]] double median(std::vector<double> values)
+    {
+      auto const middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+      std::ranges::nth_element(values, middle);
+      if (0 != values.size() % 2) { return *middle; }
+      return (*middle + *std::max_element(values.begin(), middle)) / 2;
+    }
+
+    [[nodiscard]] statistics summarize(std::vector<double> const & values)
+    {
+      auto const mean = std::accumulate(values.begin(), values.end(), 0.) / static_cast<double>(values.size());
+      auto const squares = std::accumulate(values.begin(), values.end(), 0.,
+                                           [mean](double sum, double v) { return sum + (v - mean) * (v - mean); });
+      return {.median = median(values),
+              .minimum = std::ranges::min(values),
+              .mean = mean,
+              .deviation = 1 < values.size() ? std::sqrt(squares / static_cast<double>(values.size() - 1)) : 0.};
+    }
+
+    [[nodiscard]] result run(benchmark const & b, options const & opts)
+    {
+      auto const body = b.make();
+      body(1); // warm up caches and lazy initializations
+
+      // iterations such that a sample lasts at least min_sample_time
+      std::uint64_t iterations = 1;
+      for (;;)
+      {
+        auto const start = std::chrono::steady_clock::now();
+        body(iterations);
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed >= opts.min_sample_time) { break; }
+        auto const ratio = static_cast<double>(opts.min_sample_time.count()) /
+                           static_cast<double>(std::max<std::chrono::nanoseconds::rep>(elapsed.count(), 1));
+        iterations = static_cast<std::uint64_t>(static_cast<double>(iterations) * std::clamp(ratio * 1.2, 2., 100.));
+      }
+
+      auto const per_item = static_cast<double>(iterations * b.items);
+      std::vector<double> times;
+      std::vector<double> cycle_counts;
+      std::uint64_t allocations = 0;
+      std::uint64_t bytes = 0;
+      for (std::size_t s = 0; s < opts.samples; ++s)
+      {
+        auto const count_before = allocation_count.load(std::memory_order_relaxed);
+        auto const bytes_before = allocation_bytes.load(std::memory_order_relaxed);
+        clobber_memory();
+        auto const start = std::chrono::steady_clock::now();
+        auto const start_cycles = cycles();
+        body(iterations);
+        auto const end_cycles = cycles();
+        auto const end = std::chrono::steady_clock::now();
+        clobber_memory();
+        allocations += allocation_count.load(std::memory_order_relaxed) - count_before;
+        bytes += allocation_bytes.load(std::memory_order_relaxed) - bytes_before;
+
+        times.push_back(std::chrono::duration<double, std::nano>(end - start).count() / per_item);
+        cycle_counts.push_back(static_cast<double>(end_cycles - start_cycles) / per_item);
+      }
+
+      auto const all_items = per_item * static_cast<double>(opts.samples);
+      return {.name = b.name,
+              .items = b.items,
+              .iterations = iterations,
+              .samples = opts.samples,
+              .nanoseconds = summarize(times),
+              .cycles = IO1_BENCH_TSC ? median(cycle_counts) : -1.,
+              .allocations = static_cast<double>(allocations) / all_items,
+              .allocated_bytes = static_cast<double>(bytes) / all_items};
+    }
+
+    [[nodiscard]] std::string json_string(std::string_view s)
+    {
+      std::string out = "\"";
+      for (auto const c : s)
+      {
+        if ('"' == c || '\\' == c) { out += '\\'; }
+        out += c;
+      }
+      return out + '"';
+    }
+
+    [[nodiscard]] std::string number(double value)
+    {
+      char buffer[32]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+      return buffer;
+    }
+
+    void write_json(std::ostream & out, std::vector<result> const & results)
+    {
+#if defined(__clang__)
+      std::string const compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+      std::string const compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+      std::string const compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+      std::string const compiler = "unknown";
+#endif
+#ifdef NDEBUG
+      constexpr bool assertions = false;
+#else
+      constexpr bool assertions = true;
+#endif
+
+      out << "{\n  \"context\": {\n"
+          << "    \"date\": " << std::time(nullptr) << ",\n"
+          << "    \"compiler\": " << json_string(compiler) << ",\n"
+          << "    \"assertions\": " << (assertions ? "true" : "false") << ",\n"
+          << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+          << "    \"cycle_counter\": " << (IO1_BENCH_TSC ? "\"tsc\"" : "null") << "\n  },\n"
+          << "  \"benchmarks\": [";
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+        auto const & r = results[i];
+        out << (0 == i ? "\n" : ",\n") << "    {\"name\": " << json_string(r.name) << ", \"items\": " << r.items
+            << ", \"iterations\": " << r.iterations << ", \"samples\": " << r.samples
+            << ", \"ns_per_op\": {\"median\": " << number(r.nanoseconds.median)
+            << ", \"min\": " << number(r.nanoseconds.minimum) << ", \"mean\": " << number(r.nanoseconds.mean)
+            << ", \"stddev\": " << number(r.nanoseconds.deviation) << "}"
+            << ", \"cycles_per_op\": " << (r.cycles < 0 ? std::string("null") : number(r.cycles))
+            << ", \"allocations_per_op\": " << number(r.allocations)
+            << ", \"bytes_per_op\": " << number(r.allocated_bytes) << "}";
+      }
+      out << "\n  ]\n}\n";
+    }
+
+    void write_row(result const & r)
+    {
+      auto const spread = 0 < r.nanoseconds.median ? 100 * r.nanoseconds.deviation / r.nanoseconds.median : 0.;
+      std::printf("%-40s %12.3f %7.1f%% %12s %10.3f %12llu\n", r.name.c_str(), r.nanoseconds.median, spread,
+                  r.cycles < 0 ? "-" : number(r.cycles).c_str(), r.allocations,
+                  static_cast<unsigned long long>(r.iterations));
+      std::fflush(stdout);
+    }
+
+    [[nodiscard]] bool parse(int argc, char ** argv, options & opts)
+    {
+      for (int i = 1; i < argc; ++i)
+      {
+        std::string_view const arg = argv[i];
+        auto const value = [arg](std::string_view key) { return arg.substr(key.size()); };
+        if (arg.starts_with("--filter=")) { opts.filter = value("--filter="); }
+        else if (arg.starts_with("--samples="))
+        {
+          opts.samples = std::max<std::size_t>(1, std::stoul(std::string(value("--samples="))));
+        }
+        else if (arg.starts_with("--min-time-ms="))
+        {
+          opts.min_sample_time = std::chrono::milliseconds{std::stoul(std::string(value("--min-time-ms=")))};
+        }
+        else if (arg.starts_with("--json=")) { opts.json = value("--json="); }
+        else if ("--list" == arg) { opts.list = true; }
+        else
+        {
+          std::cerr << "usage: " << argv[0]
+                    << " [--filter=<substring>] [--samples=<count>] [--min-time-ms=<ms>] [--json=<file>|-] [--list]\n";
+          return false;
+        }
+      }
+      return true;
+    }
+  } // namespace
+
+  void add(std::string name, std::uint64_t items, factory make)
+  {
+    benchmarks().push_back({.name = std::move(name), .items = items, .make = std::move(make)});
+  }
+} // namespace bench
+
+int main(int argc, char ** argv)
+{
+  bench::options opts;
+  if (!bench::parse(argc, argv, opts)) { return EXIT_FAILURE; }
+
+  bench::register_benchmarks();
+  std::vector<bench::benchmark const *> selected;
+  for (auto const & b : bench::benchmarks())
+  {
+    if (b.name.find(opts.filter) != std::string::npos) { selected.push_back(&b); }
+  }
+
+  if (opts.list)
+  {
+    for (auto const * b : selected) { std::cout << b->name << '\n'; }
+    return EXIT_SUCCESS;
+  }
+
+  auto const quiet = "-" == opts.json;
+  if (!quiet)
+  {
+    std::printf("%-40s %12s %8s %12s %10s %12s\n", "benchmark", "ns/op", "stddev", "cycles/op", "allocs/op",
+                "iterations");
+  }
+
+  std::vector<bench::result> results;
+  for (auto const * b : selected)
+  {
+    results.push_back(bench::run(*b, opts));
+    if (!quiet) { bench::write_row(results.back()); }
+  }
+
+  if (quiet) { bench::write_json(std::cout, results); }
+  else if (!opts.json.empty())
+  {
+    std::ofstream file(opts.json);
+    bench::write_json(file, results);
+    if (!file)
+    {
+      std::cerr << "cannot write " << opts.json << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// A self-contained benchmark harness: each benchmark is timed over several samples of a calibrated number of
+// iterations, and reported per item with its time, its cycles and its allocations.
+namespace bench
+{
+  // Keep the compiler from optimizing value, or the computation of value, away.
+  template <class T>
+  inline void do_not_optimize(T const & value) noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(const_cast<T const volatile &>(value));
+#endif
+  }
+
+  // Keep the compiler from assuming anything about memory across this point.
+  inline void clobber_memory() noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+  }
+
+  // A benchmark body runs its operation `iterations` times. Its setup is done by the factory returning it, untimed.
+  using body = std::function<void(std::uint64_t iterations)>;
+  using factory = std::function<body()>;
+
+  struct benchmark
+  {
+    std::string name;
+    std::uint64_t items; // processed by one iteration: results are per item
+    factory make;
+  };
+
+  void add(std::string name, std::uint64_t items, factory make);
+
+  // Defined by the benchmarks, which call add for each of them.
+  void register_benchmarks();
+} // namespace bench
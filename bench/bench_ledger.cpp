@@ -0,0 +1,499 @@
+// End-to-end ledger workload: parse a statement, convert its amounts, aggregate them by account, compute running
+// balances and format a report, for several thread counts.
+
+#include "bench_harness.hpp"
+
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money.hpp"
+#include "io1/money_currency.hpp"
+#include "io1/money_fx.hpp"
+#include "io1/money_profile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+  enum class distribution
+  {
+    uniform,   // uniform between -1000 and 1000 major units
+    lognormal, // mostly small payments with a long tail, 10% of credits
+    pareto     // a few huge amounts dominating the totals, 10% of credits
+  };
+
+  struct workload
+  {
+    std::size_t rows{1'000'000};
+    std::uint32_t accounts{10'000};
+    distribution amounts{distribution::lognormal};
+    std::vector<io1::currency_info const *> currencies{io1::find_currency("USD"), io1::find_currency("EUR"),
+                                                       io1::find_currency("GBP"), io1::find_currency("JPY")};
+    io1::currency_info const * report_currency{io1::find_currency("USD")};
+    io1::format_profile const * profile{io1::find_profile("en_US")};
+    std::uint64_t seed{42};
+    std::vector<std::size_t> threads{};
+    std::size_t repetitions{5};
+  };
+
+  // Statement lines are `date;account;currency;amount`, e.g. `2024-01-31;1234;EUR;-12.30`, sorted by date.
+  std::string generate_statement(workload const & w)
+  {
+    std::mt19937_64 gen(w.seed);
+    std::uniform_int_distribution<std::uint32_t> accounts(0, w.accounts - 1);
+    std::uniform_int_distribution<std::size_t> currencies(0, w.currencies.size() - 1);
+    std::uniform_real_distribution<double> uniform(-1'000., 1'000.);
+    std::lognormal_distribution<double> lognormal(3., 1.5);
+    std::uniform_real_distribution<double> unit(0., 1.);
+    auto const major_units = [&]() -> double
+    {
+      auto const sign = unit(gen) < 0.1 ? 1. : -1.;
+      switch (w.amounts)
+      {
+      case distribution::uniform: return uniform(gen);
+      case distribution::lognormal: return sign * lognormal(gen);
+      case distribution::pareto: return sign * std::min(1e9, 10. / std::pow(1. - unit(gen), 1. / 1.2));
+      }
+      return 0.;
+    };
+
+    std::string text;
+    text.reserve(w.rows * 32);
+    std::chrono::sys_days date = std::chrono::year{2024} / 1 / 1;
+    auto const rows_per_day = std::max<std::size_t>(1, w.rows / 365);
+    char buffer[64]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    for (std::size_t i = 0; i < w.rows; ++i)
+    {
+      if (0 != i && 0 == i % rows_per_day) { date += std::chrono::days{1}; }
+      std::chrono::year_month_day const ymd{date};
+      auto const & currency = *w.currencies[currencies(gen)];
+      auto const minor = std::llround(major_units() * std::pow(10., currency.minor_unit));
+
+      auto * p = std::to_chars(buffer, buffer + 5, static_cast<int>(ymd.year())).ptr;
+      *p++ = '-';
+      *p++ = static_cast<char>('0' + static_cast<unsigned>(ymd.month()) / 10);
+      *p++ = static_cast<char>('0' + static_cast<unsigned>(ymd.month()) % 10);
+      *p++ = '-';
+      *p++ = static_cast<char>('0' + static_cast<unsigned>(ymd.day()) / 10);
+      *p++ = static_cast<char>('0' + static_cast<unsigned>(ymd.day()) % 10);
+      *p++ = ';';
+      p = std::to_chars(p, buffer + sizeof(buffer), accounts(gen)).ptr;
+      *p++ = ';';
+      p = std::ranges::copy(currency.code, p).out;
+      *p++ = ';';
+      p = io1::detail::to_decimal_chars(p, buffer + sizeof(buffer), minor, currency.minor_unit).ptr;
+      *p++ = '\n';
+      text.append(buffer, p);
+    }
+    return text;
+  }
+
+  // Exact rates of the currencies of the workload against the first one, as a bank would publish them.
+  io1::fx_table generate_rates(workload const & w)
+  {
+    std::mt19937_64 gen(w.seed + 1);
+    std::uniform_int_distribution<std::int64_t> rates(1'000, 200'000);
+    io1::fx_table table(w.currencies.front()->numeric);
+    auto const add = [&](io1::currency_info const * c)
+    {
+      if (c->numeric != table.pivot()) { table.set_rate(c->numeric, {rates(gen), 100'000}); }
+    };
+    std::ranges::for_each(w.currencies, add);
+    add(w.report_currency);
+    return table;
+  }
+
+  struct ledger
+  {
+    std::vector<std::chrono::sys_days> dates;
+    std::vector<std::uint32_t> accounts;
+    std::vector<std::uint16_t> currencies;
+    std::vector<io1::money> amounts;
+    std::vector<io1::money> converted;
+    std::vector<io1::money> totals;   // per account
+    std::vector<io1::money> balances; // per row, of its account after it
+
+    std::vector<std::vector<io1::money>> chunk_totals; // per worker and account
+    std::vector<std::string> report;                   // per worker
+  };
+
+  [[noreturn]] void malformed(std::size_t line)
+  {
+    throw std::runtime_error("bench_ledger: malformed statement line " + std::to_string(line) + ".");
+  }
+
+  template <class T>
+  char const * read_integer(char const * first, char const * last, T & value, char separator, std::size_t line)
+  {
+    auto const [p, ec] = std::from_chars(first, last, value);
+    if (std::errc{} != ec || p == last || separator != *p) { malformed(line); }
+    return p + 1;
+  }
+
+  // Lines of the statement are counted then parsed in parallel, each worker starting at the first line of its byte
+  // range.
+  void parse(std::string_view text, std::size_t workers, ledger & l)
+  {
+    auto const line_start = [text](std::size_t offset)
+    {
+      if (0 == offset) { return std::size_t{0}; }
+      auto const end = text.find('\n', offset - 1);
+      return std::string_view::npos == end ? text.size() : end + 1;
+    };
+
+    std::vector<std::size_t> firsts(workers + 1, 0); // first row of each worker
+    io1::detail::parallel_chunks(text.size(), workers,
+                                 [&](std::size_t w, std::size_t begin, std::size_t end)
+                                 {
+                                   begin = line_start(begin);
+                                   end = line_start(end);
+                                   firsts[w + 1] = static_cast<std::size_t>(
+                                       std::count(text.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                  text.begin() + static_cast<std::ptrdiff_t>(end), '\n'));
+                                 });
+    for (std::size_t w = 0; w < workers; ++w) { firsts[w + 1] += firsts[w]; }
+
+    auto const rows = firsts.back();
+    l.dates.resize(rows);
+    l.accounts.resize(rows);
+    l.currencies.resize(rows);
+    l.amounts.resize(rows);
+    io1::detail::parallel_chunks(
+        text.size(), workers,
+        [&](std::size_t w, std::size_t begin, std::size_t end)
+        {
+          auto const * p = text.data() + line_start(begin);
+          auto const * const last = text.data() + line_start(end);
+          io1::currency_info const * currency = nullptr;
+          for (auto row = firsts[w]; p != last; ++row)
+          {
+            int year = 0;
+            unsigned month = 0;
+            unsigned day = 0;
+            p = read_integer(p, last, year, '-', row);
+            p = read_integer(p, last, month, '-', row);
+            p = read_integer(p, last, day, ';', row);
+            l.dates[row] = std::chrono::year{year} / static_cast<int>(month) / static_cast<int>(day);
+            p = read_integer(p, last, l.accounts[row], ';', row);
+
+            if (last - p < 4 || ';' != p[3]) { malformed(row); }
+            std::string_view const code(p, 3);
+            if (nullptr == currency || code != currency->code) { currency = io1::find_currency(code); }
+            if (nullptr == currency) { malformed(row); }
+            l.currencies[row] = currency->numeric;
+            p += 4;
+
+            io1::money::value_type amount = 0;
+            auto const [next, ec] = io1::detail::from_decimal_chars(p, last, amount, currency->minor_unit);
+            if (std::errc{} != ec || next == last || '\n' != *next) { malformed(row); }
+            l.amounts[row] = io1::money{amount};
+            p = next + 1;
+          }
+        });
+  }
+
+  void convert(io1::fx_table const & table, workload const & w, std::size_t workers, ledger & l)
+  {
+    l.converted.resize(l.amounts.size());
+    table.convert(l.amounts, l.currencies, w.report_currency->numeric, l.converted, io1::rounding::half_even,
+                  workers);
+  }
+
+  // Totals of each chunk of rows, kept for the running balances, summed in worker order.
+  void aggregate(workload const & w, std::size_t workers, ledger & l)
+  {
+    l.chunk_totals.resize(workers);
+    io1::detail::parallel_chunks(l.converted.size(), workers,
+                                 [&](std::size_t k, std::size_t begin, std::size_t end)
+                                 {
+                                   auto & totals = l.chunk_totals[k];
+                                   totals.assign(w.accounts, io1::money{0});
+                                   for (auto i = begin; i < end; ++i) { totals[l.accounts[i]] += l.converted[i]; }
+                                 });
+
+    l.totals.assign(w.accounts, io1::money{0});
+    for (auto const & totals : l.chunk_totals)
+    {
+      for (std::uint32_t a = 0; a < w.accounts; ++a) { l.totals[a] += totals[a]; }
+    }
+  }
+
+  // Each chunk starts from the totals of the previous ones: an exclusive scan of the chunk totals per account.
+  void running_balances(workload const & w, std::size_t workers, ledger & l)
+  {
+    l.balances.resize(l.converted.size());
+    std::vector<io1::money> carry(w.accounts, io1::money{0});
+    for (auto & totals : l.chunk_totals)
+    {
+      for (std::uint32_t a = 0; a < w.accounts; ++a)
+      {
+        auto const total = totals[a];
+        totals[a] = carry[a];
+        carry[a] += total;
+      }
+    }
+
+    io1::detail::parallel_chunks(l.converted.size(), workers,
+                                 [&](std::size_t k, std::size_t begin, std::size_t end)
+                                 {
+                                   auto & balance = l.chunk_totals[k];
+                                   for (auto i = begin; i < end; ++i)
+                                   {
+                                     l.balances[i] = balance[l.accounts[i]] += l.converted[i];
+                                   }
+                                 });
+  }
+
+  // One line per row: `date account amount balance`, amounts laid out by the profile with the report currency.
+  void format_report(workload const & w, std::size_t workers, ledger & l)
+  {
+    auto const & profile = *w.profile;
+    auto const & currency = *w.report_currency;
+    l.report.resize(workers);
+    io1::detail::parallel_chunks(l.converted.size(), workers,
+                                 [&](std::size_t k, std::size_t begin, std::size_t end)
+                                 {
+                                   auto & out = l.report[k];
+                                   out.clear();
+                                   out.reserve((end - begin) * 64);
+                                   char buffer[128]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+                                   auto * const last = buffer + sizeof(buffer) - 1; // keeps room for a separator
+                                   for (auto i = begin; i < end; ++i)
+                                   {
+                                     auto * p = std::to_chars(buffer, last, l.dates[i].time_since_epoch().count()).ptr;
+                                     *p++ = ' ';
+                                     p = std::to_chars(p, last, l.accounts[i]).ptr;
+                                     *p++ = ' ';
+                                     p = io1::to_chars(p, last, l.converted[i], profile, currency, true).ptr;
+                                     *p++ = ' ';
+                                     p = io1::to_chars(p, last, l.balances[i], profile, currency, true).ptr;
+                                     *p++ = '\n';
+                                     out.append(buffer, p);
+                                   }
+                                 });
+  }
+
+  [[nodiscard]] std::size_t peak_memory() noexcept
+  {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (0 == GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (0 != getrusage(RUSAGE_SELF, &usage)) { return 0; }
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1'024;
+#endif
+#endif
+  }
+
+  constexpr std::string_view stage_names[] = {"parse", "convert", "aggregate", "balances", "report"};
+  constexpr std::size_t stage_count = std::size(stage_names);
+
+  struct measure
+  {
+    std::size_t threads;
+    double seconds[stage_count]; // NOLINT(cppcoreguidelines-avoid-c-arrays) median of the repetitions
+    std::uint64_t checksum;      // of the balances and the report, identical whatever the thread count
+  };
+
+  measure run(workload const & w, std::string_view statement, io1::fx_table const & table, std::size_t workers)
+  {
+    std::vector<std::vector<double>> samples(stage_count);
+    ledger l;
+    for (std::size_t r = 0; r < w.repetitions; ++r)
+    {
+      std::size_t stage = 0;
+      auto const time = [&](auto && f)
+      {
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        bench::clobber_memory();
+        samples[stage++].push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+      };
+      time([&] { parse(statement, workers, l); });
+      time([&] { convert(table, w, workers, l); });
+      time([&] { aggregate(w, workers, l); });
+      time([&] { running_balances(w, workers, l); });
+      time([&] { format_report(w, workers, l); });
+    }
+
+    measure m{.threads = workers, .seconds = {}, .checksum = 0};
+    for (std::size_t s = 0; s < stage_count; ++s)
+    {
+      auto & v = samples[s];
+      std::ranges::nth_element(v, v.begin() + static_cast<std::ptrdiff_t>(v.size() / 2));
+      m.seconds[s] = v[v.size() / 2];
+    }
+    for (auto const b : l.balances)
+    {
+      m.checksum = m.checksum * 1'099'511'628'211 + static_cast<std::uint64_t>(b.data());
+    }
+    for (auto const & part : l.report)
+    {
+      for (auto const c : part) { m.checksum = m.checksum * 31 + static_cast<unsigned char>(c); }
+    }
+    return m;
+  }
+
+  [[nodiscard]] std::vector<std::string_view> split(std::string_view list)
+  {
+    std::vector<std::string_view> items;
+    for (std::size_t begin = 0; begin <= list.size();)
+    {
+      auto const end = std::min(list.find(',', begin), list.size());
+      items.push_back(list.substr(begin, end - begin));
+      begin = end + 1;
+    }
+    return items;
+  }
+
+  [[nodiscard]] io1::currency_info const * currency(std::string_view code)
+  {
+    auto const * const c = io1::find_currency(code);
+    if (nullptr == c) { throw std::invalid_argument("bench_ledger: unknown currency " + std::string(code) + "."); }
+    return c;
+  }
+
+  [[nodiscard]] bool parse_options(int argc, char ** argv, workload & w)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string_view const arg = argv[i];
+      auto const value = [arg](std::string_view key) { return std::string(arg.substr(key.size())); };
+      if (arg.starts_with("--rows=")) { w.rows = std::stoull(value("--rows=")); }
+      else if (arg.starts_with("--accounts="))
+      {
+        w.accounts = static_cast<std::uint32_t>(std::max(1UL, std::stoul(value("--accounts="))));
+      }
+      else if (arg.starts_with("--amounts="))
+      {
+        auto const name = value("--amounts=");
+        if ("uniform" == name) { w.amounts = distribution::uniform; }
+        else if ("lognormal" == name) { w.amounts = distribution::lognormal; }
+        else if ("pareto" == name) { w.amounts = distribution::pareto; }
+        else { return false; }
+      }
+      else if (arg.starts_with("--currencies="))
+      {
+        w.currencies.clear();
+        for (auto const code : split(arg.substr(std::string_view("--currencies=").size())))
+        {
+          w.currencies.push_back(currency(code));
+        }
+      }
+      else if (arg.starts_with("--report-currency=")) { w.report_currency = currency(value("--report-currency=")); }
+      else if (arg.starts_with("--locale="))
+      {
+        w.profile = io1::find_profile(value("--locale="));
+        if (nullptr == w.profile) { return false; }
+      }
+      else if (arg.starts_with("--seed=")) { w.seed = std::stoull(value("--seed=")); }
+      else if (arg.starts_with("--repetitions="))
+      {
+        w.repetitions = std::max<std::size_t>(1, std::stoull(value("--repetitions=")));
+      }
+      else if (arg.starts_with("--threads="))
+      {
+        for (auto const count : split(arg.substr(std::string_view("--threads=").size())))
+        {
+          w.threads.push_back(std::max<std::size_t>(1, std::stoull(std::string(count))));
+        }
+      }
+      else { return false; }
+    }
+
+    if (w.threads.empty())
+    {
+      auto const hardware = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+      for (std::size_t t = 1; t < hardware; t *= 2) { w.threads.push_back(t); }
+      w.threads.push_back(hardware);
+    }
+    return true;
+  }
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  workload w;
+  try
+  {
+    if (!parse_options(argc, argv, w))
+    {
+      std::cerr << "usage: " << argv[0]
+                << " [--rows=<count>] [--accounts=<count>] [--amounts=uniform|lognormal|pareto]"
+                   " [--currencies=<code>,...] [--report-currency=<code>] [--locale=<profile>] [--seed=<seed>]"
+                   " [--threads=<count>,...] [--repetitions=<count>]\n";
+      return EXIT_FAILURE;
+    }
+
+    auto const statement = generate_statement(w);
+    auto const table = generate_rates(w);
+    std::printf("%zu rows, %u accounts, %zu currencies, %.1f MB statement, report in %s with the %s profile\n\n",
+                w.rows, w.accounts, w.currencies.size(), static_cast<double>(statement.size()) / 1e6,
+                std::string(w.report_currency->code).c_str(), std::string(w.profile->name).c_str());
+    std::printf("%8s %-10s %12s %14s %10s %11s\n", "threads", "stage", "ms", "Mrows/s", "speedup", "efficiency");
+
+    std::vector<measure> measures;
+    for (auto const threads : w.threads)
+    {
+      measures.push_back(run(w, statement, table, threads));
+      auto const & m = measures.back();
+      auto const & reference = measures.front();
+      double total = 0;
+      double reference_total = 0;
+      for (std::size_t s = 0; s <= stage_count; ++s)
+      {
+        auto const last = s == stage_count;
+        auto const seconds = last ? total : m.seconds[s];
+        auto const reference_seconds = last ? reference_total : reference.seconds[s];
+        auto const speedup = reference_seconds / seconds;
+        auto const efficiency = speedup * static_cast<double>(reference.threads) / static_cast<double>(m.threads);
+        std::printf("%8zu %-10s %12.2f %14.2f %10.2f %10.0f%%\n", m.threads,
+                    std::string(last ? "total" : stage_names[s]).c_str(), 1e3 * seconds,
+                    static_cast<double>(w.rows) / seconds / 1e6, speedup, 100 * efficiency);
+        if (!last)
+        {
+          total += seconds;
+          reference_total += reference.seconds[s];
+        }
+      }
+      if (m.checksum != reference.checksum)
+      {
+        std::cerr << "Results with " << m.threads << " threads differ from the ones with " << reference.threads
+                  << ".\n";
+        return EXIT_FAILURE;
+      }
+    }
+    std::printf("\npeak memory: %.1f MB\n", static_cast<double>(peak_memory()) / 1e6);
+  }
+  catch (std::exception const & e)
+  {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
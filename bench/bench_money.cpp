@@ -0,0 +1,427 @@
+#include "bench_harness.hpp"
+
+#include "io1/money.hpp"
+#include "io1/money_accrual.hpp"
+#include "io1/money_amortization.hpp"
+#include "io1/money_currency.hpp"
+#include "io1/money_filter.hpp"
+#include "io1/money_fx.hpp"
+#include "io1/money_netting.hpp"
+#include "io1/money_reconcile.hpp"
+#include "io1/money_rescale.hpp"
+#include "io1/money_rounding.hpp"
+#include "io1/money_sketch.hpp"
+#include "io1/money_sort.hpp"
+#include "io1/money_tax.hpp"
+#include "io1/money_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <locale>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace io1::literals;
+
+namespace
+{
+  // Amounts cycled through by scalar benchmarks, so that each iteration processes a different one.
+  constexpr std::size_t scalar_items = 1'024;
+  constexpr std::size_t column_items = std::size_t{1} << 20U;
+
+  std::vector<io1::money> random_amounts(std::size_t size, std::int64_t lowest, std::int64_t highest,
+                                         std::uint64_t seed = 41)
+  {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<std::int64_t> dist(lowest, highest);
+    std::vector<io1::money> amounts(size);
+    for (auto & amount : amounts) { amount = io1::money{dist(gen)}; }
+    return amounts;
+  }
+
+  class dollar_moneypunct : public std::moneypunct<char, false>
+  {
+  private:
+    int do_frac_digits() const override { return 2; }
+    std::string do_grouping() const override { return "\003"; }
+    std::string do_curr_symbol() const override { return "$"; }
+    std::string do_negative_sign() const override { return "-"; }
+  };
+
+  void scalar_benchmarks()
+  {
+    bench::add("scalar/literal", 1,
+               []
+               {
+                 return [](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i) { bench::do_not_optimize(1'234'567.89_money); }
+                 };
+               });
+
+    bench::add("scalar/multiply_long_double", scalar_items,
+               []
+               {
+                 return [amounts = random_amounts(scalar_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n) mutable
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     for (auto & amount : amounts)
+                     {
+                       auto copy = amount;
+                       copy *= 1.0725L;
+                       bench::do_not_optimize(copy);
+                     }
+                   }
+                 };
+               });
+
+    bench::add("scalar/div", scalar_items,
+               []
+               {
+                 return [amounts = random_amounts(scalar_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     for (auto const amount : amounts) { bench::do_not_optimize(div(amount, 7)); }
+                   }
+                 };
+               });
+
+    bench::add("scalar/muldiv", scalar_items,
+               []
+               {
+                 return [amounts = random_amounts(scalar_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     for (auto const amount : amounts)
+                     {
+                       bench::do_not_optimize(io1::muldiv(amount, 108'345, 100'000));
+                     }
+                   }
+                 };
+               });
+
+    bench::add("scalar/put_money", scalar_items,
+               []
+               {
+                 auto stream = std::make_shared<std::ostringstream>();
+                 stream->imbue(std::locale(std::locale::classic(), new dollar_moneypunct));
+                 return [stream, amounts = random_amounts(scalar_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     for (auto const amount : amounts)
+                     {
+                       stream->seekp(0);
+                       *stream << io1::put_money(amount);
+                     }
+                   }
+                 };
+               });
+
+    bench::add("scalar/get_money", scalar_items,
+               []
+               {
+                 std::string text;
+                 for (auto const amount : random_amounts(scalar_items, -1'000'000'00, 1'000'000'00))
+                 {
+                   text += std::to_string(amount.data()) + ' ';
+                 }
+                 auto stream = std::make_shared<std::istringstream>(text);
+                 stream->imbue(std::locale(std::locale::classic(), new dollar_moneypunct));
+                 return [stream](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     stream->clear();
+                     stream->seekg(0);
+                     io1::money amount{0};
+                     for (std::size_t k = 0; k < scalar_items; ++k)
+                     {
+                       *stream >> io1::get_money(amount);
+                       bench::do_not_optimize(amount);
+                     }
+                   }
+                 };
+               });
+
+    auto const add_format = [](std::string name, std::string_view spec)
+    {
+      bench::add(std::move(name), scalar_items,
+                 [spec]
+                 {
+                   return [spec, loc = std::locale(std::locale::classic(), new dollar_moneypunct),
+                           amounts = random_amounts(scalar_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                   {
+                     char buffer[64]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+                     for (std::uint64_t i = 0; i < n; ++i)
+                     {
+                       for (auto const amount : amounts)
+                       {
+                         auto const end = std::vformat_to(buffer, loc, spec, std::make_format_args(amount));
+                         bench::do_not_optimize(end);
+                       }
+                     }
+                   };
+                 });
+    };
+    add_format("scalar/format", "{}");
+    add_format("scalar/format_m", "{:m}");
+    add_format("scalar/format_M", "{:#M}");
+    add_format("scalar/format_profile", "{:#pen_US:USD}");
+
+    bench::add("scalar/stream_out", scalar_items,
+               []
+               {
+                 auto stream = std::make_shared<std::ostringstream>();
+                 return [stream, amounts = random_amounts(scalar_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     for (auto const amount : amounts)
+                     {
+                       stream->seekp(0);
+                       *stream << amount;
+                     }
+                   }
+                 };
+               });
+  }
+
+  void column_benchmarks()
+  {
+    bench::add("column/expression", column_items,
+               []
+               {
+                 auto const a = random_amounts(column_items, -1'000'000'00, 1'000'000'00, 1);
+                 auto const b = random_amounts(column_items, -1'000'000'00, 1'000'000'00, 2);
+                 return [a = io1::money_vector(a), b = io1::money_vector(b),
+                         out = io1::money_vector(column_items)](std::uint64_t n) mutable
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     out = a + 2 * b;
+                     bench::do_not_optimize(out[0]);
+                   }
+                 };
+               });
+
+    bench::add("column/radix_sort", column_items,
+               []
+               {
+                 return [input = random_amounts(column_items, -1'000'000'00, 1'000'000'00),
+                         work = std::vector<io1::money>(column_items)](std::uint64_t n) mutable
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     std::ranges::copy(input, work.begin());
+                     io1::radix_sort(work);
+                     bench::do_not_optimize(work.front());
+                   }
+                 };
+               });
+
+    bench::add("column/select_and_sum", column_items,
+               []
+               {
+                 return [input = random_amounts(column_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     auto const selection = io1::select_between(input, -1'000.00_money, 250'000.00_money);
+                     bench::do_not_optimize(io1::gather_sum(input, selection));
+                   }
+                 };
+               });
+
+    bench::add("column/kll_sketch", column_items,
+               []
+               {
+                 return [input = random_amounts(column_items, -1'000'000'00, 1'000'000'00)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     auto const sketch = io1::make_sketch<io1::money_kll_sketch<>>(input);
+                     bench::do_not_optimize(sketch);
+                   }
+                 };
+               });
+
+    bench::add("column/rescale_6_2", column_items,
+               []
+               {
+                 return [input = random_amounts(column_items, -1'000'000'000'000, 1'000'000'000'000),
+                         out = std::vector<io1::money>(column_items)](std::uint64_t n) mutable
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     io1::rescale<6, 2>(input, out);
+                     bench::do_not_optimize(out.front());
+                   }
+                 };
+               });
+
+    bench::add("column/fx_convert", column_items,
+               []
+               {
+                 io1::fx_table table(840);
+                 table.set_rate(978, {108'345, 100'000});
+                 table.set_rate(392, {1, 150});
+                 table.set_rate(826, {126'912, 100'000});
+                 std::uint16_t const codes[] = {840, 978, 392, 826};
+                 std::vector<std::uint16_t> currencies(column_items);
+                 std::mt19937 gen(42);
+                 for (auto & c : currencies) { c = codes[gen() % std::size(codes)]; }
+                 return [table, currencies, input = random_amounts(column_items, -1'000'000'00, 1'000'000'00),
+                         out = std::vector<io1::money>(column_items)](std::uint64_t n) mutable
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     table.convert(input, currencies, 978, out);
+                     bench::do_not_optimize(out.front());
+                   }
+                 };
+               });
+
+    bench::add("column/accrue_act_365f", column_items,
+               []
+               {
+                 std::vector<io1::fixed_rate> rates(column_items);
+                 std::mt19937 gen(43);
+                 for (auto & r : rates) { r = {static_cast<std::int64_t>(gen() % 10'000'000)}; }
+                 return [rates, input = random_amounts(column_items, -1'000'000'00, 1'000'000'00),
+                         residuals = std::vector<std::int64_t>(column_items),
+                         out = std::vector<io1::money>(column_items)](std::uint64_t n) mutable
+                 {
+                   std::chrono::sys_days const day = std::chrono::year{2024} / 1 / 1;
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     io1::accrue<io1::act_365f>(input, rates, day, day + std::chrono::days{1}, residuals, out);
+                     bench::do_not_optimize(out.front());
+                   }
+                 };
+               });
+
+    constexpr std::size_t loans = 4'096;
+    constexpr std::uint32_t periods = 360;
+    bench::add("column/amortize", loans * periods,
+               []
+               {
+                 std::vector<io1::loan> portfolio(loans);
+                 std::mt19937_64 gen(44);
+                 for (auto & l : portfolio)
+                 {
+                   l = {.principal = io1::money{static_cast<std::int64_t>(gen() % 100'000'000'00)},
+                        .rate = {static_cast<std::int64_t>(gen() % 1'000), 120'000},
+                        .periods = periods};
+                 }
+                 return [portfolio](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i) { bench::do_not_optimize(io1::amortize(portfolio)); }
+                 };
+               });
+
+    bench::add("column/compute_tax", column_items,
+               []
+               {
+                 std::vector<std::uint64_t> invoices(column_items);
+                 std::vector<std::uint16_t> rate_ids(column_items);
+                 std::mt19937_64 gen(45);
+                 std::uint64_t invoice = 0;
+                 for (std::size_t i = 0; i < column_items; ++i)
+                 {
+                   if (0 == gen() % 4) { ++invoice; }
+                   invoices[i] = invoice;
+                   rate_ids[i] = static_cast<std::uint16_t>(gen() % 3);
+                 }
+                 return [invoices, rate_ids, net = random_amounts(column_items, -1'000'00, 10'000'00)](std::uint64_t n)
+                 {
+                   io1::tax_rate const rates[] = {{20, 100}, {55, 1'000}, {10, 100}};
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     bench::do_not_optimize(
+                         io1::compute_tax(invoices, rate_ids, net, rates, io1::tax_rounding::per_invoice));
+                   }
+                 };
+               });
+  }
+
+  // Two ledgers of a million rows each: most entries match exactly, some within the tolerance and a few not at all.
+  void reconciliation_benchmark()
+  {
+    constexpr std::size_t rows = 1'000'000;
+    bench::add("macro/reconcile_1m", rows,
+               []
+               {
+                 std::mt19937_64 gen(46);
+                 std::vector<io1::ledger_entry> left(rows);
+                 std::vector<io1::ledger_entry> right(rows);
+                 std::chrono::sys_days const first = std::chrono::year{2024} / 1 / 1;
+                 for (std::size_t i = 0; i < rows; ++i)
+                 {
+                   auto const amount = io1::money{static_cast<std::int64_t>(gen() % 10'000'000'00)};
+                   auto const date = first + std::chrono::days{static_cast<int>(gen() % 365)};
+                   left[i] = {.amount = amount, .date = date, .reference = gen() % (rows / 4)};
+                   auto const kind = gen() % 100;
+                   right[i] = {.amount = kind < 90   ? amount
+                                         : kind < 97 ? amount + io1::money{static_cast<std::int64_t>(gen() % 5)}
+                                                     : io1::money{static_cast<std::int64_t>(gen())},
+                               .date = date + std::chrono::days{static_cast<int>(gen() % 3)},
+                               .reference = left[i].reference};
+                 }
+                 std::ranges::shuffle(right, gen);
+                 return [left, right](std::uint64_t n)
+                 {
+                   io1::reconciliation_options const options{.date_tolerance = std::chrono::days{2},
+                                                             .amount_tolerance = io1::money{5}};
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     bench::do_not_optimize(io1::reconcile(left, right, options));
+                   }
+                 };
+               });
+  }
+
+  // A million payments among ten thousand parties, netted and settled.
+  void netting_benchmark()
+  {
+    constexpr std::size_t obligations = 1'000'000;
+    constexpr std::size_t parties = 10'000;
+    bench::add("netting/net_obligations", obligations,
+               []
+               {
+                 std::mt19937_64 gen(50);
+                 std::vector<io1::obligation> input(obligations);
+                 for (auto & o : input)
+                 {
+                   o = {.debtor = gen() % parties,
+                        .creditor = gen() % parties,
+                        .amount = io1::money{static_cast<std::int64_t>(gen() % 1'000'000'00)}};
+                 }
+                 return [input = std::move(input)](std::uint64_t n)
+                 {
+                   for (std::uint64_t i = 0; i < n; ++i)
+                   {
+                     bench::do_not_optimize(io1::net_obligations(input, parties));
+                   }
+                 };
+               });
+  }
+} // namespace
+
+void bench::register_benchmarks()
+{
+  scalar_benchmarks();
+  column_benchmarks();
+  reconciliation_benchmark();
+  netting_benchmark();
+}
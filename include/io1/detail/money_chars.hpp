@@ -0,0 +1,144 @@
+#pragma once
+
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <system_error>
+
+namespace io1::detail
+{
+  // Powers of ten representable in 64 bits.
+  inline constexpr auto powers_of_ten = []
+  {
+    std::array<std::uint64_t, 20> result{};
+    result[0] = 1;
+    for (std::size_t i = 1; i < result.size(); ++i) { result[i] = result[i - 1] * 10; }
+    return result;
+  }();
+
+  // Number of characters integer_to_chars writes for value, without writing them.
+  [[nodiscard]] constexpr std::size_t integer_chars(std::int64_t value) noexcept
+  {
+    auto const magnitude =
+        value < 0 ? std::uint64_t{0} - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    // log10(2) ~ 1233 / 4096 gives the count of digits, or one more
+    auto const guess = static_cast<std::size_t>(std::bit_width(magnitude | 1U)) * 1'233U >> 12U;
+    return static_cast<std::size_t>(value < 0) + guess +
+           static_cast<std::size_t>((magnitude | 1U) >= powers_of_ten[guess]);
+  }
+
+  // Decimal digits of value, after a '-' if it is negative. out must have room for 40 characters.
+  template <class Int>
+  [[nodiscard]] inline char * integer_to_chars(char * out, Int value) noexcept
+  {
+    if constexpr (sizeof(Int) <= sizeof(long long)) { return std::to_chars(out, out + 40, value).ptr; }
+    else
+    {
+      auto magnitude = value < 0 ? money_unsigned<Int>{0} - static_cast<money_unsigned<Int>>(value)
+                                 : static_cast<money_unsigned<Int>>(value);
+      char buffer[40]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      auto * p = buffer + sizeof(buffer);
+      do
+      {
+        *--p = static_cast<char>('0' + static_cast<int>(magnitude % 10));
+        magnitude /= 10;
+      } while (0 != magnitude);
+      if (value < 0) { *out++ = '-'; }
+      return std::copy(p, buffer + sizeof(buffer), out);
+    }
+  }
+
+  // An optional '-' followed by decimal digits. False, leaving value unchanged, if text is not such a number or
+  // if it is out of range.
+  template <class Int>
+  [[nodiscard]] constexpr bool integer_from_chars(std::string_view text, Int & value) noexcept
+  {
+    auto const negative = text.starts_with('-');
+    if (negative) { text.remove_prefix(1); }
+    if (text.empty()) { return false; }
+
+    // accumulated as a negative number, whose range is the largest
+    Int result = 0;
+    for (auto const c : text)
+    {
+      if (c < '0' || c > '9') { return false; }
+      auto const digit = static_cast<Int>(c - '0');
+      if (result < (std::numeric_limits<Int>::lowest() + digit) / 10) { return false; }
+      result = static_cast<Int>(result * 10 - digit);
+    }
+    if (!negative && result < -std::numeric_limits<Int>::max()) { return false; }
+    value = negative ? result : static_cast<Int>(-result);
+    return true;
+  }
+
+  // Write `amount` minor units as a decimal number with `digits` fractional digits.
+  constexpr std::to_chars_result to_decimal_chars(char * first, char * last, money::value_type amount,
+                                                  unsigned digits) noexcept
+  {
+    auto magnitude = amount < 0 ? std::uint64_t{0} - static_cast<std::uint64_t>(amount)
+                                : static_cast<std::uint64_t>(amount);
+
+    // digits are produced backwards: 20 digits, a separator and a sign at most
+    char buffer[24]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto * end = buffer + sizeof(buffer);
+    auto * p = end;
+    for (unsigned i = 0; i < digits; ++i, magnitude /= 10) { *--p = static_cast<char>('0' + magnitude % 10); }
+    if (0 < digits) { *--p = '.'; }
+    do
+    {
+      *--p = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (0 != magnitude);
+    if (amount < 0) { *--p = '-'; }
+
+    auto const size = end - p;
+    if (last - first < size) { return {last, std::errc::value_too_large}; }
+    return {std::ranges::copy(p, end, first).out, std::errc{}};
+  }
+
+  // Read a decimal number with at most `digits` fractional digits as minor units. Like std::from_chars, the longest
+  // valid prefix is consumed.
+  constexpr std::from_chars_result from_decimal_chars(char const * first, char const * last,
+                                                      money::value_type & amount, unsigned digits) noexcept
+  {
+    auto const * p = first;
+    bool const negative = p != last && '-' == *p;
+    if (negative) { ++p; }
+
+    constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<money::value_type>::max());
+    auto const limit = negative ? max + 1 : max;
+    std::uint64_t magnitude = 0;
+    bool overflow = false;
+    auto const accumulate = [&](char c) noexcept
+    {
+      auto const digit = static_cast<std::uint64_t>(c - '0');
+      if (magnitude > (limit - digit) / 10) { overflow = true; }
+      else { magnitude = magnitude * 10 + digit; }
+    };
+
+    auto const * const integral = p;
+    while (p != last && '0' <= *p && *p <= '9') { accumulate(*p++); }
+    auto seen = p != integral;
+
+    unsigned fractional = 0;
+    if (0 < digits && p != last && '.' == *p && p + 1 != last && '0' <= p[1] && p[1] <= '9')
+    {
+      for (++p; p != last && fractional < digits && '0' <= *p && *p <= '9'; ++fractional) { accumulate(*p++); }
+      seen = true;
+    }
+    if (!seen) { return {first, std::errc::invalid_argument}; }
+    for (; fractional < digits; ++fractional) { accumulate('0'); }
+
+    if (overflow) { return {p, std::errc::result_out_of_range}; }
+    amount = negative ? static_cast<money::value_type>(std::uint64_t{0} - magnitude)
+                      : static_cast<money::value_type>(magnitude);
+    return {p, std::errc{}};
+  }
+} // namespace io1::detail
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// The hooks io1::basic_money calls, without the observers of io1/money_observer.hpp: the core header only needs these.
+namespace io1
+{
+  // Hooks called by io1::basic_money on the events worth monitoring in production. The default observer does
+  // nothing and is inlined away.
+  struct null_observer
+  {
+    // An integer division is about to throw InexactDivision.
+    static constexpr void on_inexact_division() noexcept {}
+    // An amount was multiplied or divided by a floating point number, whose exact result was rounded or not.
+    static constexpr void on_float_scaling(bool /*rounded*/) noexcept {}
+    // The result of an addition or a subtraction.
+    template <class Int>
+    static constexpr void on_sum(Int /*result*/) noexcept
+    {
+    }
+    // io1::get_money extracted an amount, or failed to.
+    static constexpr void on_get_money(bool /*parsed*/) noexcept {}
+    // io1::put_money wrote an amount, through std::put_money when the locale has a custom money_put facet.
+    static constexpr void on_put_money(bool /*fallback*/) noexcept {}
+    // std::format wrote an amount, through a string stream when the locale has a custom money_put facet.
+    static constexpr void on_format(bool /*fallback*/) noexcept {}
+  };
+
+  template <class T>
+  concept money_observer = requires(bool flag, std::int64_t result) {
+    T::on_inexact_division();
+    T::on_float_scaling(flag);
+    T::on_sum(result);
+    T::on_get_money(flag);
+    T::on_put_money(flag);
+    T::on_format(flag);
+  };
+} // namespace io1
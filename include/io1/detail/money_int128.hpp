@@ -0,0 +1,20 @@
+#pragma once
+
+// 128-bit integers for exact intermediate results: the compiler extension when there is one, the (undocumented but
+// complete) class used by the MSVC standard library otherwise.
+#if defined(__SIZEOF_INT128__)
+namespace io1::detail
+{
+  __extension__ using int128_t = __int128;
+  __extension__ using uint128_t = unsigned __int128;
+} // namespace io1::detail
+#elif defined(_MSC_VER)
+#include <__msvc_int128.hpp>
+namespace io1::detail
+{
+  using int128_t = std::_Signed128;
+  using uint128_t = std::_Unsigned128;
+} // namespace io1::detail
+#else
+#error "io1::money requires a 128-bit integer type for exact intermediate results."
+#endif
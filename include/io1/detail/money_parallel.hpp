@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace io1::detail
+{
+  // Number of workers to use for `size` items when each one should get at least `grain` of them. A requested
+  // count of 0 means one per hardware thread.
+  [[nodiscard]] inline std::size_t worker_count(std::size_t size, std::size_t grain, std::size_t requested = 0) noexcept
+  {
+    if (0 == requested) { requested = std::max<std::size_t>(1, std::thread::hardware_concurrency()); }
+    return std::clamp<std::size_t>(size / std::max<std::size_t>(1, grain), 1, requested);
+  }
+
+  // Split [0, size) into `workers` contiguous chunks and call f(worker, begin, end) on each of them concurrently. The
+  // calling thread handles the first chunk. The first exception thrown by a worker is rethrown once all are done.
+  template <class F>
+  void parallel_chunks(std::size_t size, std::size_t workers, F && f)
+  {
+    workers = std::max<std::size_t>(1, workers);
+    auto const bounds = [size, workers](std::size_t w) { return size * w / workers; };
+
+    if (1 == workers)
+    {
+      f(std::size_t{0}, std::size_t{0}, size);
+      return;
+    }
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto const run = [&](std::size_t w) noexcept
+    {
+      try
+      {
+        f(w, bounds(w), bounds(w + 1));
+      }
+      catch (...)
+      {
+        std::lock_guard const lock(error_mutex);
+        if (!error) { error = std::current_exception(); }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    try
+    {
+      for (std::size_t w = 1; w < workers; ++w) { threads.emplace_back(run, w); }
+    }
+    catch (...)
+    {
+      for (auto & thread : threads) { thread.join(); }
+      throw;
+    }
+    run(0);
+    for (auto & thread : threads) { thread.join(); }
+
+    if (error) { std::rethrow_exception(error); }
+  }
+} // namespace io1::detail
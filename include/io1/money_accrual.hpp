@@ -0,0 +1,227 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace io1
+{
+  // Annual rate in units of 10^-8: 5% is {5'000'000}.
+  struct fixed_rate
+  {
+    static constexpr std::int64_t one = 100'000'000;
+
+    std::int64_t value;
+
+    [[nodiscard]] friend constexpr bool operator==(fixed_rate const &, fixed_rate const &) noexcept = default;
+  };
+
+  // A day count convention gives the fraction of a year between two dates as numerator(start, end) / basis.
+  template <class T>
+  concept day_count = requires(std::chrono::sys_days date) {
+    requires std::same_as<decltype(T::basis), std::int64_t const>;
+    { T::numerator(date, date) } -> std::same_as<std::int64_t>;
+  };
+
+  // Actual days over 360.
+  struct act_360
+  {
+    static constexpr std::int64_t basis = 360;
+
+    [[nodiscard]] static constexpr std::int64_t numerator(std::chrono::sys_days start,
+                                                          std::chrono::sys_days end) noexcept
+    {
+      return (end - start).count();
+    }
+  };
+
+  // Actual days over 365, leap years included.
+  struct act_365f
+  {
+    static constexpr std::int64_t basis = 365;
+
+    [[nodiscard]] static constexpr std::int64_t numerator(std::chrono::sys_days start,
+                                                          std::chrono::sys_days end) noexcept
+    {
+      return (end - start).count();
+    }
+  };
+
+  // Months of 30 days over 360, the bond basis of the 2006 ISDA definitions: the 31st counts as the 30th, and so does
+  // the 31st of the end month when the start is the 30th or 31st.
+  struct thirty_360
+  {
+    static constexpr std::int64_t basis = 360;
+
+    [[nodiscard]] static constexpr std::int64_t numerator(std::chrono::sys_days start,
+                                                          std::chrono::sys_days end) noexcept
+    {
+      std::chrono::year_month_day const from{start};
+      std::chrono::year_month_day const to{end};
+      auto const d1 = std::min(static_cast<std::int64_t>(static_cast<unsigned>(from.day())), std::int64_t{30});
+      auto d2 = static_cast<std::int64_t>(static_cast<unsigned>(to.day()));
+      if (31 == d2 && 30 == d1) { d2 = 30; }
+      return 360 * (static_cast<std::int64_t>(static_cast<int>(to.year())) - static_cast<int>(from.year())) +
+             30 * (static_cast<std::int64_t>(static_cast<unsigned>(to.month())) -
+                   static_cast<unsigned>(from.month())) +
+             d2 - d1;
+    }
+  };
+
+  // Actual days in leap years over 366 plus actual days in other years over 365, as ISDA defines ACT/ACT.
+  struct act_act
+  {
+    static constexpr std::int64_t basis = 365 * 366;
+
+    [[nodiscard]] static constexpr std::int64_t numerator(std::chrono::sys_days start,
+                                                          std::chrono::sys_days end) noexcept
+    {
+      std::int64_t result = 0;
+      while (start < end)
+      {
+        auto const year = std::chrono::year_month_day{start}.year();
+        auto const next = std::min(end, std::chrono::sys_days{(year + std::chrono::years{1}) / 1 / 1});
+        result += (next - start).count() * (year.is_leap() ? 365 : 366);
+        start = next;
+      }
+      return result;
+    }
+  };
+
+  namespace detail
+  {
+    // Rates beyond 1000% a year are refused so that balance * rate * numerator fits in 128 bits for any period of
+    // dates representable by std::chrono::year_month_day.
+    inline constexpr std::int64_t max_accrual_rate = 10 * fixed_rate::one;
+
+    // balance * rate * numerator / (basis * one) + residual / (basis * one) minor units: the quotient is accrued and
+    // the remainder, in units of 1 / (basis * one) minor unit, carried forward.
+    template <day_count DayCount>
+    [[nodiscard]] constexpr money::value_type accrue(money::value_type balance, std::int64_t rate,
+                                                     std::int64_t numerator, std::int64_t & residual)
+    {
+      constexpr auto denominator = static_cast<int128_t>(DayCount::basis) * fixed_rate::one;
+      auto const total = static_cast<int128_t>(balance) * rate * numerator + residual;
+      auto const quotient = total / denominator;
+      if (quotient < std::numeric_limits<money::value_type>::lowest() ||
+          quotient > std::numeric_limits<money::value_type>::max())
+      {
+        throw std::overflow_error("io1::accrue: interest out of range.");
+      }
+      residual = static_cast<std::int64_t>(total % denominator);
+      return static_cast<money::value_type>(quotient);
+    }
+
+    // Same with 64-bit arithmetic, when the caller knows the total fits: the division by a constant is a
+    // multiplication and the loop has no branch.
+    template <day_count DayCount>
+    [[nodiscard]] constexpr money::value_type accrue_narrow(money::value_type balance, std::int64_t rate,
+                                                            std::int64_t numerator, std::int64_t & residual) noexcept
+    {
+      constexpr auto denominator = DayCount::basis * fixed_rate::one;
+      auto const total = balance * rate * numerator + residual;
+      residual = total % denominator;
+      return total / denominator;
+    }
+
+    [[nodiscard]] constexpr std::uint64_t magnitude(std::int64_t value) noexcept
+    {
+      return value < 0 ? static_cast<std::uint64_t>(-(value + 1)) + 1 : static_cast<std::uint64_t>(value);
+    }
+
+    // Whether balances and rates of magnitudes up to the given ones accrue over `numerator` with the 64-bit kernel.
+    template <day_count DayCount>
+    [[nodiscard]] constexpr bool fits_narrow(std::uint64_t balance, std::uint64_t rate, std::int64_t numerator) noexcept
+    {
+      constexpr auto residual = static_cast<uint128_t>(DayCount::basis * fixed_rate::one);
+      auto const total = static_cast<uint128_t>(balance) * rate * static_cast<std::uint64_t>(numerator) + residual;
+      return total <= static_cast<uint128_t>(std::numeric_limits<std::int64_t>::max());
+    }
+
+    [[nodiscard]] constexpr bool valid_rate(fixed_rate rate) noexcept
+    {
+      return -max_accrual_rate <= rate.value && rate.value <= max_accrual_rate;
+    }
+  } // namespace detail
+
+  // Interest accrued by balance at rate from start to end according to DayCount, truncated toward zero. The fraction
+  // of minor unit left, in units of 1 / (DayCount::basis * fixed_rate::one), is added to residual, which starts at 0
+  // and carries it to the next accrual of the same account: accruing day by day sums to the interest of the whole
+  // period. Throws std::invalid_argument if the rate is beyond 1000% and std::overflow_error if the interest is out of
+  // range.
+  template <day_count DayCount>
+  [[nodiscard]] constexpr money accrue(money balance, fixed_rate rate, std::chrono::sys_days start,
+                                       std::chrono::sys_days end, std::int64_t & residual)
+  {
+    assert(start <= end && "Periods end after they start.");
+    if (!detail::valid_rate(rate)) { throw std::invalid_argument("io1::accrue: rate beyond 1000%."); }
+    return money{detail::accrue<DayCount>(balance.data(), rate.value, DayCount::numerator(start, end), residual)};
+  }
+
+  // Accrue a column of accounts from start to end, each with its own rate and residual, into interest, on `threads`
+  // workers (one per hardware thread if 0). Rates are checked before anything is written, overflows throw
+  // std::overflow_error after some rows may have been.
+  template <day_count DayCount>
+  void accrue(std::span<money const> balances, std::span<fixed_rate const> rates, std::chrono::sys_days start,
+              std::chrono::sys_days end, std::span<std::int64_t> residuals, std::span<money> interest,
+              std::size_t threads = 0)
+  {
+    assert(balances.size() == rates.size() && balances.size() == residuals.size() &&
+           balances.size() == interest.size() && "Each balance must have a rate, a residual and a destination.");
+    assert(start <= end && "Periods end after they start.");
+
+    auto const size = balances.size();
+    auto const numerator = DayCount::numerator(start, end);
+    std::uint64_t largest_rate = 0;
+    for (auto const rate : rates) { largest_rate = std::max(largest_rate, detail::magnitude(rate.value)); }
+    if (largest_rate > static_cast<std::uint64_t>(detail::max_accrual_rate))
+    {
+      auto const i = std::ranges::find_if_not(rates, detail::valid_rate) - rates.begin();
+      throw std::invalid_argument("io1::accrue: rate of account " + std::to_string(i) + " beyond 1000%.");
+    }
+
+    constexpr std::size_t grain = std::size_t{1} << 16U;
+    auto const workers = detail::worker_count(size, grain, threads);
+    detail::parallel_chunks(
+        size, workers,
+        [&](std::size_t, std::size_t begin, std::size_t end_row)
+        {
+          auto const * const balance = balances.data();
+          auto const * const rate = rates.data();
+          auto * const residual = residuals.data();
+          auto * const out = interest.data();
+
+          std::uint64_t largest_balance = 0;
+          for (auto i = begin; i < end_row; ++i)
+          {
+            largest_balance = std::max(largest_balance, detail::magnitude(balance[i].data()));
+          }
+
+          if (detail::fits_narrow<DayCount>(largest_balance, largest_rate, numerator))
+          {
+            for (auto i = begin; i < end_row; ++i)
+            {
+              out[i] = money{detail::accrue_narrow<DayCount>(balance[i].data(), rate[i].value, numerator, residual[i])};
+            }
+          }
+          else
+          {
+            for (auto i = begin; i < end_row; ++i)
+            {
+              out[i] = money{detail::accrue<DayCount>(balance[i].data(), rate[i].value, numerator, residual[i])};
+            }
+          }
+        });
+  }
+} // namespace io1
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_rounding.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace io1
+{
+  // Exact interest rate per period: numerator / denominator, e.g. {5, 1'200} for 5% a year paid monthly.
+  struct interest_rate
+  {
+    std::int64_t numerator;
+    std::int64_t denominator{1};
+
+    [[nodiscard]] friend constexpr bool operator==(interest_rate const &, interest_rate const &) noexcept = default;
+  };
+
+  struct loan
+  {
+    money principal;
+    interest_rate rate;
+    std::uint32_t periods;
+  };
+
+  // Columns of the schedules of several loans, one row per period. The rows of loan i are [offsets[i], offsets[i + 1]).
+  struct amortization_schedule
+  {
+    std::vector<std::size_t> offsets;
+    std::vector<money> interest;
+    std::vector<money> principal;
+    std::vector<money> balance; // outstanding after the period
+  };
+
+  namespace detail
+  {
+    // Fixed point numbers of [0, 2] with 63 fractional bits.
+    inline constexpr unsigned annuity_bits = 63;
+    inline constexpr uint128_t annuity_one = uint128_t{1} << annuity_bits;
+
+    [[nodiscard]] constexpr uint128_t annuity_multiply(uint128_t a, uint128_t b) noexcept
+    {
+      return (a * b + annuity_one / 2) >> annuity_bits;
+    }
+
+    inline void check_loan(loan const & l, std::size_t index)
+    {
+      auto const error = [index](char const * what)
+      { throw std::invalid_argument("io1::amortize: loan " + std::to_string(index) + " " + what); };
+
+      if (l.principal.data() < 0) { error("has a negative principal."); }
+      if (0 == l.periods) { error("has no period."); }
+      if (l.rate.denominator <= 0 || l.rate.numerator < 0 || l.rate.numerator >= l.rate.denominator)
+      {
+        error("has a rate out of [0, 1).");
+      }
+    }
+
+    // Periodic payment of an annuity, principal * r / (1 - (1 + r)^-periods), rounded to the nearest minor unit. The
+    // discount factor is raised to the power of the periods in 63-bit fixed point: the error of the payment, before
+    // rounding, is a few periods * 2^-63 of the principal.
+    [[nodiscard]] inline money::value_type level_payment(loan const & l)
+    {
+      auto const principal = static_cast<uint128_t>(l.principal.data());
+      auto const numerator = static_cast<uint128_t>(l.rate.numerator);
+      auto const denominator = static_cast<uint128_t>(l.rate.denominator);
+
+      uint128_t payment = 0;
+      uint128_t discounted = annuity_one; // (1 + r)^-periods
+      if (0 != numerator)
+      {
+        auto const factor = (denominator * annuity_one + (denominator + numerator) / 2) / (denominator + numerator);
+        auto base = factor;
+        for (auto exponent = l.periods; 0 != exponent; exponent >>= 1U)
+        {
+          if (0 != (exponent & 1U)) { discounted = annuity_multiply(discounted, base); }
+          base = annuity_multiply(base, base);
+        }
+      }
+
+      if (discounted >= annuity_one) // no interest, or too little to be seen
+      {
+        payment = (principal + l.periods / 2) / l.periods;
+      }
+      else
+      {
+        auto const rate = numerator * annuity_one / denominator;
+        auto const annuity = rate * annuity_one / (annuity_one - discounted); // below 1 + r
+        payment = (principal * annuity + annuity_one / 2) >> annuity_bits;
+      }
+
+      // the balance has to decrease from the first period on
+      auto const first_interest =
+          static_cast<uint128_t>(divide_rounded<int128_t>(static_cast<int128_t>(principal * numerator),
+                                                          static_cast<int128_t>(denominator), rounding::half_even));
+      if (payment <= first_interest && 0 != principal) { payment = first_interest + 1; }
+
+      if (payment > static_cast<uint128_t>(std::numeric_limits<money::value_type>::max()))
+      {
+        throw std::overflow_error("io1::amortize: payment out of range.");
+      }
+      return static_cast<money::value_type>(payment);
+    }
+
+    // Rows of one loan: the interest of each period is rounded on the outstanding balance, the level payment repays
+    // the rest, and the last period repays whatever is left so that the principal sums exactly to the loan.
+    inline void amortize(loan const & l, rounding mode, money * interest, money * principal, money * balance)
+    {
+      auto const payment = level_payment(l);
+      auto outstanding = l.principal.data();
+      for (std::uint32_t period = 0; period < l.periods; ++period)
+      {
+        auto const due = muldiv(outstanding, l.rate.numerator, l.rate.denominator, mode);
+        auto repaid = period + 1 == l.periods ? outstanding : payment - due;
+        repaid = repaid < outstanding ? repaid : outstanding;
+        outstanding -= repaid;
+
+        interest[period] = money{due};
+        principal[period] = money{repaid};
+        balance[period] = money{outstanding};
+      }
+    }
+  } // namespace detail
+
+  // Payment of each period but the last one, which settles the balance.
+  [[nodiscard]] inline money level_payment(loan const & l)
+  {
+    detail::check_loan(l, 0);
+    return money{detail::level_payment(l)};
+  }
+
+  // Schedules of level payment loans, the interest of each period being rounded according to mode, on `threads`
+  // workers (one per hardware thread if 0). Throws std::invalid_argument before anything is computed if a loan has a
+  // negative principal, no period or a rate out of [0, 1), and std::overflow_error if a payment is out of range.
+  [[nodiscard]] inline amortization_schedule amortize(std::span<loan const> loans, rounding mode = rounding::half_even,
+                                                      std::size_t threads = 0)
+  {
+    amortization_schedule schedule;
+    schedule.offsets.resize(loans.size() + 1);
+    for (std::size_t i = 0; i < loans.size(); ++i)
+    {
+      detail::check_loan(loans[i], i);
+      schedule.offsets[i + 1] = schedule.offsets[i] + loans[i].periods;
+    }
+
+    auto const rows = schedule.offsets.back();
+    schedule.interest.resize(rows);
+    schedule.principal.resize(rows);
+    schedule.balance.resize(rows);
+
+    constexpr std::size_t grain = 1'024;
+    auto const workers = detail::worker_count(loans.size(), grain, threads);
+    detail::parallel_chunks(loans.size(), workers,
+                            [&](std::size_t, std::size_t begin, std::size_t end)
+                            {
+                              for (auto i = begin; i < end; ++i)
+                              {
+                                auto const row = schedule.offsets[i];
+                                detail::amortize(loans[i], mode, schedule.interest.data() + row,
+                                                 schedule.principal.data() + row, schedule.balance.data() + row);
+                              }
+                            });
+    return schedule;
+  }
+} // namespace io1
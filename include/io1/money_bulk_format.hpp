@@ -0,0 +1,199 @@
+#pragma once
+
+#include "io1/detail/money_chars.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_format.hpp"
+#include "io1/money_profile.hpp"
+#include "io1/money_punct_cache.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <format>
+#include <ios>
+#include <iterator>
+#include <locale>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io1
+{
+  // Layout of a column of amounts formatted as std::format(locale, "{:<spec>}", amount) does, each followed by a
+  // separator. The size of the text is computed on construction and the text is written by write(), both on `threads`
+  // workers (one per hardware thread if 0) that each handle a contiguous part of the column: the text can be written
+  // straight to its destination, e.g. a memory-mapped file, without growing a string.
+  //
+  // The amounts and the separator are referred to until the layout is destroyed. Common specifications
+  // (none, m, M, #m, #M and profiles without width) are laid out without std::format, the others through it.
+  class bulk_format
+  {
+  public:
+    // Throws std::format_error if spec is not a valid specification.
+    bulk_format(std::string_view spec, std::span<money const> amounts, std::string_view separator = "\n",
+                std::locale const & locale = std::locale(), std::size_t threads = 0)
+        : amounts_(amounts), separator_(separator), locale_(locale), spec_("{:" + std::string(spec) + '}')
+    {
+      // the specification is validated once, by the formatter itself
+      std::formatter<money, char> formatter;
+      std::format_parse_context context(spec);
+      if (auto const end = formatter.parse(context); end != context.end())
+      {
+        throw std::format_error("io1::bulk_format: invalid format specification.");
+      }
+
+      if (spec.empty()) { kind_ = kind::integer; }
+      else if (auto const profile = detail::parse_profile_spec(spec); nullptr != profile.profile)
+      {
+        if (0 == profile.string_spec_size)
+        {
+          kind_ = kind::profile;
+          profile_ = profile.profile;
+          digits_ = nullptr != profile.currency ? profile.currency->minor_unit : 2U;
+          if (profile.show_symbol && nullptr != profile.currency)
+          {
+            symbol_ = profile_->code ? profile.currency->code : profile.currency->symbol;
+          }
+        }
+      }
+      else if ("m" == spec || "#m" == spec || "M" == spec || "#M" == spec)
+      {
+        kind_ = spec.ends_with('M') ? kind::intl_locale : kind::locale;
+        showbase_ = spec.starts_with('#');
+      }
+
+      workers_ = detail::worker_count(amounts_.size(), grain, threads);
+      offsets_.assign(workers_ + 1, 0);
+      detail::parallel_chunks(amounts_.size(), workers_,
+                              [this](std::size_t w, std::size_t begin, std::size_t end)
+                              { offsets_[w + 1] = layout<false>(begin, end, nullptr); });
+      for (std::size_t w = 0; w < workers_; ++w) { offsets_[w + 1] += offsets_[w]; }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return offsets_.back(); }
+
+    // Write size() characters and return the end of the text.
+    char * write(char * out) const
+    {
+      detail::parallel_chunks(amounts_.size(), workers_,
+                              [this, out](std::size_t w, std::size_t begin, std::size_t end)
+                              { static_cast<void>(layout<true>(begin, end, out + offsets_[w])); });
+      return out + size();
+    }
+
+    [[nodiscard]] std::string str() const
+    {
+      std::string text(size(), '\0');
+      write(text.data());
+      return text;
+    }
+
+  private:
+    enum class kind
+    {
+      generic,
+      integer,
+      profile,
+      locale,
+      intl_locale
+    };
+
+    // amounts a worker handles at least
+    static constexpr std::size_t grain = std::size_t{1} << 12U;
+
+    // Size of the text of amounts [begin, end) and their separators, written from out if Write.
+    template <bool Write>
+    std::size_t layout(std::size_t begin, std::size_t end, char * out) const
+    {
+      std::size_t total = 0;
+      auto const emit = [&](char const * text, std::size_t size)
+      {
+        if constexpr (Write)
+        {
+          out = std::copy_n(text, size, out);
+          out = std::ranges::copy(separator_, out).out;
+        }
+        total += size + separator_.size();
+      };
+
+      switch (kind_)
+      {
+      case kind::integer:
+      {
+        // sizes are counted without formatting, and the digits written in place
+        for (auto i = begin; i < end; ++i)
+        {
+          auto const value = amounts_[i].data();
+          auto const size = detail::integer_chars(value);
+          if constexpr (Write) { out = std::ranges::copy(separator_, std::to_chars(out, out + size, value).ptr).out; }
+          total += size;
+        }
+        return total + (end - begin) * separator_.size();
+      }
+      case kind::profile:
+      {
+        char buffer[detail::profile_buffer_size]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        for (auto i = begin; i < end; ++i)
+        {
+          emit(buffer, detail::format_with_profile(buffer, amounts_[i].data(), digits_, *profile_, symbol_));
+        }
+        return total;
+      }
+      case kind::locale:
+      case kind::intl_locale:
+      {
+        // the plan stays valid as long as this thread looks up no other locale
+        auto const & plan = kind::intl_locale == kind_ ? detail::moneypunct_cache<true>::lookup(locale_)
+                                                        : detail::moneypunct_cache<false>::lookup(locale_);
+        if (!plan.standard_put) { break; }
+        auto const flags = showbase_ ? std::ios_base::showbase : std::ios_base::fmtflags{};
+        char digits[40]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        for (auto i = begin; i < end; ++i)
+        {
+          std::string_view const amount(
+              digits, static_cast<std::size_t>(detail::integer_to_chars(digits, amounts_[i].data()) - digits));
+          // the size is known without writing anything
+          detail::money_put_layout const put(plan, amount, flags, 0, ' ');
+          if constexpr (Write) { out = std::ranges::copy(separator_, put.write(out)).out; }
+          total += put.size() + separator_.size();
+        }
+        return total;
+      }
+      case kind::generic: break;
+      }
+
+      std::string text;
+      for (auto i = begin; i < end; ++i)
+      {
+        text.clear();
+        auto const amount = amounts_[i];
+        std::vformat_to(std::back_inserter(text), locale_, spec_, std::make_format_args(amount));
+        emit(text.data(), text.size());
+      }
+      return total;
+    }
+
+    std::span<money const> amounts_;
+    std::string_view separator_;
+    std::locale locale_;
+    kind kind_{kind::generic};
+    std::string spec_; // replacement field, for the amounts laid out by std::format
+    format_profile const * profile_{nullptr};
+    unsigned digits_{2};
+    std::string_view symbol_;
+    bool showbase_{false};
+    std::size_t workers_{1};
+    std::vector<std::size_t> offsets_; // of the text of each worker
+  };
+
+  // Text of a column of amounts formatted as std::format(locale, "{:<spec>}", amount) does, each followed by a
+  // separator, on `threads` workers (one per hardware thread if 0). Throws std::format_error if spec is not valid.
+  [[nodiscard]] inline std::string format_bulk(std::string_view spec, std::span<money const> amounts,
+                                               std::string_view separator = "\n",
+                                               std::locale const & locale = std::locale(), std::size_t threads = 0)
+  {
+    return bulk_format(spec, amounts, separator, locale, threads).str();
+  }
+} // namespace io1
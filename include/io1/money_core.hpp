@@ -0,0 +1,375 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+
+// The observer of io1::basic_money, e.g. io1::counting_observer, or a type declared before this header is included.
+// It must be the same in every translation unit.
+#ifdef IO1_MONEY_OBSERVER
+#include "io1/money_observer.hpp"
+#else
+#include "io1/detail/money_hooks.hpp"
+#define IO1_MONEY_OBSERVER ::io1::null_observer
+#endif
+
+#include <cassert>
+#include <cfenv>
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+// Amounts and their arithmetic only: streams and std::format are in io1/money_io.hpp and io1/money_format.hpp, and
+// io1/money.hpp includes everything.
+namespace io1
+{
+  namespace detail
+  {
+    using observer = IO1_MONEY_OBSERVER;
+    static_assert(money_observer<observer>,
+                  "IO1_MONEY_OBSERVER must name a type with the hooks of io1::null_observer.");
+
+    // Integer types an amount can be built from or scaled by: the standard ones and the 128-bit extension.
+    template <class T>
+    concept money_integer = std::integral<T> || std::same_as<T, int128_t> || std::same_as<T, uint128_t>;
+
+    // Storage of amounts: any signed integer type, including the 128-bit extension.
+    template <class Int>
+    concept money_storage = std::signed_integral<Int> || std::same_as<Int, int128_t>;
+
+    template <class Int>
+    struct money_unsigned_of : std::make_unsigned<Int>
+    {
+    };
+    template <>
+    struct money_unsigned_of<int128_t>
+    {
+      using type = uint128_t;
+    };
+    template <class Int>
+    using money_unsigned = typename money_unsigned_of<Int>::type;
+
+    // value rounded to the nearest integer, ties to even with the default rounding mode
+    template <class Int>
+    [[nodiscard]] inline Int round_to(long double value) noexcept
+    {
+      if constexpr (sizeof(Int) <= sizeof(long long)) { return static_cast<Int>(std::llrint(value)); }
+      else { return static_cast<Int>(std::rint(value)); }
+    }
+  } // namespace detail
+
+  template <detail::money_storage Int>
+  class basic_money
+  {
+  public:
+    using value_type = Int;
+
+    basic_money() noexcept = default;
+
+    constexpr basic_money(basic_money const &) noexcept = default;
+    constexpr basic_money(basic_money &&) noexcept = default;
+    constexpr basic_money & operator=(basic_money const &) noexcept = default;
+    constexpr basic_money & operator=(basic_money &&) noexcept = default;
+
+    constexpr ~basic_money() noexcept = default;
+
+    template <detail::money_integer T>
+    explicit constexpr basic_money(T amount) noexcept : amount_(static_cast<value_type>(amount))
+    {
+    }
+
+    template <std::floating_point T>
+    explicit constexpr basic_money(T amount) noexcept = delete;
+
+    // widening is exact, narrowing goes through io1::money_cast
+    template <detail::money_storage Other>
+      requires(sizeof(Other) < sizeof(Int))
+    constexpr basic_money(basic_money<Other> other) noexcept // NOLINT(google-explicit-constructor)
+        : amount_(static_cast<value_type>(other.data()))
+    {
+    }
+
+    [[nodiscard]] constexpr value_type const & data() const noexcept { return amount_; }
+
+    [[nodiscard]] constexpr basic_money operator++(int) noexcept { return basic_money{amount_++}; }
+    [[nodiscard]] constexpr basic_money operator--(int) noexcept { return basic_money{amount_--}; }
+
+    constexpr basic_money & operator++() noexcept
+    {
+      ++amount_;
+      return *this;
+    }
+    constexpr basic_money & operator--() noexcept
+    {
+      --amount_;
+      return *this;
+    }
+
+    constexpr basic_money & operator+=(basic_money val) noexcept
+    {
+      amount_ = static_cast<value_type>(amount_ + val.amount_);
+      if (!std::is_constant_evaluated()) { detail::observer::on_sum(amount_); }
+      return *this;
+    }
+    constexpr basic_money & operator-=(basic_money val) noexcept
+    {
+      amount_ = static_cast<value_type>(amount_ - val.amount_);
+      if (!std::is_constant_evaluated()) { detail::observer::on_sum(amount_); }
+      return *this;
+    }
+
+    template <detail::money_integer T>
+    constexpr basic_money & operator*=(T ival) noexcept
+    {
+      amount_ = static_cast<value_type>(amount_ * static_cast<value_type>(ival));
+      return *this;
+    }
+
+    template <std::floating_point T>
+    basic_money & operator*=(T fval) noexcept
+    {
+      assert((std::fegetround() == FE_TONEAREST) &&
+             "Make sure the default rounding mode is active before entering this function.");
+      auto const exact = static_cast<long double>(amount_) * static_cast<long double>(fval);
+      amount_ = detail::round_to<value_type>(exact);
+      detail::observer::on_float_scaling(static_cast<long double>(amount_) != exact);
+      return *this;
+    }
+
+    template <detail::money_integer T>
+    constexpr basic_money & operator/=(T ival);
+
+    template <std::floating_point T>
+    basic_money & operator/=(T fval) noexcept;
+
+    [[nodiscard]] constexpr basic_money operator-() const noexcept
+    {
+      return basic_money{static_cast<value_type>(-amount_)};
+    }
+    [[nodiscard]] friend constexpr std::strong_ordering operator<=>(basic_money lhs,
+                                                                    basic_money rhs) noexcept = default;
+
+    struct [[nodiscard]] InexactDivision : public std::runtime_error
+    {
+      explicit InexactDivision(value_type dividend,         // NOLINT(bugprone-easily-swappable-parameters)
+                               value_type divisor) noexcept // NOLINT(bugprone-easily-swappable-parameters)
+          : std::runtime_error("Cannot perform an inexact division!"), dividend(dividend), divisor(divisor)
+      {
+      }
+
+      value_type dividend;
+      value_type divisor;
+    };
+
+  private:
+    value_type amount_;
+  };
+
+  using money = basic_money<std::int64_t>;
+  using money32 = basic_money<std::int32_t>;
+  using money128 = basic_money<detail::int128_t>;
+
+  static_assert(std::is_trivial_v<io1::money> && std::is_standard_layout_v<io1::money>,
+                "You have changed io1::Money in a way that removed its POD nature!");
+  static_assert(std::is_trivial_v<io1::money32> && std::is_standard_layout_v<io1::money32> &&
+                    sizeof(io1::money32) == sizeof(std::int32_t),
+                "You have changed io1::Money in a way that removed its POD nature!");
+  static_assert(std::is_trivial_v<io1::money128> && std::is_standard_layout_v<io1::money128> &&
+                    sizeof(io1::money128) == sizeof(detail::int128_t),
+                "You have changed io1::Money in a way that removed its POD nature!");
+
+  template <detail::money_storage Int>
+  template <detail::money_integer T>
+  constexpr basic_money<Int> & basic_money<Int>::operator/=(T ival)
+  {
+    assert(0 != ival && "Dividing by zero is undefined behavior.");
+    auto const divisor = static_cast<value_type>(ival);
+    if (0 != amount_ % divisor)
+    {
+      if (!std::is_constant_evaluated()) { detail::observer::on_inexact_division(); }
+      throw InexactDivision{amount_, divisor};
+    }
+
+    // strong guarantee
+    amount_ = static_cast<value_type>(amount_ / divisor);
+
+    return *this;
+  }
+
+  template <detail::money_storage Int>
+  template <std::floating_point T>
+  inline basic_money<Int> & basic_money<Int>::operator/=(T fval) noexcept
+  {
+    assert(0. != fval && "Dividing by zero is undefined behavior.");
+    assert((std::fegetround() == FE_TONEAREST) &&
+           "Make sure the default rounding mode is active before entering this function.");
+    auto const exact = static_cast<long double>(amount_) / static_cast<long double>(fval);
+    amount_ = detail::round_to<value_type>(exact);
+    detail::observer::on_float_scaling(static_cast<long double>(amount_) != exact);
+
+    return *this;
+  }
+
+  template <class Int>
+  [[nodiscard]] inline constexpr basic_money<Int> operator+(basic_money<Int> lhs, basic_money<Int> rhs) noexcept
+  {
+    return lhs += rhs;
+  }
+  template <class Int>
+  [[nodiscard]] inline constexpr basic_money<Int> operator-(basic_money<Int> lhs, basic_money<Int> rhs) noexcept
+  {
+    return lhs -= rhs;
+  }
+
+  template <class Int, class T>
+  constexpr basic_money<Int> operator*(basic_money<Int> lhs, T rhs) = delete;
+
+  template <class Int, detail::money_integer T>
+  [[nodiscard]] constexpr basic_money<Int> operator*(basic_money<Int> lhs, T rhs) noexcept
+  {
+    return lhs *= rhs;
+  }
+
+  template <class Int, detail::money_integer T>
+  [[nodiscard]] constexpr basic_money<Int> operator*(T lhs, basic_money<Int> rhs) noexcept
+  {
+    return rhs *= lhs;
+  }
+
+  template <class Int, std::floating_point T>
+  [[nodiscard]] inline basic_money<Int> operator*(T lhs, basic_money<Int> rhs) noexcept
+  {
+    return rhs *= static_cast<long double>(lhs);
+  }
+
+  template <class Int, detail::money_integer T>
+  [[nodiscard]] constexpr basic_money<Int> operator/(basic_money<Int> lhs, T rhs)
+  {
+    return lhs /= rhs;
+  }
+
+  template <class Int, std::floating_point T>
+  [[nodiscard]] inline basic_money<Int> operator/(basic_money<Int> lhs, T rhs) noexcept
+  {
+    return lhs /= static_cast<long double>(rhs);
+  }
+
+  // Amount of another storage width. Throws std::overflow_error if it is not representable.
+  template <class To, detail::money_storage From>
+    requires std::same_as<To, basic_money<typename To::value_type>>
+  [[nodiscard]] constexpr To money_cast(basic_money<From> amount)
+  {
+    using Int = typename To::value_type;
+    if constexpr (sizeof(Int) < sizeof(From))
+    {
+      if (amount.data() < std::numeric_limits<Int>::lowest() || amount.data() > std::numeric_limits<Int>::max())
+      {
+        throw std::overflow_error("io1::money_cast: amount out of range.");
+      }
+    }
+    return To{static_cast<Int>(amount.data())};
+  }
+
+  namespace detail
+  {
+    // Helper structure to build a io1::Money object from a user-defined string litteral
+    struct StringLitteralDecoder
+    {
+    public:
+      template <class Int, char... STR>
+      [[nodiscard]] constexpr static basic_money<Int> apply() noexcept
+      {
+        return basic_money<Int>{parse_mantissa<Int, 0, STR...>()};
+      }
+
+    private:
+      template <class Int, Int CURRENT_MANTISSA, char DIGIT>
+      [[nodiscard]] constexpr static Int parse_digit() noexcept
+      {
+        static_assert('0' <= DIGIT && '9' >= DIGIT, "Unexpected digit!");
+
+        constexpr auto digit = static_cast<Int>(DIGIT - '0');
+        constexpr auto ten = static_cast<Int>(10);
+
+        static_assert(CURRENT_MANTISSA >= 0, "Parsing a raw user-defined litteral.");
+        static_assert((std::numeric_limits<Int>::max() - digit) / ten >= CURRENT_MANTISSA,
+                      "Number not representable by io1::Money");
+
+        return static_cast<Int>(ten * CURRENT_MANTISSA + digit);
+      }
+
+      template <char DIGIT>
+      [[nodiscard]] constexpr static bool not_a_digit() noexcept
+      {
+        return (DIGIT == '.' || DIGIT == '\'');
+      }
+
+      template <class Int, Int CURRENT_MANTISSA, char DIGIT, char... STR>
+      constexpr static Int parse_mantissa() noexcept
+      {
+        constexpr auto new_mantissa = []()
+        {
+          if constexpr (not_a_digit<DIGIT>()) { return CURRENT_MANTISSA; }
+          else { return parse_digit<Int, CURRENT_MANTISSA, DIGIT>(); }
+        }();
+
+        if constexpr (0 < sizeof...(STR)) { return parse_mantissa<Int, new_mantissa, STR...>(); }
+        else { return new_mantissa; }
+      }
+    };
+  } // namespace detail
+
+  namespace detail
+  {
+    template <class Int>
+    struct moneydiv_quotrem_t
+    {
+      basic_money<Int> quot;
+      basic_money<Int> rem;
+    };
+    template <class Int>
+    struct moneydiv_remquot_t
+    {
+      basic_money<Int> rem;
+      basic_money<Int> quot;
+    };
+    constexpr bool is_quot_rem_v = 10 == std::div_t{10, 5}.quot;
+  } // namespace detail
+
+  template <class Int>
+  using basic_moneydiv_t =
+      std::conditional_t<detail::is_quot_rem_v, detail::moneydiv_quotrem_t<Int>, detail::moneydiv_remquot_t<Int>>;
+  using moneydiv_t = basic_moneydiv_t<money::value_type>;
+
+  template <class Int>
+  [[nodiscard]] inline basic_moneydiv_t<Int> div(basic_money<Int> val, std::type_identity_t<Int> divisor) noexcept
+  {
+    assert(0 != divisor && "Division by zero is undefined behavior.");
+
+    return {.quot = basic_money<Int>(val.data() / divisor), .rem = basic_money<Int>(val.data() % divisor)};
+  }
+
+  inline namespace literals
+  {
+    template <char... STR>
+    constexpr io1::money operator""_money() noexcept
+    {
+      return io1::detail::StringLitteralDecoder::apply<io1::money::value_type, STR...>();
+    }
+
+    template <char... STR>
+    constexpr io1::money32 operator""_money32() noexcept
+    {
+      return io1::detail::StringLitteralDecoder::apply<io1::money32::value_type, STR...>();
+    }
+
+    template <char... STR>
+    constexpr io1::money128 operator""_money128() noexcept
+    {
+      return io1::detail::StringLitteralDecoder::apply<io1::money128::value_type, STR...>();
+    }
+  } // namespace literals
+} // namespace io1
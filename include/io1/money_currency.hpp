@@ -0,0 +1,339 @@
+#pragma once
+
+#include "io1/detail/money_chars.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_format.hpp"
+#include "io1/money_iso4217.hpp"
+#include "io1/money_profile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iosfwd>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace io1
+{
+  namespace detail
+  {
+    // Structural wrapper so that currency codes can be template arguments: currency<"EUR">.
+    struct currency_code
+    {
+      consteval currency_code(char const (&code)[4]) noexcept // NOLINT(google-explicit-constructor)
+          : value{code[0], code[1], code[2]}
+      {
+      }
+
+      [[nodiscard]] constexpr std::string_view view() const noexcept { return {value, 3}; }
+
+      char value[3]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    };
+  } // namespace detail
+
+  // Tag of an ISO 4217 currency.
+  template <detail::currency_code Code>
+  struct currency
+  {
+    static_assert(nullptr != find_currency(Code.view()), "Not an ISO 4217 currency code.");
+
+    static constexpr std::string_view code = find_currency(Code.view())->code;
+    static constexpr std::uint16_t numeric = find_currency(Code.view())->numeric;
+    static constexpr unsigned minor_unit = find_currency(Code.view())->minor_unit;
+  };
+
+  // Any type with a code and a number of minor unit digits can tag amounts, ISO 4217 or not.
+  template <class C>
+  concept currency_tag = requires {
+    {
+      C::code
+    } -> std::convertible_to<std::string_view>;
+    {
+      C::minor_unit
+    } -> std::convertible_to<unsigned>;
+  } && C::minor_unit <= 18;
+
+  // An amount of minor units of a currency known at compile time. Amounts of different currencies do not mix, and the
+  // layout and operations are the ones of io1::money.
+  template <currency_tag Currency>
+  class tagged_money
+  {
+  public:
+    using currency_type = Currency;
+    using value_type = money::value_type;
+    static constexpr unsigned minor_unit = Currency::minor_unit;
+
+    tagged_money() noexcept = default;
+
+    template <std::integral T>
+    explicit constexpr tagged_money(T minor_units) noexcept : amount_(minor_units)
+    {
+    }
+
+    template <std::floating_point T>
+    explicit constexpr tagged_money(T amount) noexcept = delete;
+
+    explicit constexpr tagged_money(money amount) noexcept : amount_(amount) {}
+
+    [[nodiscard]] constexpr value_type const & data() const noexcept { return amount_.data(); }
+
+    // The same amount, untagged.
+    [[nodiscard]] constexpr money const & amount() const noexcept { return amount_; }
+
+    [[nodiscard]] constexpr tagged_money operator++(int) noexcept { return tagged_money{amount_++}; }
+    [[nodiscard]] constexpr tagged_money operator--(int) noexcept { return tagged_money{amount_--}; }
+
+    constexpr tagged_money & operator++() noexcept
+    {
+      ++amount_;
+      return *this;
+    }
+    constexpr tagged_money & operator--() noexcept
+    {
+      --amount_;
+      return *this;
+    }
+
+    constexpr tagged_money & operator+=(tagged_money val) noexcept
+    {
+      amount_ += val.amount_;
+      return *this;
+    }
+    constexpr tagged_money & operator-=(tagged_money val) noexcept
+    {
+      amount_ -= val.amount_;
+      return *this;
+    }
+
+    template <std::integral T>
+    constexpr tagged_money & operator*=(T ival) noexcept
+    {
+      amount_ *= ival;
+      return *this;
+    }
+
+    template <std::floating_point T>
+    tagged_money & operator*=(T fval) noexcept
+    {
+      amount_ *= fval;
+      return *this;
+    }
+
+    template <std::integral T>
+    constexpr tagged_money & operator/=(T ival)
+    {
+      amount_ /= ival;
+      return *this;
+    }
+
+    template <std::floating_point T>
+    tagged_money & operator/=(T fval) noexcept
+    {
+      amount_ /= fval;
+      return *this;
+    }
+
+    [[nodiscard]] constexpr tagged_money operator-() const noexcept { return tagged_money{-amount_}; }
+    [[nodiscard]] friend constexpr std::strong_ordering operator<=>(tagged_money lhs,
+                                                                    tagged_money rhs) noexcept = default;
+
+  private:
+    money amount_;
+  };
+
+  static_assert(sizeof(tagged_money<currency<"USD">>) == sizeof(money) &&
+                    alignof(tagged_money<currency<"USD">>) == alignof(money) &&
+                    std::is_trivial_v<tagged_money<currency<"USD">>> &&
+                    std::is_standard_layout_v<tagged_money<currency<"USD">>>,
+                "Tagged amounts must be drop-in replacements of io1::money.");
+
+  template <class C>
+  [[nodiscard]] constexpr tagged_money<C> operator+(tagged_money<C> lhs, tagged_money<C> rhs) noexcept
+  {
+    return lhs += rhs;
+  }
+  template <class C>
+  [[nodiscard]] constexpr tagged_money<C> operator-(tagged_money<C> lhs, tagged_money<C> rhs) noexcept
+  {
+    return lhs -= rhs;
+  }
+
+  template <class C, class T>
+  constexpr tagged_money<C> operator*(tagged_money<C> lhs, T rhs) = delete;
+
+  template <class C, std::integral T>
+  [[nodiscard]] constexpr tagged_money<C> operator*(tagged_money<C> lhs, T rhs) noexcept
+  {
+    return lhs *= rhs;
+  }
+
+  template <std::integral T, class C>
+  [[nodiscard]] constexpr tagged_money<C> operator*(T lhs, tagged_money<C> rhs) noexcept
+  {
+    return rhs *= lhs;
+  }
+
+  template <std::floating_point T, class C>
+  [[nodiscard]] inline tagged_money<C> operator*(T lhs, tagged_money<C> rhs) noexcept
+  {
+    return rhs *= static_cast<long double>(lhs);
+  }
+
+  template <class C, std::integral T>
+  [[nodiscard]] constexpr tagged_money<C> operator/(tagged_money<C> lhs, T rhs)
+  {
+    return lhs /= rhs;
+  }
+
+  template <class C, std::floating_point T>
+  [[nodiscard]] inline tagged_money<C> operator/(tagged_money<C> lhs, T rhs) noexcept
+  {
+    return lhs /= static_cast<long double>(rhs);
+  }
+
+  // Decimal representation with exactly the minor unit digits of the currency, e.g. "-12.30" for USD.
+  template <class C>
+  constexpr std::to_chars_result to_chars(char * first, char * last, tagged_money<C> value) noexcept
+  {
+    return detail::to_decimal_chars(first, last, value.data(), C::minor_unit);
+  }
+
+  // Parse a decimal number with at most the minor unit digits of the currency: "12", "12.3" and "12.30" are all
+  // 1230 cents of USD.
+  template <class C>
+  constexpr std::from_chars_result from_chars(char const * first, char const * last, tagged_money<C> & value) noexcept
+  {
+    money::value_type amount = 0;
+    auto const result = detail::from_decimal_chars(first, last, amount, C::minor_unit);
+    if (std::errc{} == result.ec) { value = tagged_money<C>{amount}; }
+    return result;
+  }
+
+  // Lay out `amount` according to `profile` with the minor unit digits of `currency`, and its symbol, or code, if
+  // show_symbol is true.
+  constexpr std::to_chars_result to_chars(char * first, char * last, money amount, format_profile const & profile,
+                                          currency_info const & currency, bool show_symbol = false) noexcept
+  {
+    char buffer[detail::profile_buffer_size]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto const symbol = !show_symbol ? std::string_view{} : profile.code ? currency.code : currency.symbol;
+    auto const size = detail::format_with_profile(buffer, amount.data(), currency.minor_unit, profile, symbol);
+    if (static_cast<std::size_t>(last - first) < size) { return {last, std::errc::value_too_large}; }
+    return {std::ranges::copy(buffer, buffer + size, first).out, std::errc{}};
+  }
+
+  template <class C>
+  constexpr std::to_chars_result to_chars(char * first, char * last, tagged_money<C> value,
+                                          format_profile const & profile, bool show_symbol = false) noexcept
+  {
+    constexpr std::string_view code = C::code;
+    auto const * const iso = find_currency(code);
+    currency_info const currency{.code = code,
+                                 .numeric = 0,
+                                 .minor_unit = static_cast<std::uint8_t>(C::minor_unit),
+                                 .symbol = nullptr != iso ? iso->symbol : code};
+    return to_chars(first, last, value.amount(), profile, currency, show_symbol);
+  }
+
+  template <class C>
+  std::ostream & operator<<(std::ostream & stream, tagged_money<C> val)
+  {
+    char buffer[24]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto const result = to_chars(std::begin(buffer), std::end(buffer), val);
+    return stream << std::string_view(std::begin(buffer), result.ptr);
+  }
+} // namespace io1
+
+// Same syntax as io1::money for the localized m and M types and for profiles, whose currency is the one of the type.
+// Otherwise, the syntax is the one of strings followed by an optional #, to append the currency code, and the amount is
+// written as a decimal number.
+template <class Currency, class CharT>
+struct std::formatter<io1::tagged_money<Currency>, CharT>
+{
+  template <class FormatParseContext>
+  constexpr auto parse(FormatParseContext & ctx)
+  {
+    auto close_pos = ctx.begin();
+    while (close_pos != ctx.end() && *close_pos != '}') { ++close_pos; }
+
+    std::basic_string_view<CharT> spec(ctx.begin(), close_pos);
+
+    if (auto const profile = io1::detail::parse_profile_spec(spec); nullptr != profile.profile)
+    {
+      if constexpr (!std::is_same_v<CharT, char>) { throw std::format_error("io1::money: format profiles are UTF-8."); }
+      if (nullptr != profile.currency) { throw std::format_error("io1::tagged_money: the currency is the type's."); }
+      profile_ = profile.profile;
+      showcode_ = profile.show_symbol;
+      FormatParseContext subctx(spec.substr(0, profile.string_spec_size));
+      string_.parse(subctx);
+      return close_pos;
+    }
+
+    if (spec.ends_with('m') || spec.ends_with('M'))
+    {
+      locale_ = true;
+      return money_.parse(ctx);
+    }
+
+    if (spec.ends_with('#'))
+    {
+      showcode_ = true;
+      spec.remove_suffix(1);
+    }
+
+    FormatParseContext subctx(spec);
+    string_.parse(subctx);
+
+    return close_pos;
+  }
+
+  template <class FormatContext>
+  auto format(io1::tagged_money<Currency> const & val, FormatContext & ctx) const
+  {
+    if (locale_) { return money_.format(val.amount(), ctx); }
+
+    if constexpr (std::is_same_v<CharT, char>)
+    {
+      if (nullptr != profile_)
+      {
+        char buffer[io1::detail::profile_buffer_size + code.size()]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        auto const shown = !showcode_ ? std::string_view{} : profile_->code ? code : symbol;
+        auto const size = io1::detail::format_with_profile(buffer, val.data(), Currency::minor_unit, *profile_, shown);
+        return string_.format(std::string_view(buffer, size), ctx);
+      }
+    }
+
+    char buffer[capacity]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto * last = to_chars(std::begin(buffer), std::end(buffer), val).ptr;
+    if (showcode_)
+    {
+      *last++ = ' ';
+      last = std::ranges::copy(code, last).out;
+    }
+
+    CharT text[capacity]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto const size = static_cast<std::size_t>(std::ranges::copy(std::begin(buffer), last, std::begin(text)).out -
+                                               std::begin(text));
+    return string_.format(std::basic_string_view<CharT>(text, size), ctx);
+  }
+
+  // an amount takes 22 characters at most, a space and the code follow
+  static constexpr std::string_view code = Currency::code;
+  static constexpr std::size_t capacity = 24 + code.size();
+  static constexpr std::string_view symbol =
+      nullptr != io1::find_currency(code) ? io1::find_currency(code)->symbol : code;
+
+  bool locale_ : 1 {false};
+  bool showcode_ : 1 {false};
+  io1::format_profile const * profile_{nullptr};
+  std::formatter<io1::money, CharT> money_;
+  std::formatter<std::basic_string_view<CharT>, CharT> string_;
+};
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace io1
+{
+  // One bit per row of a column, set when the row is selected.
+  class selection_bitmap
+  {
+  public:
+    using word_type = std::uint64_t;
+    static constexpr std::size_t word_bits = std::numeric_limits<word_type>::digits;
+
+    selection_bitmap() noexcept = default;
+    explicit selection_bitmap(std::size_t size) : words_((size + word_bits - 1) / word_bits, 0), size_(size) {}
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::span<word_type> words() noexcept { return words_; }
+    [[nodiscard]] std::span<word_type const> words() const noexcept { return words_; }
+
+    [[nodiscard]] bool test(std::size_t i) const noexcept
+    {
+      assert(i < size_ && "Row out of range.");
+      return 0 != (words_[i / word_bits] & (word_type{1} << (i % word_bits)));
+    }
+    void set(std::size_t i) noexcept
+    {
+      assert(i < size_ && "Row out of range.");
+      words_[i / word_bits] |= word_type{1} << (i % word_bits);
+    }
+
+    [[nodiscard]] std::size_t count() const noexcept
+    {
+      std::size_t result = 0;
+      for (auto const word : words_) { result += static_cast<std::size_t>(std::popcount(word)); }
+      return result;
+    }
+
+    // Call f(i) on each selected row, in increasing order.
+    template <class F>
+    void for_each(F && f) const
+    {
+      for (std::size_t w = 0; w < words_.size(); ++w)
+      {
+        for (auto word = words_[w]; 0 != word; word &= word - 1)
+        {
+          f(w * word_bits + static_cast<std::size_t>(std::countr_zero(word)));
+        }
+      }
+    }
+
+    selection_bitmap & operator&=(selection_bitmap const & o) noexcept
+    {
+      assert(size_ == o.size_ && "Combining selections of different columns.");
+      for (std::size_t w = 0; w < words_.size(); ++w) { words_[w] &= o.words_[w]; }
+      return *this;
+    }
+    selection_bitmap & operator|=(selection_bitmap const & o) noexcept
+    {
+      assert(size_ == o.size_ && "Combining selections of different columns.");
+      for (std::size_t w = 0; w < words_.size(); ++w) { words_[w] |= o.words_[w]; }
+      return *this;
+    }
+
+    [[nodiscard]] friend bool operator==(selection_bitmap const &, selection_bitmap const &) noexcept = default;
+
+  private:
+    std::vector<word_type> words_;
+    std::size_t size_{0};
+  };
+
+  [[nodiscard]] inline selection_bitmap operator&(selection_bitmap lhs, selection_bitmap const & rhs) noexcept
+  {
+    return lhs &= rhs;
+  }
+  [[nodiscard]] inline selection_bitmap operator|(selection_bitmap lhs, selection_bitmap const & rhs) noexcept
+  {
+    return lhs |= rhs;
+  }
+
+  namespace detail
+  {
+    // Selection word for up to 64 amounts starting at `values`, bounds included.
+    [[nodiscard]] inline std::uint64_t select_word(money const * values, std::size_t count, money lower,
+                                                   money upper) noexcept
+    {
+      static_assert(sizeof(money) == sizeof(std::int64_t), "Kernels load amounts as packed 64-bit integers.");
+      std::uint64_t word = 0;
+      std::size_t i = 0;
+#if defined(__AVX512F__)
+      auto const lo = _mm512_set1_epi64(lower.data());
+      auto const hi = _mm512_set1_epi64(upper.data());
+      for (; i + 8 <= count; i += 8)
+      {
+        auto const v = _mm512_loadu_si512(values + i);
+        auto const mask = _mm512_cmpge_epi64_mask(v, lo) & _mm512_cmple_epi64_mask(v, hi);
+        word |= static_cast<std::uint64_t>(mask) << i;
+      }
+#elif defined(__AVX2__)
+      auto const lo = _mm256_set1_epi64x(lower.data());
+      auto const hi = _mm256_set1_epi64x(upper.data());
+      for (; i + 4 <= count; i += 4)
+      {
+        auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(values + i)); // NOLINT
+        auto const out = _mm256_or_si256(_mm256_cmpgt_epi64(lo, v), _mm256_cmpgt_epi64(v, hi));
+        auto const mask = ~_mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xF;
+        word |= static_cast<std::uint64_t>(mask) << i;
+      }
+#endif
+      for (auto const end = std::min<std::size_t>(count, 64); i < end; ++i)
+      {
+        word |= static_cast<std::uint64_t>(lower <= values[i] && values[i] <= upper) << i;
+      }
+      return word;
+    }
+
+    // Permutations of 32-bit lanes moving the 64-bit lanes selected by each 4-bit mask to the front, in order.
+    inline constexpr auto compress_permutations = []
+    {
+      std::array<std::array<std::int32_t, 8>, 16> result{};
+      for (std::size_t mask = 0; mask < result.size(); ++mask)
+      {
+        std::size_t n = 0;
+        for (std::int32_t lane = 0; lane < 4; ++lane)
+        {
+          if (0 == ((mask >> lane) & 1U)) { continue; }
+          result[mask][n++] = 2 * lane;
+          result[mask][n++] = 2 * lane + 1;
+        }
+      }
+      return result;
+    }();
+  } // namespace detail
+
+  // Select the amounts within [lower, upper]. Use ++/-- on the bounds for strict comparisons.
+  inline void select_between(std::span<money const> values, money lower, money upper, selection_bitmap & out) noexcept
+  {
+    assert(out.size() == values.size() && "The bitmap must have one bit per amount.");
+    auto words = out.words();
+    auto const full = values.size() / selection_bitmap::word_bits;
+    for (std::size_t w = 0; w < full; ++w)
+    {
+      words[w] = detail::select_word(values.data() + w * selection_bitmap::word_bits, selection_bitmap::word_bits,
+                                     lower, upper);
+    }
+    if (auto const tail = values.size() % selection_bitmap::word_bits; 0 != tail)
+    {
+      words[full] = detail::select_word(values.data() + full * selection_bitmap::word_bits, tail, lower, upper);
+    }
+  }
+
+  [[nodiscard]] inline selection_bitmap select_between(std::span<money const> values, money lower, money upper)
+  {
+    selection_bitmap result(values.size());
+    select_between(values, lower, upper, result);
+    return result;
+  }
+
+  [[nodiscard]] inline selection_bitmap select_at_least(std::span<money const> values, money lower)
+  {
+    return select_between(values, lower, money{std::numeric_limits<money::value_type>::max()});
+  }
+
+  [[nodiscard]] inline selection_bitmap select_at_most(std::span<money const> values, money upper)
+  {
+    return select_between(values, money{std::numeric_limits<money::value_type>::lowest()}, upper);
+  }
+
+  // Append the positions of the amounts within [lower, upper] to `out` and return how many were appended.
+  inline std::size_t select_indices(std::span<money const> values, money lower, money upper,
+                                    std::vector<std::size_t> & out)
+  {
+    auto const first = out.size();
+    out.resize(first + values.size());
+    auto * dest = out.data() + first;
+    std::size_t i = 0;
+
+#if defined(__AVX512F__)
+    static_assert(sizeof(std::size_t) == sizeof(std::int64_t), "Indices are compressed as 64-bit lanes.");
+    auto const lo = _mm512_set1_epi64(lower.data());
+    auto const hi = _mm512_set1_epi64(upper.data());
+    auto index = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+    auto const step = _mm512_set1_epi64(8);
+    for (; i + 8 <= values.size(); i += 8)
+    {
+      auto const v = _mm512_loadu_si512(values.data() + i);
+      auto const mask = static_cast<__mmask8>(_mm512_cmpge_epi64_mask(v, lo) & _mm512_cmple_epi64_mask(v, hi));
+      _mm512_mask_compressstoreu_epi64(dest, mask, index);
+      dest += std::popcount(static_cast<unsigned int>(mask));
+      index = _mm512_add_epi64(index, step);
+    }
+#elif defined(__AVX2__)
+    // no compress instruction: the selected lanes are moved to the front by a permutation looked up from the mask
+    static_assert(sizeof(std::size_t) == sizeof(std::int64_t), "Indices are compressed as 64-bit lanes.");
+    auto const lo = _mm256_set1_epi64x(lower.data());
+    auto const hi = _mm256_set1_epi64x(upper.data());
+    auto index = _mm256_set_epi64x(3, 2, 1, 0);
+    auto const step = _mm256_set1_epi64x(4);
+    for (; i + 4 <= values.size(); i += 4)
+    {
+      auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(values.data() + i)); // NOLINT
+      auto const outside = _mm256_or_si256(_mm256_cmpgt_epi64(lo, v), _mm256_cmpgt_epi64(v, hi));
+      auto const mask = ~static_cast<unsigned int>(_mm256_movemask_pd(_mm256_castsi256_pd(outside))) & 0xFU;
+      auto const permutation =
+          _mm256_loadu_si256(reinterpret_cast<__m256i const *>(detail::compress_permutations[mask].data())); // NOLINT
+      // all four lanes are stored, but only the selected ones are kept: there is room for them until the end
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest), _mm256_permutevar8x32_epi32(index, permutation)); // NOLINT
+      dest += std::popcount(mask);
+      index = _mm256_add_epi64(index, step);
+    }
+#endif
+
+    for (; i < values.size(); i += selection_bitmap::word_bits)
+    {
+      auto const count = std::min(selection_bitmap::word_bits, values.size() - i);
+      for (auto word = detail::select_word(values.data() + i, count, lower, upper); 0 != word; word &= word - 1)
+      {
+        *dest++ = i + static_cast<std::size_t>(std::countr_zero(word));
+      }
+    }
+
+    auto const selected = static_cast<std::size_t>(dest - (out.data() + first));
+    out.resize(first + selected);
+    return selected;
+  }
+
+  // Sum of the selected amounts. Overflow has undefined behavior.
+  [[nodiscard]] inline money gather_sum(std::span<money const> values, selection_bitmap const & selection) noexcept
+  {
+    assert(selection.size() == values.size() && "The bitmap must have one bit per amount.");
+    auto const words = selection.words();
+    money::value_type total = 0;
+    for (std::size_t w = 0; w < words.size(); ++w)
+    {
+      auto const word = words[w];
+      auto const * const block = values.data() + w * selection_bitmap::word_bits;
+      if (~std::uint64_t{0} == word)
+      {
+        // dense block: plain vectorizable sum
+        for (std::size_t b = 0; b < selection_bitmap::word_bits; ++b) { total += block[b].data(); }
+      }
+      else
+      {
+        for (auto bits = word; 0 != bits; bits &= bits - 1)
+        {
+          total += block[static_cast<std::size_t>(std::countr_zero(bits))].data();
+        }
+      }
+    }
+    return money{total};
+  }
+
+  [[nodiscard]] inline money gather_sum(std::span<money const> values, std::span<std::size_t const> indices) noexcept
+  {
+    money::value_type total = 0;
+    for (auto const i : indices) { total += values[i].data(); }
+    return money{total};
+  }
+
+  // Append the selected amounts to `out`, in order.
+  inline void gather(std::span<money const> values, selection_bitmap const & selection, std::vector<money> & out)
+  {
+    assert(selection.size() == values.size() && "The bitmap must have one bit per amount.");
+    out.reserve(out.size() + selection.count());
+    selection.for_each([&](std::size_t i) { out.push_back(values[i]); });
+  }
+} // namespace io1
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "io1/detail/money_chars.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_profile.hpp"
+#include "io1/money_punct_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <iomanip>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace io1::detail
+{
+  // The integer presentation of the standard, [[fill]align][sign][#][0][width][type] with the types d, b, B, o, x and
+  // X, for the 128-bit integers it does not format. Padding is left to a string formatter. Nested width arguments and
+  // the locale option L are not supported.
+  template <class Int, class CharT>
+  class wide_integer_formatter
+  {
+  public:
+    constexpr void parse(std::basic_string_view<CharT> spec)
+    {
+      auto const is_align = [](CharT c) noexcept { return '<' == c || '^' == c || '>' == c; };
+      std::size_t fill_size = 1; // a code point, of up to 4 code units in UTF-8
+      if constexpr (std::is_same_v<CharT, char>)
+      {
+        auto const lead = static_cast<unsigned char>(spec.empty() ? '\0' : spec.front());
+        fill_size = 0xF0U <= lead ? 4U : 0xE0U <= lead ? 3U : 0xC0U <= lead ? 2U : 1U;
+      }
+      std::size_t i = 0;
+      if (fill_size < spec.size() && is_align(spec[fill_size])) { i = fill_size + 1; }
+      else if (!spec.empty() && is_align(spec.front())) { i = 1; }
+      auto const aligned = 0 != i;
+      std::basic_string<CharT> padding(spec.substr(0, i));
+
+      if (i < spec.size() && ('+' == spec[i] || '-' == spec[i] || ' ' == spec[i]))
+      {
+        sign_ = static_cast<char>(spec[i++]);
+      }
+      if (i < spec.size() && '#' == spec[i])
+      {
+        prefix_ = true;
+        ++i;
+      }
+      if (i < spec.size() && '0' == spec[i])
+      {
+        zero_ = !aligned; // as in the standard, zeros only pad amounts without alignment
+        ++i;
+      }
+      auto const width_begin = i;
+      for (; i < spec.size() && '0' <= spec[i] && spec[i] <= '9'; ++i)
+      {
+        width_ = width_ * 10 + static_cast<std::size_t>(spec[i] - '0');
+      }
+      auto const width_end = i;
+      if (i < spec.size() && ('d' == spec[i] || 'b' == spec[i] || 'B' == spec[i] || 'o' == spec[i] || 'x' == spec[i] ||
+                              'X' == spec[i]))
+      {
+        type_ = static_cast<char>(spec[i++]);
+      }
+      if (i != spec.size())
+      {
+        throw std::format_error("io1::money: invalid format specification for a 128-bit amount.");
+      }
+
+      if (!zero_ && 0 != width_)
+      {
+        if (!aligned) { padding += CharT{'>'}; } // numbers are right-aligned by default
+        padding += spec.substr(width_begin, width_end - width_begin);
+      }
+      std::basic_format_parse_context<CharT> subctx(padding);
+      padded_.parse(subctx);
+    }
+
+    template <class FormatContext>
+    auto format(Int value, FormatContext & ctx) const
+    {
+      auto const upper = 'X' == type_ || 'B' == type_;
+      unsigned const base = 'x' == type_ || 'X' == type_   ? 16U
+                            : 'o' == type_                 ? 8U
+                            : 'b' == type_ || 'B' == type_ ? 2U
+                                                           : 10U;
+
+      CharT text[131]; // NOLINT(cppcoreguidelines-avoid-c-arrays): sign, prefix and 128 binary digits
+      std::size_t size = 0;
+      if (value < 0) { text[size++] = CharT{'-'}; }
+      else if ('-' != sign_ && 0 != sign_) { text[size++] = static_cast<CharT>(sign_); }
+      if (prefix_ && 10U != base && (8U != base || 0 != value))
+      {
+        text[size++] = CharT{'0'};
+        if (8U != base) { text[size++] = static_cast<CharT>(type_); }
+      }
+      auto const prefix_size = size;
+
+      using unsigned_type = io1::detail::money_unsigned<Int>;
+      auto magnitude =
+          value < 0 ? unsigned_type{0} - static_cast<unsigned_type>(value) : static_cast<unsigned_type>(value);
+      auto const * const digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+      auto * const last = text + std::size(text);
+      auto * first = last;
+      do
+      {
+        *--first = static_cast<CharT>(digits[static_cast<std::size_t>(magnitude % base)]);
+        magnitude /= base;
+      } while (0 != magnitude);
+      auto const digit_count = static_cast<std::size_t>(last - first);
+
+      if (zero_ && prefix_size + digit_count < width_)
+      {
+        auto out = std::ranges::copy(text, text + prefix_size, ctx.out()).out;
+        out = std::ranges::fill_n(out, static_cast<std::ptrdiff_t>(width_ - prefix_size - digit_count), CharT{'0'});
+        return std::ranges::copy(first, last, out).out;
+      }
+      std::ranges::copy(first, last, text + prefix_size);
+      return padded_.format(std::basic_string_view<CharT>(text, prefix_size + digit_count), ctx);
+    }
+
+  private:
+    char sign_{0};
+    char type_{0};
+    bool prefix_{false};
+    bool zero_{false};
+    std::size_t width_{0};
+    std::formatter<std::basic_string_view<CharT>, CharT> padded_;
+  };
+} // namespace io1::detail
+
+template <class Int, class CharT>
+struct std::formatter<io1::basic_money<Int>, CharT>
+{
+  // the standard formats no 128-bit integer: io1::detail::wide_integer_formatter does
+  static constexpr bool wide = sizeof(Int) > sizeof(long long);
+
+  template <class FormatParseContext>
+  constexpr auto parse(FormatParseContext & ctx)
+  {
+    auto close_pos = ctx.begin();
+    while (close_pos != ctx.end() && *close_pos != '}') { ++close_pos; }
+
+    std::basic_string_view<CharT> const spec(ctx.begin(), close_pos);
+
+    if (auto const profile = io1::detail::parse_profile_spec(spec); nullptr != profile.profile)
+    {
+      if constexpr (!std::is_same_v<CharT, char>) { throw std::format_error("io1::money: format profiles are UTF-8."); }
+      profile_ = profile;
+      FormatParseContext subctx(spec.substr(0, profile.string_spec_size));
+      string_.parse(subctx);
+      return close_pos;
+    }
+
+    if (spec.ends_with("m")) { locale_ = true; }
+    else if (spec.ends_with("M"))
+    {
+      locale_ = true;
+      intl_ = true;
+    }
+
+    if (!locale_)
+    {
+      if constexpr (wide)
+      {
+        int_.parse(spec);
+        return close_pos;
+      }
+      else { return int_.parse(ctx); }
+    }
+
+    auto size = spec.size() - 1;
+
+    if (spec.find('#') != spec.npos)
+    {
+      --size;
+      showbase_ = true;
+    }
+
+    FormatParseContext subctx(spec.substr(0, size));
+    string_.parse(subctx);
+
+    return close_pos;
+  }
+
+  template <class FormatContext>
+  auto format(io1::basic_money<Int> const & val, FormatContext & ctx) const
+  {
+    if constexpr (std::is_same_v<CharT, char>)
+    {
+      if (nullptr != profile_.profile)
+      {
+        // no locale and no allocation: the amount is laid out in a local buffer
+        char buffer[io1::detail::profile_buffer_size]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        auto const * const currency = profile_.currency;
+        auto const digits = nullptr != currency ? currency->minor_unit : 2U;
+        std::string_view symbol;
+        if (profile_.show_symbol && nullptr != currency)
+        {
+          symbol = profile_.profile->code ? currency->code : currency->symbol;
+        }
+        auto const size = io1::detail::format_with_profile(buffer, val.data(), digits, *profile_.profile, symbol);
+        io1::detail::observer::on_format(false);
+        return string_.format(std::string_view(buffer, size), ctx);
+      }
+    }
+
+    if (!locale_)
+    {
+      io1::detail::observer::on_format(false);
+      return int_.format(val.data(), ctx);
+    }
+
+    char digits[40]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto const * const end = io1::detail::integer_to_chars(digits, val.data());
+    std::string_view const amount(digits, static_cast<std::size_t>(end - digits));
+
+    if constexpr (std::is_same_v<CharT, char>)
+    {
+      auto const locale = ctx.locale();
+      auto const & plan = intl_ ? io1::detail::moneypunct_cache<true>::lookup(locale)
+                                : io1::detail::moneypunct_cache<false>::lookup(locale);
+      if (plan.standard_put)
+      {
+        io1::detail::observer::on_format(false);
+        io1::detail::money_put_layout const layout(plan, amount,
+                                                   showbase_ ? std::ios_base::showbase : std::ios_base::fmtflags{}, 0,
+                                                   ' ');
+        return io1::detail::with_money_put(layout, [&](std::string_view text) { return string_.format(text, ctx); });
+      }
+    }
+
+    io1::detail::observer::on_format(std::is_same_v<CharT, char>);
+    std::basic_stringstream<CharT> stream;
+    stream.imbue(ctx.locale());
+    stream << (showbase_ ? std::showbase : std::noshowbase) << std::put_money(std::string(amount), intl_);
+    return string_.format(stream.str(), ctx);
+  }
+
+  bool locale_ : 1 {false};
+  bool showbase_ : 1 {false};
+  bool intl_ : 1 {false};
+  io1::detail::profile_spec profile_;
+  std::conditional_t<wide, io1::detail::wide_integer_formatter<Int, CharT>, std::formatter<Int, CharT>> int_;
+  std::formatter<std::basic_string_view<CharT>, CharT> string_;
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_iso4217.hpp"
+#include "io1/money_rounding.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace io1
+{
+  // Exact rate: one major unit of the base currency is worth numerator / denominator major units of the quote one.
+  struct fx_rate
+  {
+    std::int64_t numerator;
+    std::int64_t denominator{1};
+
+    [[nodiscard]] friend constexpr bool operator==(fx_rate const &, fx_rate const &) noexcept = default;
+  };
+
+  namespace detail
+  {
+    [[nodiscard]] constexpr uint128_t gcd(uint128_t a, uint128_t b) noexcept
+    {
+      while (0 != b)
+      {
+        auto const r = a % b;
+        a = b;
+        b = r;
+      }
+      return a;
+    }
+
+    // numerator / denominator in lowest terms with a positive denominator. Throws if it does not fit in 64 bits.
+    [[nodiscard]] constexpr fx_rate reduce(int128_t numerator, int128_t denominator)
+    {
+      assert(0 != denominator && "Rates have a non-zero denominator.");
+      if (denominator < 0)
+      {
+        numerator = -numerator;
+        denominator = -denominator;
+      }
+      auto const magnitude = static_cast<uint128_t>(numerator < 0 ? -numerator : numerator);
+      auto const divisor = static_cast<int128_t>(gcd(magnitude, static_cast<uint128_t>(denominator)));
+      if (0 != divisor)
+      {
+        numerator /= divisor;
+        denominator /= divisor;
+      }
+
+      constexpr auto max = std::numeric_limits<std::int64_t>::max();
+      if (numerator > max || -numerator > max || denominator > max)
+      {
+        throw std::overflow_error("io1::fx_table: rate too precise for 64-bit terms.");
+      }
+      return {.numerator = static_cast<std::int64_t>(numerator), .denominator = static_cast<std::int64_t>(denominator)};
+    }
+
+    [[nodiscard]] constexpr int128_t power_of_ten(unsigned exponent) noexcept
+    {
+      int128_t result = 1;
+      while (0 != exponent--) { result *= 10; }
+      return result;
+    }
+  } // namespace detail
+
+  // Rates of currencies, identified by their ISO 4217 numeric code, against a pivot currency, plus optional direct
+  // cross rates. Conversions without a direct rate are triangulated through the pivot.
+  class fx_table
+  {
+  public:
+    struct [[nodiscard]] MissingRate : public std::runtime_error
+    {
+      MissingRate(std::uint16_t source, std::uint16_t target)
+          : std::runtime_error("io1::fx_table: no rate from " + std::to_string(source) + " to " +
+                               std::to_string(target) + "."),
+            from(source), to(target)
+      {
+      }
+
+      std::uint16_t from;
+      std::uint16_t to;
+    };
+
+    explicit fx_table(std::uint16_t pivot) : pivot_(pivot)
+    {
+      static_cast<void>(minor_unit(pivot));
+      pivot_rates_.fill(missing);
+      pivot_rates_[pivot] = {.numerator = 1, .denominator = 1};
+    }
+
+    [[nodiscard]] std::uint16_t pivot() const noexcept { return pivot_; }
+
+    // One major unit of `currency` is worth `rate` major units of the pivot. Throws std::invalid_argument unless both
+    // terms of the rate are positive.
+    void set_rate(std::uint16_t currency, fx_rate rate)
+    {
+      static_cast<void>(minor_unit(currency));
+      if (currency == pivot_) { throw std::invalid_argument("io1::fx_table: the pivot rate is always 1."); }
+      pivot_rates_[currency] = checked(rate);
+    }
+
+    // Direct rate from one currency to another, used instead of triangulating through the pivot. Throws
+    // std::invalid_argument unless both terms of the rate are positive.
+    void set_rate(std::uint16_t from, std::uint16_t to, fx_rate rate)
+    {
+      static_cast<void>(minor_unit(from));
+      static_cast<void>(minor_unit(to));
+      cross_rates_[key(from, to)] = checked(rate);
+    }
+
+    // Major units rate from one currency to another.
+    [[nodiscard]] fx_rate rate(std::uint16_t from, std::uint16_t to) const
+    {
+      if (auto const result = find_rate(from, to)) { return *result; }
+      throw MissingRate(from, to);
+    }
+
+    // Factor turning minor units of one currency into minor units of another: the rate rescaled by the difference of
+    // their minor unit digits.
+    [[nodiscard]] fx_rate minor_unit_factor(std::uint16_t from, std::uint16_t to) const
+    {
+      return rescale(rate(from, to), from, to);
+    }
+
+    [[nodiscard]] money convert(money amount, std::uint16_t from, std::uint16_t to,
+                                rounding mode = rounding::half_even) const
+    {
+      auto const factor = minor_unit_factor(from, to);
+      return money{detail::muldiv(amount.data(), factor.numerator, factor.denominator, mode)};
+    }
+
+    // Convert rows of amounts in the currencies of the parallel column `currencies` to `to`, on `threads` workers (one
+    // per hardware thread if 0). Throws MissingRate, or std::overflow_error, for a row in a currency without rate or
+    // whose factor is out of range, after some rows may have been written.
+    void convert(std::span<money const> amounts, std::span<std::uint16_t const> currencies, std::uint16_t to,
+                 std::span<money> out, rounding mode = rounding::half_even, std::size_t threads = 0) const
+    {
+      assert(amounts.size() == currencies.size() && amounts.size() == out.size() &&
+             "Each amount must have a currency and a destination.");
+
+      static_cast<void>(minor_unit(to));
+
+      // one factor per currency, computed once: only the rows in a currency without rate, or whose factor is out of
+      // range, are an error
+      std::array<fx_rate, max_code + 1> factors;
+      factors.fill(missing);
+      for (auto const & info : io1::currencies())
+      {
+        try
+        {
+          if (auto const r = find_rate(info.numeric, to)) { factors[info.numeric] = rescale(*r, info.numeric, to); }
+        }
+        catch (std::overflow_error const &)
+        {
+          factors[info.numeric] = out_of_range;
+        }
+      }
+
+      constexpr std::size_t grain = std::size_t{1} << 16U;
+      auto const workers = detail::worker_count(amounts.size(), grain, threads);
+      detail::parallel_chunks(amounts.size(), workers,
+                              [&](std::size_t, std::size_t begin, std::size_t end)
+                              {
+                                auto const * const from = amounts.data();
+                                auto const * const ids = currencies.data();
+                                auto * const dest = out.data();
+                                for (auto i = begin; i < end; ++i)
+                                {
+                                  auto const id = ids[i];
+                                  auto const factor = id <= max_code ? factors[id] : missing;
+                                  if (missing == factor) { throw MissingRate(id, to); }
+                                  if (out_of_range == factor) { static_cast<void>(minor_unit_factor(id, to)); }
+                                  dest[i] = money{detail::muldiv(from[i].data(), factor.numerator,
+                                                                 factor.denominator, mode)};
+                                }
+                              });
+    }
+
+  private:
+    static constexpr std::uint16_t max_code = 999;
+    static constexpr fx_rate missing{.numerator = 0, .denominator = 0};
+    static constexpr fx_rate out_of_range{.numerator = 0, .denominator = -1}; // throws again when a row needs it
+
+    // Rates are inverted and multiplied: a term that is not positive would end up as a zero denominator.
+    [[nodiscard]] static fx_rate checked(fx_rate rate)
+    {
+      if (rate.numerator <= 0 || rate.denominator <= 0)
+      {
+        throw std::invalid_argument("io1::fx_table: rates must be positive.");
+      }
+      return detail::reduce(rate.numerator, rate.denominator);
+    }
+
+    [[nodiscard]] static unsigned minor_unit(std::uint16_t currency)
+    {
+      auto const * const info = find_currency(currency);
+      if (nullptr == info)
+      {
+        throw std::invalid_argument("io1::fx_table: unknown currency " + std::to_string(currency) + ".");
+      }
+      return info->minor_unit;
+    }
+
+    [[nodiscard]] std::optional<fx_rate> find_rate(std::uint16_t from, std::uint16_t to) const
+    {
+      if (from == to) { return fx_rate{.numerator = 1, .denominator = 1}; }
+      if (auto const it = cross_rates_.find(key(from, to)); it != cross_rates_.end()) { return it->second; }
+      if (auto const it = cross_rates_.find(key(to, from)); it != cross_rates_.end())
+      {
+        return detail::reduce(it->second.denominator, it->second.numerator);
+      }
+
+      if (from > max_code || to > max_code) { return std::nullopt; }
+      auto const & base = pivot_rates_[from];
+      auto const & quote = pivot_rates_[to];
+      if (missing == base || missing == quote) { return std::nullopt; }
+      // from -> pivot -> to
+      return detail::reduce(static_cast<detail::int128_t>(base.numerator) * quote.denominator,
+                            static_cast<detail::int128_t>(base.denominator) * quote.numerator);
+    }
+
+    [[nodiscard]] static fx_rate rescale(fx_rate r, std::uint16_t from, std::uint16_t to)
+    {
+      auto const from_digits = minor_unit(from);
+      auto const to_digits = minor_unit(to);
+      detail::int128_t numerator = r.numerator;
+      detail::int128_t denominator = r.denominator;
+      if (to_digits > from_digits) { numerator *= detail::power_of_ten(to_digits - from_digits); }
+      else { denominator *= detail::power_of_ten(from_digits - to_digits); }
+      return detail::reduce(numerator, denominator);
+    }
+
+    [[nodiscard]] static constexpr std::uint32_t key(std::uint16_t from, std::uint16_t to) noexcept
+    {
+      return static_cast<std::uint32_t>(from) << 16U | to;
+    }
+
+    std::uint16_t pivot_;
+    std::array<fx_rate, max_code + 1> pivot_rates_; // indexed by numeric code
+    std::unordered_map<std::uint32_t, fx_rate> cross_rates_;
+  };
+} // namespace io1
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "io1/detail/money_chars.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_punct_cache.hpp"
+
+#include <cstddef>
+#include <iomanip>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace io1
+{
+  template <class Int>
+  inline std::ostream & operator<<(std::ostream & stream, io1::basic_money<Int> val) noexcept
+  {
+    if constexpr (sizeof(Int) <= sizeof(long long)) { return stream << val.data(); }
+    else
+    {
+      char buffer[40]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      auto const * const end = detail::integer_to_chars(buffer, val.data());
+      return stream << std::string_view(buffer, static_cast<std::size_t>(end - buffer));
+    }
+  }
+
+  template <class Int>
+  inline std::istream & operator>>(std::istream & stream, io1::basic_money<Int> & val)
+  {
+    if constexpr (sizeof(Int) <= sizeof(long long))
+    {
+      Int amount; // NOLINT(cppcoreguidelines-init-variables) value is used once we have confirmation
+                  // that it has been initialized
+      stream >> amount;
+      if (stream) { val = io1::basic_money<Int>(amount); } // strong guarantee
+    }
+    else
+    {
+      std::istream::sentry const sentry(stream);
+      if (!sentry) { return stream; }
+
+      // an optional sign followed by digits, like the extraction of standard integers
+      std::string text;
+      auto * const buffer = stream.rdbuf();
+      auto c = buffer->sgetc();
+      if ('-' == c || '+' == c)
+      {
+        if ('-' == c) { text.push_back('-'); }
+        c = buffer->snextc();
+      }
+      while ('0' <= c && c <= '9')
+      {
+        text.push_back(static_cast<char>(c));
+        c = buffer->snextc();
+      }
+      if (std::char_traits<char>::eof() == c) { stream.setstate(std::ios_base::eofbit); }
+
+      Int amount = 0;
+      if (detail::integer_from_chars(text, amount)) { val = io1::basic_money<Int>(amount); } // strong guarantee
+      else { stream.setstate(std::ios_base::failbit); }
+    }
+    return stream;
+  }
+
+  namespace detail
+  {
+    template <class Int>
+    struct GetMoney
+    {
+      explicit GetMoney(basic_money<Int> & val, bool intl) noexcept : intl_(intl), amount_(val){};
+      GetMoney(GetMoney const &) = delete;
+      GetMoney(GetMoney &&) = delete;
+      GetMoney & operator=(GetMoney const &) = delete;
+      GetMoney & operator=(GetMoney &&) = delete;
+      ~GetMoney() noexcept = default;
+
+      friend inline std::istream & operator>>(std::istream & stream, GetMoney && obj)
+      {
+        std::string amount;
+        stream >> std::get_money(amount, obj.intl_);
+        if (!stream)
+        {
+          observer::on_get_money(false);
+          return stream;
+        }
+
+        Int parsed_amount = 0;
+        auto const parsed = integer_from_chars(amount, parsed_amount);
+        if (parsed) { obj.amount_ = basic_money<Int>{parsed_amount}; }
+        else { stream.setstate(std::ios_base::failbit); }
+        observer::on_get_money(parsed);
+
+        return stream;
+      }
+
+      bool intl_;
+      basic_money<Int> & amount_;
+    };
+
+    template <class Int>
+    struct PutMoney
+    {
+      explicit PutMoney(basic_money<Int> val, bool intl) noexcept : intl_(intl), amount_(val.data()) {}
+      PutMoney(PutMoney const &) = delete;
+      PutMoney(PutMoney &&) = delete;
+      PutMoney & operator=(PutMoney const &) = delete;
+      PutMoney & operator=(PutMoney &&) = delete;
+      ~PutMoney() noexcept = default;
+
+      friend inline std::ostream & operator<<(std::ostream & stream, PutMoney const & obj)
+      {
+        char digits[40]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        std::string_view const amount(digits, static_cast<std::size_t>(integer_to_chars(digits, obj.amount_) - digits));
+
+        auto const & plan = obj.intl_ ? moneypunct_cache<true>::lookup(stream.getloc())
+                                      : moneypunct_cache<false>::lookup(stream.getloc());
+        observer::on_put_money(!plan.standard_put);
+        if (!plan.standard_put) { return stream << std::put_money(std::string(amount), obj.intl_); }
+
+        std::ostream::sentry const sentry(stream);
+        if (!sentry) { return stream; }
+        money_put_layout const layout(plan, amount, stream.flags(), stream.width(), stream.fill());
+        stream.width(0);
+        with_money_put(layout,
+                       [&stream](std::string_view text)
+                       {
+                         auto const size = static_cast<std::streamsize>(text.size());
+                         if (size != stream.rdbuf()->sputn(text.data(), size))
+                         {
+                           stream.setstate(std::ios_base::badbit);
+                         }
+                       });
+        return stream;
+      }
+
+      bool intl_;
+      Int amount_;
+    };
+  } // namespace detail
+
+  template <class Int>
+  [[nodiscard]] inline detail::PutMoney<Int> put_money(io1::basic_money<Int> val, bool intl = false) noexcept
+  {
+    return detail::PutMoney<Int>(val, intl);
+  }
+
+  template <class Int>
+  [[nodiscard]] inline detail::GetMoney<Int> get_money(io1::basic_money<Int> & val, bool intl = false)
+  {
+    return detail::GetMoney<Int>(val, intl);
+  }
+} // namespace io1
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace io1
+{
+  struct currency_info
+  {
+    std::string_view code;   // ISO 4217 alphabetic code
+    std::uint16_t numeric;   // ISO 4217 numeric code
+    std::uint8_t minor_unit; // number of decimal digits of the minor unit
+    std::string_view symbol; // UTF-8 local symbol, the code when there is none
+  };
+
+  namespace detail
+  {
+    // Active ISO 4217 currencies, sorted by code. Precious metals, bond market units and funds are left out, except the
+    // Chilean and Uruguayan units of account CLF and UYI, in which contracts are priced. Withdrawn currencies are left
+    // out too, such as ANG and ZWL, replaced by XCG and ZWG.
+    inline constexpr currency_info iso_4217[] = {
+        {"AED", 784, 2, "AED"}, {"AFN", 971, 2, "\xD8\x8B"}, {"ALL", 8, 2, "L"}, {"AMD", 51, 2, "\xD6\x8F"},
+        {"AOA", 973, 2, "AOA"}, {"ARS", 32, 2, "$"}, {"AUD", 36, 2, "$"}, {"AWG", 533, 2, "\xC6\x92"},
+        {"AZN", 944, 2, "\xE2\x82\xBC"}, {"BAM", 977, 2, "KM"}, {"BBD", 52, 2, "$"}, {"BDT", 50, 2, "\xE0\xA7\xB3"},
+        {"BGN", 975, 2, "\xD0\xBB\xD0\xB2"}, {"BHD", 48, 3, "BHD"}, {"BIF", 108, 0, "BIF"}, {"BMD", 60, 2, "$"},
+        {"BND", 96, 2, "$"}, {"BOB", 68, 2, "Bs"}, {"BRL", 986, 2, "R$"}, {"BSD", 44, 2, "$"}, {"BTN", 64, 2, "BTN"},
+        {"BWP", 72, 2, "P"}, {"BYN", 933, 2, "BYN"}, {"BZD", 84, 2, "$"}, {"CAD", 124, 2, "$"}, {"CDF", 976, 2, "CDF"},
+        {"CHF", 756, 2, "CHF"}, {"CLF", 990, 4, "CLF"}, {"CLP", 152, 0, "$"}, {"CNY", 156, 2, "\xC2\xA5"},
+        {"COP", 170, 2, "$"}, {"CRC", 188, 2, "\xE2\x82\xA1"}, {"CUP", 192, 2, "$"}, {"CVE", 132, 2, "CVE"},
+        {"CZK", 203, 2, "K\xC4\x8D"}, {"DJF", 262, 0, "DJF"}, {"DKK", 208, 2, "kr"}, {"DOP", 214, 2, "$"},
+        {"DZD", 12, 2, "DZD"}, {"EGP", 818, 2, "\xC2\xA3"}, {"ERN", 232, 2, "ERN"}, {"ETB", 230, 2, "ETB"},
+        {"EUR", 978, 2, "\xE2\x82\xAC"}, {"FJD", 242, 2, "$"}, {"FKP", 238, 2, "\xC2\xA3"}, {"GBP", 826, 2, "\xC2\xA3"},
+        {"GEL", 981, 2, "\xE2\x82\xBE"}, {"GHS", 936, 2, "\xE2\x82\xB5"}, {"GIP", 292, 2, "\xC2\xA3"},
+        {"GMD", 270, 2, "GMD"}, {"GNF", 324, 0, "GNF"}, {"GTQ", 320, 2, "Q"}, {"GYD", 328, 2, "$"},
+        {"HKD", 344, 2, "$"}, {"HNL", 340, 2, "L"}, {"HTG", 332, 2, "HTG"}, {"HUF", 348, 2, "Ft"},
+        {"IDR", 360, 2, "Rp"}, {"ILS", 376, 2, "\xE2\x82\xAA"}, {"INR", 356, 2, "\xE2\x82\xB9"}, {"IQD", 368, 3, "IQD"},
+        {"IRR", 364, 2, "\xEF\xB7\xBC"}, {"ISK", 352, 0, "kr"}, {"JMD", 388, 2, "$"}, {"JOD", 400, 3, "JOD"},
+        {"JPY", 392, 0, "\xC2\xA5"}, {"KES", 404, 2, "KSh"}, {"KGS", 417, 2, "\xD1\x81\xD0\xBE\xD0\xBC"},
+        {"KHR", 116, 2, "\xE1\x9F\x9B"}, {"KMF", 174, 0, "KMF"}, {"KPW", 408, 2, "\xE2\x82\xA9"},
+        {"KRW", 410, 0, "\xE2\x82\xA9"}, {"KWD", 414, 3, "KWD"}, {"KYD", 136, 2, "$"}, {"KZT", 398, 2, "\xE2\x82\xB8"},
+        {"LAK", 418, 2, "\xE2\x82\xAD"}, {"LBP", 422, 2, "\xC2\xA3"}, {"LKR", 144, 2, "Rs"}, {"LRD", 430, 2, "$"},
+        {"LSL", 426, 2, "LSL"}, {"LYD", 434, 3, "LYD"}, {"MAD", 504, 2, "MAD"}, {"MDL", 498, 2, "L"},
+        {"MGA", 969, 2, "MGA"}, {"MKD", 807, 2, "\xD0\xB4\xD0\xB5\xD0\xBD"}, {"MMK", 104, 2, "K"},
+        {"MNT", 496, 2, "\xE2\x82\xAE"}, {"MOP", 446, 2, "MOP"}, {"MRU", 929, 2, "MRU"}, {"MUR", 480, 2, "Rs"},
+        {"MVR", 462, 2, "MVR"}, {"MWK", 454, 2, "MK"}, {"MXN", 484, 2, "$"}, {"MYR", 458, 2, "RM"},
+        {"MZN", 943, 2, "MZN"}, {"NAD", 516, 2, "$"}, {"NGN", 566, 2, "\xE2\x82\xA6"}, {"NIO", 558, 2, "C$"},
+        {"NOK", 578, 2, "kr"}, {"NPR", 524, 2, "Rs"}, {"NZD", 554, 2, "$"}, {"OMR", 512, 3, "\xEF\xB7\xBC"},
+        {"PAB", 590, 2, "B/."}, {"PEN", 604, 2, "S/"}, {"PGK", 598, 2, "K"}, {"PHP", 608, 2, "\xE2\x82\xB1"},
+        {"PKR", 586, 2, "Rs"}, {"PLN", 985, 2, "z\xC5\x82"}, {"PYG", 600, 0, "\xE2\x82\xB2"},
+        {"QAR", 634, 2, "\xEF\xB7\xBC"}, {"RON", 946, 2, "lei"}, {"RSD", 941, 2, "\xD0\xB4\xD0\xB8\xD0\xBD"},
+        {"RUB", 643, 2, "\xE2\x82\xBD"}, {"RWF", 646, 0, "RWF"}, {"SAR", 682, 2, "\xEF\xB7\xBC"}, {"SBD", 90, 2, "$"},
+        {"SCR", 690, 2, "Rs"}, {"SDG", 938, 2, "SDG"}, {"SEK", 752, 2, "kr"}, {"SGD", 702, 2, "$"},
+        {"SHP", 654, 2, "\xC2\xA3"}, {"SLE", 925, 2, "SLE"}, {"SOS", 706, 2, "SOS"}, {"SRD", 968, 2, "$"},
+        {"SSP", 728, 2, "\xC2\xA3"}, {"STN", 930, 2, "STN"}, {"SVC", 222, 2, "SVC"}, {"SYP", 760, 2, "\xC2\xA3"},
+        {"SZL", 748, 2, "SZL"}, {"THB", 764, 2, "\xE0\xB8\xBF"}, {"TJS", 972, 2, "SM"}, {"TMT", 934, 2, "TMT"},
+        {"TND", 788, 3, "TND"}, {"TOP", 776, 2, "T$"}, {"TRY", 949, 2, "\xE2\x82\xBA"}, {"TTD", 780, 2, "$"},
+        {"TWD", 901, 2, "$"}, {"TZS", 834, 2, "TSh"}, {"UAH", 980, 2, "\xE2\x82\xB4"}, {"UGX", 800, 0, "USh"},
+        {"USD", 840, 2, "$"}, {"UYI", 940, 0, "UYI"}, {"UYU", 858, 2, "$"}, {"UYW", 927, 4, "UYW"},
+        {"UZS", 860, 2, "so\xCA\xBBm"}, {"VED", 926, 2, "Bs.D"}, {"VES", 928, 2, "Bs"}, {"VND", 704, 0, "\xE2\x82\xAB"},
+        {"VUV", 548, 0, "VUV"}, {"WST", 882, 2, "WS$"}, {"XAF", 950, 0, "FCFA"}, {"XCD", 951, 2, "$"},
+        {"XCG", 532, 2, "Cg"}, {"XOF", 952, 0, "FCFA"}, {"XPF", 953, 0, "CFPF"}, {"YER", 886, 2, "\xEF\xB7\xBC"},
+        {"ZAR", 710, 2, "R"}, {"ZMW", 967, 2, "K"}, {"ZWG", 924, 2, "ZiG"},
+    };
+  } // namespace detail
+
+  [[nodiscard]] constexpr std::span<currency_info const> currencies() noexcept { return detail::iso_4217; }
+
+  // ISO 4217 entry of an alphabetic code, nullptr if unknown.
+  [[nodiscard]] constexpr currency_info const * find_currency(std::string_view code) noexcept
+  {
+    auto const it = std::ranges::lower_bound(detail::iso_4217, code, {}, &currency_info::code);
+    return it != std::ranges::end(detail::iso_4217) && it->code == code ? it : nullptr;
+  }
+
+  // ISO 4217 entry of a numeric code, nullptr if unknown.
+  [[nodiscard]] constexpr currency_info const * find_currency(std::uint16_t numeric) noexcept
+  {
+    auto const it = std::ranges::find(detail::iso_4217, numeric, &currency_info::numeric);
+    return it != std::ranges::end(detail::iso_4217) ? it : nullptr;
+  }
+
+  static_assert(std::ranges::is_sorted(detail::iso_4217, {}, &currency_info::code),
+                "find_currency relies on a binary search.");
+} // namespace io1
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace io1
+{
+  namespace detail
+  {
+    // CRC-32 (IEEE 802.3) lookup table for the reflected polynomial 0xEDB88320.
+    inline constexpr auto crc32_table = []()
+    {
+      std::array<std::uint32_t, 256> table{};
+      for (std::uint32_t i = 0; i < table.size(); ++i)
+      {
+        auto crc = i;
+        for (int bit = 0; bit < 8; ++bit) { crc = (crc & 1U) ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U; }
+        table[i] = crc;
+      }
+      return table;
+    }();
+
+    [[nodiscard]] constexpr std::uint32_t crc32(std::span<std::byte const> data, std::uint32_t crc = 0) noexcept
+    {
+      crc = ~crc;
+      for (auto const byte : data)
+      {
+        crc = crc32_table[(crc ^ static_cast<std::uint32_t>(byte)) & 0xFFU] ^ (crc >> 8U);
+      }
+      return ~crc;
+    }
+
+    // Minimal RAII wrapper over a native file descriptor: only the handful of calls the journal needs.
+    class journal_file
+    {
+    public:
+      explicit journal_file(std::filesystem::path const & path)
+      {
+#ifdef _WIN32
+        fd_ = ::_wopen(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644); // NOLINT(cppcoreguidelines-pro-type-vararg)
+#endif
+        if (fd_ < 0) { fail("open"); }
+      }
+
+      journal_file(journal_file const &) = delete;
+      journal_file(journal_file && o) noexcept : fd_(std::exchange(o.fd_, -1)) {}
+      journal_file & operator=(journal_file const &) = delete;
+      journal_file & operator=(journal_file &&) = delete;
+
+      ~journal_file() noexcept
+      {
+        if (fd_ < 0) { return; }
+#ifdef _WIN32
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+      }
+
+      [[nodiscard]] std::uint64_t seek(std::uint64_t offset) const
+      {
+#ifdef _WIN32
+        auto const pos = ::_lseeki64(fd_, static_cast<__int64>(offset), SEEK_SET);
+#else
+        auto const pos = ::lseek(fd_, static_cast<off_t>(offset), SEEK_SET);
+#endif
+        if (pos < 0) { fail("seek"); }
+        return static_cast<std::uint64_t>(pos);
+      }
+
+      [[nodiscard]] std::uint64_t size() const
+      {
+#ifdef _WIN32
+        auto const end = ::_lseeki64(fd_, 0, SEEK_END);
+#else
+        auto const end = ::lseek(fd_, 0, SEEK_END);
+#endif
+        if (end < 0) { fail("seek"); }
+        return static_cast<std::uint64_t>(end);
+      }
+
+      // Read up to buffer.size() bytes, fewer only at end of file.
+      [[nodiscard]] std::size_t read(std::span<std::byte> buffer) const
+      {
+        std::size_t done = 0;
+        while (done < buffer.size())
+        {
+          auto const chunk = std::min<std::size_t>(buffer.size() - done, max_io);
+#ifdef _WIN32
+          auto const n = ::_read(fd_, buffer.data() + done, static_cast<unsigned int>(chunk));
+#else
+          auto const n = ::read(fd_, buffer.data() + done, chunk);
+#endif
+          if (n < 0)
+          {
+            if (errno == EINTR) { continue; }
+            fail("read");
+          }
+          if (0 == n) { break; }
+          done += static_cast<std::size_t>(n);
+        }
+        return done;
+      }
+
+      void write(std::span<std::byte const> buffer) const
+      {
+        while (!buffer.empty())
+        {
+          auto const chunk = std::min<std::size_t>(buffer.size(), max_io);
+#ifdef _WIN32
+          auto const n = ::_write(fd_, buffer.data(), static_cast<unsigned int>(chunk));
+#else
+          auto const n = ::write(fd_, buffer.data(), chunk);
+#endif
+          if (n < 0)
+          {
+            if (errno == EINTR) { continue; }
+            fail("write");
+          }
+          buffer = buffer.subspan(static_cast<std::size_t>(n));
+        }
+      }
+
+      void sync() const
+      {
+#ifdef _WIN32
+        if (0 != ::_commit(fd_)) { fail("sync"); }
+#else
+        if (0 != ::fsync(fd_)) { fail("sync"); }
+#endif
+      }
+
+      void truncate(std::uint64_t size) const
+      {
+#ifdef _WIN32
+        if (0 != ::_chsize_s(fd_, static_cast<__int64>(size))) { fail("truncate"); }
+#else
+        if (0 != ::ftruncate(fd_, static_cast<off_t>(size))) { fail("truncate"); }
+#endif
+      }
+
+    private:
+      static constexpr std::size_t max_io = std::size_t{1} << 30U;
+
+      [[noreturn]] static void fail(char const * what)
+      {
+        throw std::system_error(errno, std::generic_category(), std::string("io1::journal: ") + what);
+      }
+
+      int fd_{-1};
+    };
+  } // namespace detail
+
+  enum class fsync_policy
+  {
+    always,   // every group commit is flushed to stable storage before commit() returns
+    periodic, // one group commit out of journal_options::sync_interval is flushed
+    never     // durability is left to the operating system
+  };
+
+  struct journal_options
+  {
+    fsync_policy policy{fsync_policy::always};
+    std::size_t sync_interval{1};
+    std::size_t max_pending{4096}; // records buffered before append() writes a batch on its own
+  };
+
+  struct journal_recovery
+  {
+    std::uint64_t records;
+    std::uint64_t truncated_bytes;
+  };
+
+  template <class Record>
+  class journal
+  {
+    static_assert(std::is_trivially_copyable_v<Record> && std::is_standard_layout_v<Record>,
+                  "Journal records are persisted as raw bytes.");
+
+  public:
+    using record_type = Record;
+    using sequence_type = std::uint64_t;
+
+    static constexpr std::uint32_t magic = 0x4A31'4F49; // "IO1J" once stored little endian
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::size_t header_size = 16;
+    static constexpr std::size_t frame_size = sizeof(std::uint32_t) + sizeof(Record);
+
+    struct [[nodiscard]] BadHeader : public std::runtime_error
+    {
+      BadHeader() : std::runtime_error("Not a journal file for this record type!") {}
+    };
+
+    explicit journal(std::filesystem::path const & path, journal_options options = {})
+        : file_(path), options_(options)
+    {
+      recovery_ = scan(file_, [](Record const &) noexcept {});
+      appended_ = durable_ = recovery_.records;
+    }
+
+    journal(journal const &) = delete;
+    journal(journal &&) = delete;
+    journal & operator=(journal const &) = delete;
+    journal & operator=(journal &&) = delete;
+
+    // Pending records are written but not forcibly synced: call commit() to make them durable.
+    ~journal() noexcept
+    {
+      try
+      {
+        std::unique_lock lock(mutex_);
+        if (!failure_ && !pending_.empty()) { file_.write(pending_); }
+      }
+      catch (...) // NOLINT(bugprone-empty-catch) nothing sensible to do in a destructor
+      {
+      }
+    }
+
+    // Replay the valid records of a journal and truncate any torn or corrupted tail. A missing file is created empty.
+    template <class Visitor>
+    static journal_recovery recover(std::filesystem::path const & path, Visitor && visit)
+    {
+      detail::journal_file file(path);
+      return scan(file, std::forward<Visitor>(visit));
+    }
+
+    [[nodiscard]] journal_recovery const & recovery() const noexcept { return recovery_; }
+
+    [[nodiscard]] sequence_type size() const
+    {
+      std::lock_guard const lock(mutex_);
+      return appended_;
+    }
+
+    // Buffer a record and return its sequence number. The record is durable once commit(sequence) returns.
+    sequence_type append(Record const & record)
+    {
+      std::unique_lock lock(mutex_);
+      rethrow_failure();
+
+      auto const offset = pending_.size();
+      pending_.resize(offset + frame_size);
+      auto * const frame = pending_.data() + offset;
+      std::memcpy(frame + sizeof(std::uint32_t), &record, sizeof(Record));
+      auto const crc = detail::crc32({frame + sizeof(std::uint32_t), sizeof(Record)});
+      std::memcpy(frame, &crc, sizeof(crc));
+
+      auto const sequence = appended_++;
+      if (pending_.size() >= options_.max_pending * frame_size && !flushing_) { flush(lock); }
+      return sequence;
+    }
+
+    // Block until record `sequence` has been written (and synced according to the policy). Concurrent callers are
+    // served by a single write + fsync: whoever finds no flush in progress becomes the leader for everything pending.
+    void commit(sequence_type sequence)
+    {
+      std::unique_lock lock(mutex_);
+      while (durable_ <= sequence)
+      {
+        rethrow_failure();
+        if (sequence >= appended_) { throw std::out_of_range("io1::journal: committing a record never appended."); }
+        if (flushing_) { flushed_.wait(lock); }
+        else { flush(lock); }
+      }
+      rethrow_failure();
+    }
+
+    void commit()
+    {
+      if (auto const appended = size(); 0 != appended) { commit(appended - 1); }
+    }
+
+    // Force everything written so far to stable storage regardless of the policy.
+    void sync()
+    {
+      commit();
+      std::lock_guard const lock(mutex_);
+      file_.sync();
+    }
+
+  private:
+    template <class Visitor>
+    static journal_recovery scan(detail::journal_file & file, Visitor && visit)
+    {
+      auto const file_size = file.size();
+      std::array<std::byte, header_size> header{};
+      std::array<std::uint32_t, 4> const expected{magic, version, static_cast<std::uint32_t>(sizeof(Record)), 0};
+
+      if (file_size < header_size)
+      {
+        // empty or torn while being created, unless the bytes written are not those of a header
+        auto const existing = static_cast<std::size_t>(file_size);
+        static_cast<void>(file.seek(0));
+        if (existing != file.read(std::span(header).first(existing)) ||
+            0 != std::memcmp(header.data(), expected.data(), existing))
+        {
+          throw BadHeader{};
+        }
+        std::memcpy(header.data(), expected.data(), header_size);
+        file.truncate(0);
+        static_cast<void>(file.seek(0));
+        file.write(header);
+        file.sync();
+        return {.records = 0, .truncated_bytes = file_size};
+      }
+
+      static_cast<void>(file.seek(0));
+      if (header_size != file.read(header) || 0 != std::memcmp(header.data(), expected.data(), header_size))
+      {
+        throw BadHeader{};
+      }
+
+      constexpr std::size_t frames_per_chunk = 4096;
+      std::vector<std::byte> chunk(frames_per_chunk * frame_size);
+      Record record; // NOLINT(cppcoreguidelines-pro-type-member-init) filled by memcpy before use
+      std::uint64_t records = 0;
+      bool torn = false;
+
+      while (!torn)
+      {
+        auto const read = file.read(chunk);
+        auto const frames = read / frame_size;
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+          auto const * const frame = chunk.data() + i * frame_size;
+          std::uint32_t crc; // NOLINT(cppcoreguidelines-init-variables) filled by memcpy
+          std::memcpy(&crc, frame, sizeof(crc));
+          if (crc != detail::crc32({frame + sizeof(std::uint32_t), sizeof(Record)}))
+          {
+            torn = true;
+            break;
+          }
+          std::memcpy(&record, frame + sizeof(std::uint32_t), sizeof(Record));
+          visit(static_cast<Record const &>(record));
+          ++records;
+        }
+        if (read < chunk.size()) { break; }
+      }
+
+      auto const valid_size = header_size + records * frame_size;
+      if (valid_size != file_size)
+      {
+        file.truncate(valid_size);
+        file.sync();
+      }
+      static_cast<void>(file.seek(valid_size));
+
+      return {.records = records, .truncated_bytes = file_size - valid_size};
+    }
+
+    // Called with the lock held; releases it around the actual I/O so that appends keep flowing into pending_.
+    void flush(std::unique_lock<std::mutex> & lock)
+    {
+      flushing_ = true;
+      batch_.swap(pending_);
+      pending_.clear();
+      auto const upto = appended_;
+      bool const sync = must_sync();
+
+      lock.unlock();
+      std::exception_ptr error;
+      try
+      {
+        file_.write(batch_);
+        if (sync) { file_.sync(); }
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      if (error) { failure_ = error; }
+      else { durable_ = upto; }
+      flushing_ = false;
+      flushed_.notify_all();
+    }
+
+    [[nodiscard]] bool must_sync() noexcept
+    {
+      switch (options_.policy)
+      {
+      case fsync_policy::always: return true;
+      case fsync_policy::periodic:
+        if (++commits_since_sync_ < options_.sync_interval) { return false; }
+        commits_since_sync_ = 0;
+        return true;
+      case fsync_policy::never: return false;
+      }
+      return true;
+    }
+
+    void rethrow_failure() const
+    {
+      if (failure_) { std::rethrow_exception(failure_); }
+    }
+
+    detail::journal_file file_;
+    journal_options options_;
+    journal_recovery recovery_{};
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_;
+    std::vector<std::byte> pending_;
+    std::vector<std::byte> batch_;
+    sequence_type appended_{0};
+    sequence_type durable_{0};
+    std::size_t commits_since_sync_{0};
+    bool flushing_{false};
+    std::exception_ptr failure_;
+  };
+} // namespace io1
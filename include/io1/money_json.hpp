@@ -0,0 +1,526 @@
+#pragma once
+
+#include "io1/detail/money_chars.hpp"
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io1
+{
+  // Writer of JSON text where amounts are exact decimal numbers with a fixed number of fractional digits: 1234 minor
+  // units are written 12.34 with 2 digits. Text is appended to a string, without allocating anything else; commas are
+  // inserted as needed, and the calls must otherwise form valid JSON.
+  class json_writer
+  {
+  public:
+    explicit json_writer(std::string & out, unsigned digits = 2) noexcept : out_(out), digits_(digits)
+    {
+      assert(digits <= 18 && "Amounts have 18 fractional digits at most.");
+    }
+
+    json_writer & begin_object() { return open('{'); }
+    json_writer & end_object() { return close('}'); }
+    json_writer & begin_array() { return open('['); }
+    json_writer & end_array() { return close(']'); }
+
+    json_writer & key(std::string_view name)
+    {
+      assert(0 < depth_ && "Keys are written in objects.");
+      separate();
+      write_string(name);
+      out_.push_back(':');
+      comma_ = false;
+      return *this;
+    }
+
+    json_writer & amount(money value)
+    {
+      separate();
+      write_amount(value);
+      return *this;
+    }
+
+    // An array of amounts.
+    json_writer & amounts(std::span<money const> values)
+    {
+      separate();
+      out_.push_back('[');
+      for (std::size_t i = 0; i < values.size(); ++i)
+      {
+        if (0 != i) { out_.push_back(','); }
+        write_amount(values[i]);
+      }
+      out_.push_back(']');
+      return *this;
+    }
+
+    json_writer & string(std::string_view value)
+    {
+      separate();
+      write_string(value);
+      return *this;
+    }
+
+    json_writer & boolean(bool value)
+    {
+      separate();
+      out_.append(value ? "true" : "false");
+      return *this;
+    }
+
+    json_writer & null()
+    {
+      separate();
+      out_.append("null");
+      return *this;
+    }
+
+  private:
+    void separate()
+    {
+      if (comma_) { out_.push_back(','); }
+      comma_ = true;
+    }
+
+    json_writer & open(char bracket)
+    {
+      separate();
+      out_.push_back(bracket);
+      comma_ = false;
+      ++depth_;
+      return *this;
+    }
+
+    json_writer & close(char bracket)
+    {
+      assert(0 < depth_ && "Every closing bracket has an opening one.");
+      out_.push_back(bracket);
+      comma_ = true;
+      --depth_;
+      return *this;
+    }
+
+    void write_amount(money value)
+    {
+      char buffer[24]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      auto const end = detail::to_decimal_chars(buffer, buffer + sizeof(buffer), value.data(), digits_).ptr;
+      out_.append(buffer, end);
+    }
+
+    // UTF-8 is written as is: only quotes, backslashes and control characters are escaped.
+    void write_string(std::string_view value)
+    {
+      constexpr std::string_view hex = "0123456789abcdef";
+      out_.push_back('"');
+      auto const * run = value.data();
+      for (auto const * p = value.data(); p != value.data() + value.size(); ++p)
+      {
+        auto const c = static_cast<unsigned char>(*p);
+        if ('"' != c && '\\' != c && 0x20 <= c) { continue; }
+        out_.append(run, p);
+        run = p + 1;
+        switch (c)
+        {
+        case '"': out_.append("\\\""); break;
+        case '\\': out_.append("\\\\"); break;
+        case '\n': out_.append("\\n"); break;
+        case '\r': out_.append("\\r"); break;
+        case '\t': out_.append("\\t"); break;
+        default:
+          out_.append("\\u00");
+          out_.push_back(hex[c >> 4U]);
+          out_.push_back(hex[c & 0xFU]);
+          break;
+        }
+      }
+      out_.append(run, value.data() + value.size());
+      out_.push_back('"');
+    }
+
+    std::string & out_;
+    unsigned digits_;
+    std::size_t depth_{0};
+    bool comma_{false};
+  };
+
+  // Events of io1::parse_json.
+  template <class T>
+  concept json_handler = requires(T & handler, std::string_view text, money amount, bool flag) {
+    handler.on_object_begin();
+    handler.on_object_end();
+    handler.on_array_begin();
+    handler.on_array_end();
+    handler.on_key(text);
+    handler.on_amount(amount);
+    handler.on_string(text);
+    handler.on_bool(flag);
+    handler.on_null();
+  };
+
+  namespace detail
+  {
+    // Nesting deeper than this is rejected rather than tracked on the heap.
+    inline constexpr std::size_t max_json_depth = 256;
+
+    [[nodiscard]] constexpr bool is_json_space(char c) noexcept
+    {
+      return ' ' == c || '\n' == c || '\r' == c || '\t' == c;
+    }
+
+    [[nodiscard]] constexpr bool is_digit(char c) noexcept { return '0' <= c && c <= '9'; }
+
+    template <json_handler Handler>
+    class json_parser
+    {
+    public:
+      json_parser(std::string_view text, Handler & handler, unsigned digits) noexcept
+          : first_(text.data()), p_(text.data()), end_(text.data() + text.size()), handler_(handler), digits_(digits)
+      {
+      }
+
+      void parse()
+      {
+        std::array<bool, max_json_depth> in_object{}; // NOLINT(cppcoreguidelines-pro-type-member-init)
+        std::size_t depth = 0;
+
+        // each iteration reads a value, then the brackets closed and the separator after it
+        while (true)
+        {
+          skip_space();
+          if (p_ == end_) { fail("unexpected end"); }
+          switch (*p_)
+          {
+          case '{':
+          case '[':
+          {
+            if (max_json_depth == depth) { fail("too deep nesting"); }
+            auto const object = '{' == *p_++;
+            in_object[depth++] = object;
+            object ? handler_.on_object_begin() : handler_.on_array_begin();
+            skip_space();
+            if (p_ != end_ && (object ? '}' : ']') == *p_) { break; }
+            if (object) { read_key(); }
+            continue;
+          }
+          case '"': handler_.on_string(read_string()); break;
+          case 't': read_literal("true"), handler_.on_bool(true); break;
+          case 'f': read_literal("false"), handler_.on_bool(false); break;
+          case 'n': read_literal("null"), handler_.on_null(); break;
+          default: handler_.on_amount(read_amount()); break;
+          }
+
+          // close what ends here, then go on with the next value
+          while (true)
+          {
+            if (0 == depth)
+            {
+              skip_space();
+              if (p_ != end_) { fail("unexpected character"); }
+              return;
+            }
+            skip_space();
+            if (p_ == end_) { fail("unexpected end"); }
+            auto const object = in_object[depth - 1];
+            if ((object ? '}' : ']') == *p_)
+            {
+              ++p_;
+              --depth;
+              object ? handler_.on_object_end() : handler_.on_array_end();
+              continue;
+            }
+            if (',' != *p_) { fail("expected a comma"); }
+            ++p_;
+            if (object) { read_key(); }
+            break;
+          }
+        }
+      }
+
+    private:
+      [[noreturn]] void fail(char const * what) const
+      {
+        throw std::invalid_argument("io1::parse_json: " + std::string(what) + " at offset " +
+                                    std::to_string(p_ - first_) + ".");
+      }
+
+      void skip_space() noexcept
+      {
+        while (p_ != end_ && is_json_space(*p_)) { ++p_; }
+      }
+
+      void read_key()
+      {
+        skip_space();
+        if (p_ == end_ || '"' != *p_) { fail("expected a key"); }
+        handler_.on_key(read_string());
+        skip_space();
+        if (p_ == end_ || ':' != *p_) { fail("expected a colon"); }
+        ++p_;
+      }
+
+      void read_literal(std::string_view literal)
+      {
+        if (static_cast<std::size_t>(end_ - p_) < literal.size() || std::string_view(p_, literal.size()) != literal)
+        {
+          fail("invalid literal");
+        }
+        p_ += literal.size();
+      }
+
+      // Strings without escapes are views of the text, the others of a buffer reused from one string to the next.
+      std::string_view read_string()
+      {
+        auto const * const first = ++p_;
+        while (p_ != end_ && '"' != *p_ && '\\' != *p_ && 0x20 <= static_cast<unsigned char>(*p_)) { ++p_; }
+        if (p_ == end_) { fail("unterminated string"); }
+        if ('"' == *p_) { return {first, static_cast<std::size_t>(p_++ - first)}; }
+
+        unescaped_.assign(first, p_);
+        while (true)
+        {
+          if (p_ == end_) { fail("unterminated string"); }
+          auto const c = *p_;
+          if ('"' == c) { break; }
+          if (0x20 > static_cast<unsigned char>(c)) { fail("control character in string"); }
+          ++p_;
+          if ('\\' != c)
+          {
+            unescaped_.push_back(c);
+            continue;
+          }
+          if (p_ == end_) { fail("unterminated string"); }
+          switch (*p_++)
+          {
+          case '"': unescaped_.push_back('"'); break;
+          case '\\': unescaped_.push_back('\\'); break;
+          case '/': unescaped_.push_back('/'); break;
+          case 'b': unescaped_.push_back('\b'); break;
+          case 'f': unescaped_.push_back('\f'); break;
+          case 'n': unescaped_.push_back('\n'); break;
+          case 'r': unescaped_.push_back('\r'); break;
+          case 't': unescaped_.push_back('\t'); break;
+          case 'u': append_code_point(); break;
+          default: --p_, fail("invalid escape");
+          }
+        }
+        ++p_;
+        return unescaped_;
+      }
+
+      std::uint32_t read_hex4()
+      {
+        if (end_ - p_ < 4) { fail("invalid escape"); }
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i, ++p_)
+        {
+          auto const c = *p_;
+          auto const digit = is_digit(c)                ? c - '0'
+                             : 'a' <= (c | 0x20) && (c | 0x20) <= 'f' ? (c | 0x20) - 'a' + 10
+                                                                       : -1;
+          if (digit < 0) { fail("invalid escape"); }
+          value = value << 4U | static_cast<std::uint32_t>(digit);
+        }
+        return value;
+      }
+
+      void append_code_point()
+      {
+        auto code = read_hex4();
+        if (0xD800 <= code && code < 0xDC00)
+        {
+          if (end_ - p_ < 2 || '\\' != p_[0] || 'u' != p_[1]) { fail("unpaired surrogate"); }
+          p_ += 2;
+          auto const low = read_hex4();
+          if (low < 0xDC00 || 0xE000 <= low) { fail("unpaired surrogate"); }
+          code = 0x10000 + ((code - 0xD800) << 10U) + (low - 0xDC00);
+        }
+        else if (0xDC00 <= code && code < 0xE000) { fail("unpaired surrogate"); }
+
+        auto const put = [this](std::uint32_t byte) { unescaped_.push_back(static_cast<char>(byte)); };
+        if (code < 0x80) { put(code); }
+        else if (code < 0x800)
+        {
+          put(0xC0 | code >> 6U);
+          put(0x80 | (code & 0x3FU));
+        }
+        else if (code < 0x10000)
+        {
+          put(0xE0 | code >> 12U);
+          put(0x80 | (code >> 6U & 0x3FU));
+          put(0x80 | (code & 0x3FU));
+        }
+        else
+        {
+          put(0xF0 | code >> 18U);
+          put(0x80 | (code >> 12U & 0x3FU));
+          put(0x80 | (code >> 6U & 0x3FU));
+          put(0x80 | (code & 0x3FU));
+        }
+      }
+
+      // A JSON number, exactly representable with digits_ fractional digits: 1.5e1 is 1500 minor units with 2 digits,
+      // and 0.125 is rejected.
+      money read_amount()
+      {
+        auto const * const number = p_;
+        auto const negative = '-' == *p_;
+        if (negative) { ++p_; }
+        if (p_ == end_ || !is_digit(*p_)) { fail("unexpected character"); }
+
+        // significant digits, then the digits too many for 64 bits, counted as zeros
+        std::uint64_t magnitude = 0;
+        int scale = 0;
+        int lost = 0;
+        int lowest_lost = 0; // rank among the lost digits of the last non-zero one, 0 if none
+        auto const accumulate = [&](char c) noexcept
+        {
+          auto const digit = static_cast<std::uint64_t>(c - '0');
+          if (0 == lost && magnitude <= (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+          {
+            magnitude = magnitude * 10 + digit;
+            return;
+          }
+          ++scale;
+          ++lost;
+          if (0 != digit) { lowest_lost = lost; }
+        };
+
+        if ('0' == *p_) { ++p_; }
+        else
+        {
+          while (p_ != end_ && is_digit(*p_)) { accumulate(*p_++); }
+        }
+        if (p_ != end_ && '.' == *p_)
+        {
+          ++p_;
+          if (p_ == end_ || !is_digit(*p_)) { fail("invalid number"); }
+          for (; p_ != end_ && is_digit(*p_); ++p_)
+          {
+            accumulate(*p_);
+            --scale;
+          }
+        }
+        if (p_ != end_ && ('e' == *p_ || 'E' == *p_))
+        {
+          ++p_;
+          auto const negative_exponent = p_ != end_ && '-' == *p_;
+          if (p_ != end_ && ('-' == *p_ || '+' == *p_)) { ++p_; }
+          if (p_ == end_ || !is_digit(*p_)) { fail("invalid number"); }
+          int exponent = 0;
+          for (; p_ != end_ && is_digit(*p_); ++p_) { exponent = std::min(exponent * 10 + (*p_ - '0'), 100'000); }
+          scale += negative_exponent ? -exponent : exponent;
+        }
+
+        auto const out_of_range = [this, number]
+        {
+          throw std::overflow_error("io1::parse_json: amount at offset " + std::to_string(number - first_) +
+                                    " out of range.");
+        };
+        auto const too_precise = [this, number]
+        {
+          throw std::invalid_argument("io1::parse_json: amount at offset " + std::to_string(number - first_) +
+                                      " has more than " + std::to_string(digits_) + " fractional digits.");
+        };
+        scale += static_cast<int>(digits_);
+        if (0 != lowest_lost)
+        {
+          // more significant digits than any amount has: the lowest non-zero one is 10^(scale - lowest_lost) minor
+          // units, a fraction of them or a part of an amount out of range
+          if (scale < lowest_lost) { too_precise(); }
+          out_of_range();
+        }
+        if (0 == magnitude) { return money{0}; }
+        if (0 < scale)
+        {
+          if (scale >= static_cast<int>(powers_of_ten.size()) ||
+              magnitude > std::numeric_limits<std::uint64_t>::max() / powers_of_ten[static_cast<std::size_t>(scale)])
+          {
+            out_of_range();
+          }
+          magnitude *= powers_of_ten[static_cast<std::size_t>(scale)];
+        }
+        else if (0 > scale)
+        {
+          if (-scale >= static_cast<int>(powers_of_ten.size()) ||
+              0 != magnitude % powers_of_ten[static_cast<std::size_t>(-scale)])
+          {
+            too_precise();
+          }
+          magnitude /= powers_of_ten[static_cast<std::size_t>(-scale)];
+        }
+
+        constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<money::value_type>::max());
+        if (magnitude > max + static_cast<std::uint64_t>(negative)) { out_of_range(); }
+        return money{negative ? static_cast<money::value_type>(std::uint64_t{0} - magnitude)
+                              : static_cast<money::value_type>(magnitude)};
+      }
+
+      char const * first_;
+      char const * p_;
+      char const * end_;
+      Handler & handler_;
+      unsigned digits_;
+      std::string unescaped_;
+    };
+
+    // Handler appending the amounts of an array of numbers.
+    struct money_array_handler
+    {
+      std::vector<money> & out;
+      std::size_t depth{0};
+
+      void on_array_begin()
+      {
+        if (0 != depth++) { fail(); }
+      }
+      void on_array_end() noexcept { --depth; }
+      void on_amount(money amount)
+      {
+        if (1 != depth) { fail(); }
+        out.push_back(amount);
+      }
+      [[noreturn]] static void on_object_begin() { fail(); }
+      static void on_object_end() noexcept {}
+      static void on_key(std::string_view /*key*/) noexcept {}
+      [[noreturn]] static void on_string(std::string_view /*text*/) { fail(); }
+      [[noreturn]] static void on_bool(bool /*value*/) { fail(); }
+      [[noreturn]] static void on_null() { fail(); }
+
+      [[noreturn]] static void fail()
+      {
+        throw std::invalid_argument("io1::parse_money_array: not an array of numbers.");
+      }
+    };
+  } // namespace detail
+
+  // Parse JSON text and call the handler for each event, in order. Numbers are amounts with `digits` fractional digits
+  // (at most 18): 12.34 is 1234 minor units with 2 digits. Strings and keys are valid until the next event.
+  //
+  // Throws std::invalid_argument for text that is not valid JSON or a number with more fractional digits than allowed
+  // (other than trailing zeros), and std::overflow_error for an amount out of range. Events are sent as the text is
+  // read, up to the error.
+  template <json_handler Handler>
+  void parse_json(std::string_view text, Handler & handler, unsigned digits = 2)
+  {
+    assert(digits <= 18 && "Amounts have 18 fractional digits at most.");
+    detail::json_parser<Handler>(text, handler, digits).parse();
+  }
+
+  // Append the amounts of a JSON array of numbers to `out`. Throws like io1::parse_json, and std::invalid_argument if
+  // the text is not an array of numbers.
+  inline void parse_money_array(std::string_view text, std::vector<money> & out, unsigned digits = 2)
+  {
+    detail::money_array_handler handler{.out = out};
+    parse_json(text, handler, digits);
+  }
+} // namespace io1
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace io1
+{
+  // The debtor owes the amount to the creditor. Parties are numbered from 0.
+  struct obligation
+  {
+    std::size_t debtor;
+    std::size_t creditor;
+    money amount;
+  };
+
+  struct settlement_transfer
+  {
+    std::size_t from;
+    std::size_t to;
+    money amount;
+
+    [[nodiscard]] friend bool operator==(settlement_transfer const &, settlement_transfer const &) noexcept = default;
+  };
+
+  struct netting_result
+  {
+    std::vector<money128::value_type> positions; // of each party: owed to it minus owed by it
+    std::vector<settlement_transfer> transfers;
+  };
+
+  // Net position of each of `parties` parties: what is owed to it minus what it owes, exactly. Obligations are split
+  // among `threads` workers (one per hardware thread if 0), each summing its share into positions of its own.
+  //
+  // Throws std::out_of_range if an obligation names a party beyond the count.
+  [[nodiscard]] inline std::vector<money128::value_type> net_positions(std::span<obligation const> obligations,
+                                                                       std::size_t parties, std::size_t threads = 0)
+  {
+    constexpr std::size_t grain = std::size_t{1} << 16U;
+    auto const workers = detail::worker_count(obligations.size(), grain, threads);
+    std::vector<money128::value_type> positions(parties, 0);
+    std::vector<std::vector<money128::value_type>> partial(workers - 1);
+
+    detail::parallel_chunks(obligations.size(), workers,
+                            [&](std::size_t w, std::size_t begin, std::size_t end)
+                            {
+                              auto & out = 0 == w ? positions : partial[w - 1];
+                              out.resize(parties, 0);
+                              for (auto i = begin; i < end; ++i)
+                              {
+                                auto const & o = obligations[i];
+                                if (o.debtor >= parties || o.creditor >= parties)
+                                {
+                                  throw std::out_of_range("io1::net_positions: party out of range at index " +
+                                                          std::to_string(i) + ".");
+                                }
+                                out[o.debtor] -= o.amount.data();
+                                out[o.creditor] += o.amount.data();
+                              }
+                            });
+
+    detail::parallel_chunks(parties, detail::worker_count(parties, grain, threads),
+                            [&](std::size_t, std::size_t begin, std::size_t end)
+                            {
+                              for (auto const & p : partial)
+                              {
+                                for (auto i = begin; i < end; ++i) { positions[i] += p[i]; }
+                              }
+                            });
+    return positions;
+  }
+
+  // Transfers settling net positions: parties with a negative position pay, those with a positive one are paid.
+  // Debtors and creditors with opposite positions of the same size are paired first. The others are sorted by
+  // decreasing position once, and the two lists merged: the first debtor not yet settled pays the first creditor not
+  // yet settled as much as it can, and whichever is settled is passed. Partly settled parties are not ranked again.
+  // This takes at most one transfer less than the parties with a position, and usually far fewer than the
+  // obligations. Transfers beyond the range of io1::money are split.
+  //
+  // Throws std::invalid_argument if the positions do not sum to zero, and std::overflow_error if the debts or the
+  // credits sum to 2^128 or more.
+  [[nodiscard]] inline std::vector<settlement_transfer> settle(std::span<money128::value_type const> positions)
+  {
+    struct party
+    {
+      detail::uint128_t magnitude;
+      std::size_t index;
+    };
+
+    std::vector<party> debtors;
+    std::vector<party> creditors;
+    detail::uint128_t debts = 0;
+    detail::uint128_t credits = 0;
+    auto const add = [](detail::uint128_t & total, detail::uint128_t magnitude)
+    {
+      if (std::numeric_limits<detail::uint128_t>::max() - total < magnitude)
+      {
+        throw std::overflow_error("io1::settle: positions out of range.");
+      }
+      total += magnitude;
+    };
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+      if (auto const position = positions[i]; position < 0)
+      {
+        debtors.push_back({detail::uint128_t{0} - static_cast<detail::uint128_t>(position), i});
+        add(debts, debtors.back().magnitude);
+      }
+      else if (0 < position)
+      {
+        creditors.push_back({static_cast<detail::uint128_t>(position), i});
+        add(credits, creditors.back().magnitude);
+      }
+    }
+    if (debts != credits) { throw std::invalid_argument("io1::settle: positions do not sum to zero."); }
+
+    std::vector<settlement_transfer> transfers;
+    auto const pay = [&transfers](party & debtor, party & creditor, detail::uint128_t amount)
+    {
+      debtor.magnitude -= amount;
+      creditor.magnitude -= amount;
+      constexpr auto max = std::numeric_limits<money::value_type>::max();
+      for (; static_cast<detail::uint128_t>(max) < amount; amount -= static_cast<detail::uint128_t>(max))
+      {
+        transfers.push_back({debtor.index, creditor.index, money{max}});
+      }
+      transfers.push_back({debtor.index, creditor.index, money{static_cast<money::value_type>(amount)}});
+    };
+
+    // largest first, then by party for a deterministic result
+    auto const larger = [](party const & a, party const & b) noexcept
+    { return a.magnitude != b.magnitude ? a.magnitude > b.magnitude : a.index < b.index; };
+    std::ranges::sort(debtors, larger);
+    std::ranges::sort(creditors, larger);
+
+    for (std::size_t d = 0, c = 0; d < debtors.size() && c < creditors.size();)
+    {
+      if (debtors[d].magnitude > creditors[c].magnitude) { ++d; }
+      else if (debtors[d].magnitude < creditors[c].magnitude) { ++c; }
+      else
+      {
+        auto const amount = debtors[d].magnitude;
+        pay(debtors[d++], creditors[c++], amount);
+      }
+    }
+    auto const settled = [](party const & p) noexcept { return 0 == p.magnitude; };
+    std::erase_if(debtors, settled);
+    std::erase_if(creditors, settled);
+
+    // a merge of the lists as sorted at first: a party partly settled is not ranked again
+    for (std::size_t d = 0, c = 0; d < debtors.size() && c < creditors.size();)
+    {
+      pay(debtors[d], creditors[c], std::min(debtors[d].magnitude, creditors[c].magnitude));
+      if (settled(debtors[d])) { ++d; }
+      if (settled(creditors[c])) { ++c; }
+    }
+    return transfers;
+  }
+
+  // Net positions of the parties of the obligations and the transfers settling them, on `threads` workers (one per
+  // hardware thread if 0). Throws like io1::net_positions.
+  [[nodiscard]] inline netting_result net_obligations(std::span<obligation const> obligations, std::size_t parties,
+                                                      std::size_t threads = 0)
+  {
+    netting_result result{.positions = net_positions(obligations, parties, threads), .transfers = {}};
+    result.transfers = settle(result.positions);
+    return result;
+  }
+} // namespace io1
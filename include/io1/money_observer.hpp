@@ -0,0 +1,210 @@
+#pragma once
+
+#include "io1/detail/money_hooks.hpp"
+#include "io1/detail/money_int128.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace io1
+{
+  struct money_event_counts
+  {
+    std::uint64_t inexact_divisions;
+    std::uint64_t float_scalings;
+    std::uint64_t float_roundings;
+    unsigned sum_bits; // significant bits of the largest sum or difference, sign excluded
+    std::uint64_t get_money_calls;
+    std::uint64_t get_money_failures;
+    std::uint64_t put_money_calls;
+    std::uint64_t put_money_fallbacks;
+    std::uint64_t formats;
+    std::uint64_t format_fallbacks;
+
+    [[nodiscard]] friend bool operator==(money_event_counts const &, money_event_counts const &) noexcept = default;
+  };
+
+  namespace detail
+  {
+    // Counters of one thread. Only their thread writes them, without read-modify-write instructions: relaxed atomics
+    // just let snapshots read them while they are updated.
+    struct money_event_block
+    {
+      std::atomic<std::uint64_t> inexact_divisions{0};
+      std::atomic<std::uint64_t> float_scalings{0};
+      std::atomic<std::uint64_t> float_roundings{0};
+      std::atomic<unsigned> sum_bits{0};
+      std::atomic<std::uint64_t> get_money_calls{0};
+      std::atomic<std::uint64_t> get_money_failures{0};
+      std::atomic<std::uint64_t> put_money_calls{0};
+      std::atomic<std::uint64_t> put_money_fallbacks{0};
+      std::atomic<std::uint64_t> formats{0};
+      std::atomic<std::uint64_t> format_fallbacks{0};
+
+      template <class T>
+      static void increment(std::atomic<T> & counter) noexcept
+      {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      void add_to(money_event_counts & counts) const noexcept
+      {
+        auto const load = [](auto const & counter) { return counter.load(std::memory_order_relaxed); };
+        counts.inexact_divisions += load(inexact_divisions);
+        counts.float_scalings += load(float_scalings);
+        counts.float_roundings += load(float_roundings);
+        counts.sum_bits = std::max(counts.sum_bits, load(sum_bits));
+        counts.get_money_calls += load(get_money_calls);
+        counts.get_money_failures += load(get_money_failures);
+        counts.put_money_calls += load(put_money_calls);
+        counts.put_money_fallbacks += load(put_money_fallbacks);
+        counts.formats += load(formats);
+        counts.format_fallbacks += load(format_fallbacks);
+      }
+
+      void reset() noexcept
+      {
+        for (auto * counter : {&inexact_divisions, &float_scalings, &float_roundings, &get_money_calls,
+                               &get_money_failures, &put_money_calls, &put_money_fallbacks, &formats,
+                               &format_fallbacks})
+        {
+          counter->store(0, std::memory_order_relaxed);
+        }
+        sum_bits.store(0, std::memory_order_relaxed);
+      }
+    };
+
+    // The blocks of the running threads, and the counts of the threads that exited.
+    struct money_event_registry
+    {
+      std::mutex mutex;
+      std::vector<money_event_block *> blocks;
+      money_event_counts retired{};
+
+      [[nodiscard]] static money_event_registry & instance() noexcept
+      {
+        static money_event_registry registry;
+        return registry;
+      }
+    };
+
+    class money_event_thread
+    {
+    public:
+      money_event_thread()
+      {
+        auto & registry = money_event_registry::instance();
+        std::lock_guard const lock(registry.mutex);
+        registry.blocks.push_back(&block_);
+      }
+      money_event_thread(money_event_thread const &) = delete;
+      money_event_thread(money_event_thread &&) = delete;
+      money_event_thread & operator=(money_event_thread const &) = delete;
+      money_event_thread & operator=(money_event_thread &&) = delete;
+      ~money_event_thread()
+      {
+        auto & registry = money_event_registry::instance();
+        std::lock_guard const lock(registry.mutex);
+        block_.add_to(registry.retired);
+        std::erase(registry.blocks, &block_);
+      }
+
+      [[nodiscard]] static money_event_block & block()
+      {
+        thread_local money_event_thread thread;
+        return thread.block_;
+      }
+
+    private:
+      money_event_block block_;
+    };
+
+    template <class Int>
+    [[nodiscard]] constexpr unsigned significant_bits(Int value) noexcept
+    {
+      using unsigned_type = std::conditional_t<sizeof(Int) <= sizeof(std::uint64_t), std::uint64_t, uint128_t>;
+      auto magnitude =
+          value < 0 ? unsigned_type{0} - static_cast<unsigned_type>(value) : static_cast<unsigned_type>(value);
+      unsigned bits = 0;
+      if constexpr (sizeof(Int) > sizeof(std::uint64_t))
+      {
+        if (0 != (magnitude >> 64U))
+        {
+          magnitude >>= 64U;
+          bits = 64;
+        }
+      }
+      return bits + static_cast<unsigned>(std::numeric_limits<std::uint64_t>::digits -
+                                          std::countl_zero(static_cast<std::uint64_t>(magnitude)));
+    }
+  } // namespace detail
+
+  // Observer counting events in relaxed per-thread counters, summed by snapshot().
+  struct counting_observer
+  {
+    static void on_inexact_division() noexcept { increment(&detail::money_event_block::inexact_divisions); }
+    static void on_float_scaling(bool rounded) noexcept
+    {
+      increment(&detail::money_event_block::float_scalings);
+      if (rounded) { increment(&detail::money_event_block::float_roundings); }
+    }
+    template <class Int>
+    static void on_sum(Int result) noexcept
+    {
+      auto & bits = detail::money_event_thread::block().sum_bits;
+      auto const used = detail::significant_bits(result);
+      if (used > bits.load(std::memory_order_relaxed)) { bits.store(used, std::memory_order_relaxed); }
+    }
+    static void on_get_money(bool parsed) noexcept
+    {
+      increment(&detail::money_event_block::get_money_calls);
+      if (!parsed) { increment(&detail::money_event_block::get_money_failures); }
+    }
+    static void on_put_money(bool fallback) noexcept
+    {
+      increment(&detail::money_event_block::put_money_calls);
+      if (fallback) { increment(&detail::money_event_block::put_money_fallbacks); }
+    }
+    static void on_format(bool fallback) noexcept
+    {
+      increment(&detail::money_event_block::formats);
+      if (fallback) { increment(&detail::money_event_block::format_fallbacks); }
+    }
+
+    // Counts of all threads since the start of the program or the last reset. Counts of threads running meanwhile
+    // may be a few events behind.
+    [[nodiscard]] static money_event_counts snapshot()
+    {
+      auto & registry = detail::money_event_registry::instance();
+      std::lock_guard const lock(registry.mutex);
+      auto counts = registry.retired;
+      for (auto const * block : registry.blocks) { block->add_to(counts); }
+      return counts;
+    }
+
+    // Events counted by threads running meanwhile may be lost.
+    static void reset()
+    {
+      auto & registry = detail::money_event_registry::instance();
+      std::lock_guard const lock(registry.mutex);
+      registry.retired = {};
+      for (auto * block : registry.blocks) { block->reset(); }
+    }
+
+  private:
+    template <class T>
+    static void increment(std::atomic<T> detail::money_event_block::*counter) noexcept
+    {
+      detail::money_event_block::increment(detail::money_event_thread::block().*counter);
+    }
+  };
+
+  static_assert(money_observer<null_observer> && money_observer<counting_observer>);
+} // namespace io1
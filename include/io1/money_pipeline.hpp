@@ -0,0 +1,404 @@
+#pragma once
+
+#include "io1/detail/money_chars.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace io1
+{
+  // Lazy sequence of values computed by a coroutine, resumed each time the next value is needed. A yielded value is
+  // valid until the generator is resumed, and a generator is iterated once.
+  template <class T>
+  class generator
+  {
+  public:
+    struct promise_type
+    {
+      [[nodiscard]] generator get_return_object() noexcept
+      {
+        return generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+      }
+      [[nodiscard]] static std::suspend_always initial_suspend() noexcept { return {}; }
+      [[nodiscard]] static std::suspend_always final_suspend() noexcept { return {}; }
+
+      // temporaries of the co_yield expression live until the coroutine is resumed
+      std::suspend_always yield_value(T const & value) noexcept
+      {
+        value_ = std::addressof(value);
+        return {};
+      }
+      void return_void() noexcept {}
+      void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+      // generators yield but never await
+      template <class U>
+      std::suspend_never await_transform(U &&) = delete;
+
+      T const * value_{nullptr};
+      std::exception_ptr error_;
+    };
+
+    class iterator
+    {
+    public:
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+
+      iterator() noexcept = default;
+      explicit iterator(std::coroutine_handle<promise_type> coroutine) noexcept : coroutine_(coroutine) {}
+
+      [[nodiscard]] T const & operator*() const noexcept { return *coroutine_.promise().value_; }
+      iterator & operator++()
+      {
+        resume(coroutine_);
+        return *this;
+      }
+      void operator++(int) { ++*this; }
+
+      [[nodiscard]] friend bool operator==(iterator const & it, std::default_sentinel_t) noexcept
+      {
+        return it.coroutine_.done();
+      }
+
+    private:
+      std::coroutine_handle<promise_type> coroutine_;
+    };
+
+    generator(generator const &) = delete;
+    generator(generator && other) noexcept : coroutine_(std::exchange(other.coroutine_, {})) {}
+    generator & operator=(generator const &) = delete;
+    generator & operator=(generator && other) noexcept
+    {
+      if (this != &other)
+      {
+        if (coroutine_) { coroutine_.destroy(); }
+        coroutine_ = std::exchange(other.coroutine_, {});
+      }
+      return *this;
+    }
+
+    ~generator() noexcept
+    {
+      if (coroutine_) { coroutine_.destroy(); }
+    }
+
+    [[nodiscard]] iterator begin()
+    {
+      assert(coroutine_ && "A moved-from generator cannot be iterated.");
+      resume(coroutine_);
+      return iterator{coroutine_};
+    }
+    [[nodiscard]] static std::default_sentinel_t end() noexcept { return {}; }
+
+  private:
+    explicit generator(std::coroutine_handle<promise_type> coroutine) noexcept : coroutine_(coroutine) {}
+
+    // exceptions thrown by the coroutine propagate to whoever asked for the next value
+    static void resume(std::coroutine_handle<promise_type> coroutine)
+    {
+      coroutine.resume();
+      if (auto & error = coroutine.promise().error_; error) { std::rethrow_exception(std::exchange(error, nullptr)); }
+    }
+
+    std::coroutine_handle<promise_type> coroutine_;
+  };
+
+  // Batches of amounts flowing from one stage of a pipeline to the next.
+  using money_batches = generator<std::span<money const>>;
+
+  namespace detail
+  {
+    [[nodiscard]] constexpr bool is_feed_space(char c) noexcept { return ' ' == c || ('\t' <= c && c <= '\r'); }
+
+    // Longer text cannot be an amount, leading zeros aside: the carry between two chunks stays small whatever the feed.
+    inline constexpr std::size_t max_amount_chars = 64;
+
+    // Size of an amount without the leading zeros that do not change its value: 007 is as long as 7.
+    [[nodiscard]] constexpr std::size_t significant_size(char const * first, char const * last) noexcept
+    {
+      auto const sign = first != last && '-' == *first;
+      auto const * p = sign ? first + 1 : first;
+      while (1 < last - p && '0' == *p && '0' <= p[1] && p[1] <= '9') { ++p; }
+      return static_cast<std::size_t>(last - p) + static_cast<std::size_t>(sign);
+    }
+
+    // Bounded queue of batches between a producer thread and the consuming coroutine. Slots are allocated once and
+    // reused: the memory of a buffered stage does not grow with the length of the feed.
+    class batch_queue
+    {
+    public:
+      explicit batch_queue(std::size_t depth) : slots_(depth) {}
+
+      // Copy the batches into free slots until they are exhausted or stop() is called. Runs on the producer thread.
+      void produce(money_batches & batches) noexcept
+      {
+        try
+        {
+          for (auto const batch : batches)
+          {
+            std::unique_lock lock(mutex_);
+            not_full_.wait(lock, [this] { return stopped_ || count_ < slots_.size(); });
+            if (stopped_) { return; }
+            // the consumer does not see this slot before count_ is incremented
+            auto & slot = slots_[(head_ + count_) % slots_.size()];
+            lock.unlock();
+            slot.assign(batch.begin(), batch.end());
+            lock.lock();
+            ++count_;
+            not_empty_.notify_one();
+          }
+        }
+        catch (...)
+        {
+          std::lock_guard const lock(mutex_);
+          error_ = std::current_exception();
+        }
+
+        std::lock_guard const lock(mutex_);
+        done_ = true;
+        not_empty_.notify_one();
+      }
+
+      // The oldest batch, or nullptr once the producer is done. It stays valid until release() is called.
+      [[nodiscard]] std::vector<money> const * front()
+      {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return 0 < count_ || done_; });
+        if (0 < count_) { return &slots_[head_]; }
+        if (error_) { std::rethrow_exception(error_); }
+        return nullptr;
+      }
+
+      void release() noexcept
+      {
+        std::lock_guard const lock(mutex_);
+        head_ = (head_ + 1) % slots_.size();
+        --count_;
+        not_full_.notify_one();
+      }
+
+      void stop() noexcept
+      {
+        std::lock_guard const lock(mutex_);
+        stopped_ = true;
+        not_full_.notify_one();
+      }
+
+    private:
+      std::vector<std::vector<money>> slots_;
+      std::size_t head_{0};
+      std::size_t count_{0};
+      bool done_{false};
+      bool stopped_{false};
+      std::exception_ptr error_;
+      std::mutex mutex_;
+      std::condition_variable not_empty_;
+      std::condition_variable not_full_;
+    };
+
+    // Stops and joins the producer of a buffered stage, also when the consumer stops iterating early.
+    struct batch_producer
+    {
+      batch_producer(batch_queue & output, money_batches & batches)
+          : queue(output), thread([&output, &batches] { output.produce(batches); })
+      {
+      }
+      batch_producer(batch_producer const &) = delete;
+      batch_producer(batch_producer &&) = delete;
+      batch_producer & operator=(batch_producer const &) = delete;
+      batch_producer & operator=(batch_producer &&) = delete;
+      ~batch_producer() noexcept
+      {
+        queue.stop();
+        thread.join();
+      }
+
+      batch_queue & queue;
+      std::thread thread;
+    };
+  } // namespace detail
+
+  // Read a stream by chunks of chunk_size bytes (fewer for the last one) into a buffer reused from one chunk to the
+  // next. The stream must outlive the generator.
+  //
+  // Throws std::system_error if the stream reports an I/O error.
+  inline generator<std::span<char const>> read_chunks(std::istream & in,
+                                                      std::size_t chunk_size = std::size_t{1} << 16U)
+  {
+    assert(0 < chunk_size && "Chunks cannot be empty.");
+    std::vector<char> buffer(chunk_size);
+    while (in)
+    {
+      in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      auto const size = static_cast<std::size_t>(in.gcount());
+      if (0 < size) { co_yield std::span<char const>(buffer.data(), size); }
+    }
+    if (in.bad()) { throw std::system_error(std::make_error_code(std::io_errc::stream), "io1::read_chunks"); }
+  }
+
+  // Parse chunks of text into amounts separated by white space, each a decimal number with at most `digits` fractional
+  // digits written in minor units (12.5 is 1250 with 2 digits), and yield them by batches of batch_size amounts (fewer
+  // for the last one). Amounts may straddle chunks.
+  //
+  // Throws std::invalid_argument for text that is not such a number, or is longer than 64 characters once its leading
+  // zeros are dropped, and std::overflow_error for an amount out of range, once the amounts before it have been
+  // yielded. Where the chunks end changes nothing to the amounts or to the errors.
+  inline money_batches parse_amounts(generator<std::span<char const>> chunks, unsigned digits = 2,
+                                     std::size_t batch_size = 4'096)
+  {
+    assert(0 < batch_size && "Batches cannot be empty.");
+    std::vector<money> batch;
+    batch.reserve(batch_size);
+    std::string carry; // amount cut by the end of the previous chunk
+    carry.reserve(detail::max_amount_chars);
+
+    std::size_t index = 0; // of the next amount in the feed
+    auto const invalid = [&index]
+    { throw std::invalid_argument("io1::parse_amounts: invalid amount at index " + std::to_string(index) + "."); };
+    auto const read = [&index, &invalid, digits](char const * first, char const * last)
+    {
+      money::value_type amount = 0;
+      auto const [end, error] = detail::from_decimal_chars(first, last, amount, digits);
+      if (std::errc::result_out_of_range == error)
+      {
+        throw std::overflow_error("io1::parse_amounts: amount at index " + std::to_string(index) + " out of range.");
+      }
+      if (std::errc{} != error || end != last) { invalid(); }
+      return amount;
+    };
+    auto const parse = [&batch, &index, &read](char const * first, char const * last)
+    {
+      batch.emplace_back(read(first, last));
+      ++index;
+    };
+    // the same limit inside a chunk and across chunks, where the carry is rejected as soon as it is too long
+    auto const check_size = [&read, &invalid](char const * first, char const * last)
+    {
+      if (static_cast<std::size_t>(last - first) <= detail::max_amount_chars ||
+          detail::significant_size(first, last) <= detail::max_amount_chars)
+      {
+        return;
+      }
+      static_cast<void>(read(first, last));
+      invalid();
+    };
+    // the leading zeros of the carry are dropped as they come
+    auto const drop_zeros = [&carry]
+    {
+      auto const sign = static_cast<std::size_t>(carry.starts_with('-'));
+      carry.erase(sign, carry.size() - detail::significant_size(carry.data(), carry.data() + carry.size()));
+    };
+
+    for (auto const chunk : chunks)
+    {
+      auto const * p = chunk.data();
+      auto const * const end = p + chunk.size();
+
+      if (!carry.empty())
+      {
+        auto const * const last = std::find_if(p, end, detail::is_feed_space);
+        carry.append(p, last);
+        drop_zeros();
+        check_size(carry.data(), carry.data() + carry.size());
+        if (last == end) { continue; }
+        parse(carry.data(), carry.data() + carry.size());
+        carry.clear();
+        p = last;
+        if (batch.size() == batch_size)
+        {
+          co_yield std::span<money const>(batch);
+          batch.clear();
+        }
+      }
+
+      while (true)
+      {
+        p = std::find_if_not(p, end, detail::is_feed_space);
+        if (p == end) { break; }
+        auto const * const last = std::find_if(p, end, detail::is_feed_space);
+        if (last == end)
+        {
+          carry.assign(p, last);
+          drop_zeros();
+          check_size(carry.data(), carry.data() + carry.size());
+          break;
+        }
+        check_size(p, last);
+        parse(p, last);
+        p = last;
+        if (batch.size() == batch_size)
+        {
+          co_yield std::span<money const>(batch);
+          batch.clear();
+        }
+      }
+    }
+
+    if (!carry.empty()) { parse(carry.data(), carry.data() + carry.size()); }
+    if (!batch.empty()) { co_yield std::span<money const>(batch); }
+  }
+
+  // Replace each amount by f(amount). Batches of more than a few thousand amounts are split among `threads` workers
+  // (one per hardware thread if 0), which call f concurrently.
+  template <class F>
+    requires std::is_invocable_r_v<money, F const &, money>
+  money_batches transform(money_batches batches, F f, std::size_t threads = 0)
+  {
+    std::vector<money> out;
+    for (auto const batch : batches)
+    {
+      out.resize(batch.size());
+      constexpr std::size_t grain = std::size_t{1} << 14U;
+      detail::parallel_chunks(batch.size(), detail::worker_count(batch.size(), grain, threads),
+                              [&](std::size_t, std::size_t begin, std::size_t end)
+                              {
+                                for (auto i = begin; i < end; ++i) { out[i] = f(batch[i]); }
+                              });
+      co_yield std::span<money const>(out);
+    }
+  }
+
+  // Run the stages producing the batches on a thread of their own, at most `depth` batches ahead of the consumer: the
+  // stream is read and parsed while the amounts already parsed are processed. Exceptions of the producing stages are
+  // rethrown to the consumer after the batches produced before them.
+  inline money_batches buffered(money_batches batches, std::size_t depth = 4)
+  {
+    assert(0 < depth && "At least one batch must be buffered.");
+    detail::batch_queue queue(depth);
+    detail::batch_producer const producer(queue, batches);
+    while (auto const * const batch = queue.front())
+    {
+      co_yield std::span<money const>(*batch);
+      queue.release();
+    }
+  }
+
+  // Fold the batches into an aggregate: f(aggregate, batch) returns the aggregate updated with the amounts of batch.
+  template <class T, class F>
+    requires std::is_invocable_r_v<T, F &, T, std::span<money const>>
+  [[nodiscard]] T aggregate(money_batches batches, T init, F f)
+  {
+    for (auto const batch : batches) { init = f(std::move(init), batch); }
+    return init;
+  }
+} // namespace io1
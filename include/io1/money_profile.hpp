@@ -0,0 +1,221 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/money_iso4217.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace io1
+{
+  enum class symbol_position : std::uint8_t
+  {
+    prefix,
+    suffix
+  };
+
+  enum class sign_position : std::uint8_t
+  {
+    leading,      // -$1.00
+    after_symbol, // $-1.00
+    trailing,     // $1.00-
+    parentheses   // ($1.00)
+  };
+
+  // Locale-less presentation of amounts. Strings are UTF-8.
+  struct format_profile
+  {
+    std::string_view name;
+    std::string_view decimal_point;
+    std::string_view group_separator;
+    std::uint8_t first_group;  // digits of the group closest to the decimal point, 0 for no grouping
+    std::uint8_t other_groups; // digits of the next groups
+    symbol_position symbol;
+    std::string_view symbol_separator; // between the symbol and the digits
+    sign_position sign;
+    bool code; // the ISO 4217 code instead of the local symbol
+  };
+
+  namespace detail
+  {
+    using enum symbol_position;
+    using enum sign_position;
+
+    inline constexpr std::string_view nbsp = "\xC2\xA0";               // U+00A0
+    inline constexpr std::string_view narrow_nbsp = "\xE2\x80\xAF"; // U+202F
+
+    inline constexpr format_profile format_profiles[] = {
+        {"plain", ".", "", 0, 0, prefix, "", leading, false},                   // -1234.56
+        {"iso", ".", ",", 3, 3, prefix, " ", leading, true},                    // -USD 1,234.56
+        {"accounting", ".", ",", 3, 3, prefix, "", parentheses, false},         // ($1,234.56)
+        {"en_US", ".", ",", 3, 3, prefix, "", leading, false},                  // -$1,234.56
+        {"en_GB", ".", ",", 3, 3, prefix, "", leading, false},                  // -£1,234.56
+        {"en_IN", ".", ",", 3, 2, prefix, "", leading, false},                  // -₹12,34,567.89
+        {"de_DE", ",", ".", 3, 3, suffix, nbsp, leading, false},                // -1.234,56 €
+        {"de_CH", ".", "\xE2\x80\x99", 3, 3, prefix, nbsp, after_symbol, true}, // CHF-1’234.56
+        {"fr_FR", ",", narrow_nbsp, 3, 3, suffix, nbsp, leading, false},        // -1 234,56 €
+        {"it_IT", ",", ".", 3, 3, suffix, nbsp, leading, false},                // -1.234,56 €
+        {"es_ES", ",", ".", 3, 3, suffix, nbsp, leading, false},                // -1.234,56 €
+        {"nl_NL", ",", ".", 3, 3, prefix, nbsp, after_symbol, false},           // € -1.234,56
+        {"pt_BR", ",", ".", 3, 3, prefix, nbsp, leading, false},                // -R$ 1.234,56
+        {"sv_SE", ",", nbsp, 3, 3, suffix, nbsp, leading, false},               // -1 234,56 kr
+        {"ja_JP", ".", ",", 3, 3, prefix, "", leading, false},                  // -¥1,235
+        {"zh_CN", ".", ",", 3, 3, prefix, "", leading, false},                  // -¥1,234.56
+    };
+
+    // Amounts have 40 digits at most, groups 2 digits at least and the separators 3 bytes: a formatted amount always
+    // fits.
+    inline constexpr std::size_t profile_buffer_size = 128;
+
+    static_assert(std::ranges::all_of(format_profiles,
+                                      [](format_profile const & p)
+                                      {
+                                        return p.decimal_point.size() <= 3 && p.group_separator.size() <= 3 &&
+                                               p.symbol_separator.size() <= 3 &&
+                                               (0 == p.first_group || (1 < p.first_group && 1 < p.other_groups));
+                                      }),
+                  "Profiles must fit in the formatting buffer.");
+    static_assert(std::ranges::all_of(iso_4217, [](currency_info const & c) { return c.symbol.size() <= 8; }),
+                  "Symbols must fit in the formatting buffer.");
+
+    // Write `amount` minor units with `digits` fractional digits (at most 18) according to `profile`, followed or
+    // preceded by `symbol` unless it is empty. `out` must have room for profile_buffer_size characters. Return the
+    // number of characters written.
+    template <class Int>
+    constexpr std::size_t format_with_profile(char * out, Int amount, unsigned digits, format_profile const & profile,
+                                              std::string_view symbol) noexcept
+    {
+      using Unsigned = std::conditional_t<(sizeof(Int) > sizeof(std::uint64_t)), uint128_t, std::uint64_t>;
+      auto magnitude = amount < 0 ? Unsigned{0} - static_cast<Unsigned>(amount) : static_cast<Unsigned>(amount);
+
+      // least significant first, with at least one integral digit
+      char decimal[40]{}; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      std::size_t count = 0;
+      do
+      {
+        decimal[count++] = static_cast<char>('0' + static_cast<int>(magnitude % 10));
+        magnitude /= 10;
+      } while (0 != magnitude);
+      while (count < digits + 1) { decimal[count++] = '0'; }
+
+      auto * p = out;
+      auto const append = [&p](std::string_view s) noexcept { p = std::ranges::copy(s, p).out; };
+      bool const negative = amount < 0;
+
+      if (negative && sign_position::parentheses == profile.sign) { append("("); }
+      auto const sign_first = sign_position::leading == profile.sign ||
+                              (symbol.empty() && sign_position::after_symbol == profile.sign);
+      if (negative && sign_first) { append("-"); }
+      if (!symbol.empty() && symbol_position::prefix == profile.symbol)
+      {
+        append(symbol);
+        append(profile.symbol_separator);
+        if (negative && sign_position::after_symbol == profile.sign) { append("-"); }
+      }
+
+      for (auto i = count; i-- > digits;)
+      {
+        *p++ = decimal[i];
+        // distance to the decimal point of the separator that may follow this digit
+        auto const distance = i - digits;
+        if (0 < profile.first_group && distance >= profile.first_group &&
+            0 == (distance - profile.first_group) % profile.other_groups)
+        {
+          append(profile.group_separator);
+        }
+      }
+      if (0 < digits)
+      {
+        append(profile.decimal_point);
+        for (auto i = digits; i-- > 0;) { *p++ = decimal[i]; }
+      }
+
+      if (!symbol.empty() && symbol_position::suffix == profile.symbol)
+      {
+        append(profile.symbol_separator);
+        append(symbol);
+      }
+      if (negative && sign_position::trailing == profile.sign) { append("-"); }
+      if (negative && sign_position::parentheses == profile.sign) { append(")"); }
+
+      return static_cast<std::size_t>(p - out);
+    }
+  } // namespace detail
+
+  [[nodiscard]] constexpr std::span<format_profile const> format_profiles() noexcept
+  {
+    return detail::format_profiles;
+  }
+
+  // Profile of a given name, nullptr if unknown.
+  [[nodiscard]] constexpr format_profile const * find_profile(std::string_view name) noexcept
+  {
+    auto const it = std::ranges::find(detail::format_profiles, name, &format_profile::name);
+    return it != std::ranges::end(detail::format_profiles) ? it : nullptr;
+  }
+
+  namespace detail
+  {
+    // Format specification with a profile: [fill-and-align][width][#]p<profile>[:<currency code>].
+    struct profile_spec
+    {
+      format_profile const * profile{nullptr};  // nullptr when the specification has no profile
+      currency_info const * currency{nullptr};  // nullptr when the specification names no currency
+      bool show_symbol{false};
+      std::size_t string_spec_size{0};          // size of the fill, align and width prefix
+    };
+
+    template <class CharT>
+    [[nodiscard]] constexpr profile_spec parse_profile_spec(std::basic_string_view<CharT> spec)
+    {
+      constexpr auto is_align = [](CharT c) { return '<' == c || '>' == c || '^' == c; };
+
+      // a 'p' followed by an alignment is a fill character
+      std::size_t type = 0;
+      while (type < spec.size() && !('p' == spec[type] && (type + 1 == spec.size() || !is_align(spec[type + 1]))))
+      {
+        ++type;
+      }
+      if (type == spec.size()) { return {}; }
+
+      profile_spec result;
+      result.show_symbol = 0 < type && '#' == spec[type - 1];
+      result.string_spec_size = result.show_symbol ? type - 1 : type;
+
+      auto const to_chars = [](std::basic_string_view<CharT> s, char * out)
+      {
+        for (auto const c : s)
+        {
+          if (0x7F < static_cast<std::uint32_t>(c)) { throw std::format_error("io1::money: invalid format profile."); }
+          *out++ = static_cast<char>(c);
+        }
+      };
+
+      auto rest = spec.substr(type + 1);
+      auto const colon = rest.find(':');
+      auto const name = rest.substr(0, colon);
+      char name_buffer[32]{}; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      if (name.size() > sizeof(name_buffer)) { throw std::format_error("io1::money: unknown format profile."); }
+      to_chars(name, name_buffer);
+      result.profile = find_profile(std::string_view(name_buffer, name.size()));
+      if (nullptr == result.profile) { throw std::format_error("io1::money: unknown format profile."); }
+
+      if (colon != rest.npos)
+      {
+        auto const code = rest.substr(colon + 1);
+        char code_buffer[3]{}; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        if (code.size() != sizeof(code_buffer)) { throw std::format_error("io1::money: unknown currency code."); }
+        to_chars(code, code_buffer);
+        result.currency = find_currency(std::string_view(code_buffer, 3));
+        if (nullptr == result.currency) { throw std::format_error("io1::money: unknown currency code."); }
+      }
+
+      return result;
+    }
+  } // namespace detail
+} // namespace io1
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <locale>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace io1
+{
+  struct moneypunct_cache_statistics
+  {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::size_t entries;
+  };
+
+  namespace detail
+  {
+    // The layout below is the one of libstdc++ money_put, which omits the integral zero of amounts below one major
+    // unit. Other standard libraries keep using their own facet.
+#ifdef __GLIBCXX__
+    inline constexpr bool moneypunct_plan_layout = true;
+#else
+    inline constexpr bool moneypunct_plan_layout = false;
+#endif
+
+    // Immutable snapshot of a std::moneypunct<char, Intl> facet.
+    struct moneypunct_plan
+    {
+      char decimal_point;
+      char thousands_sep;
+      std::string grouping;
+      std::string curr_symbol;
+      std::string positive_sign;
+      std::string negative_sign;
+      int frac_digits;
+      std::money_base::pattern pos_format;
+      std::money_base::pattern neg_format;
+      bool standard_put; // the locale uses the standard money_put facet, which the plan can stand in for
+
+      template <bool Intl>
+      [[nodiscard]] static moneypunct_plan snapshot(std::moneypunct<char, Intl> const & punct,
+                                                    std::money_put<char> const & put)
+      {
+        auto grouping = punct.grouping();
+        grouping.resize(std::min(grouping.size(), grouping.find('\0'))); // a nul ends the grouping, as in C
+        return {.decimal_point = punct.decimal_point(),
+                .thousands_sep = punct.thousands_sep(),
+                .grouping = std::move(grouping),
+                .curr_symbol = punct.curr_symbol(),
+                .positive_sign = punct.positive_sign(),
+                .negative_sign = punct.negative_sign(),
+                .frac_digits = punct.frac_digits(),
+                .pos_format = punct.pos_format(),
+                .neg_format = punct.neg_format(),
+                .standard_put = moneypunct_plan_layout && typeid(put) == typeid(std::money_put<char>)};
+      }
+    };
+
+    struct moneypunct_counters
+    {
+      std::atomic<std::uint64_t> hits{0};
+      std::atomic<std::uint64_t> misses{0};
+      std::atomic<std::size_t> entries{0};
+    };
+
+    inline moneypunct_counters & moneypunct_statistics() noexcept
+    {
+      static moneypunct_counters counters;
+      return counters;
+    }
+
+    // Plans of the last locales used, keyed by the identity of their moneypunct and money_put facets. Entries hold a
+    // copy of their locale: the facets cannot be destroyed, and their address reused, while they are cached. Each
+    // thread also keeps its last plan, found without locking.
+    template <bool Intl>
+    class moneypunct_cache
+    {
+    public:
+      static constexpr std::size_t capacity = 16;
+
+      // The reference is valid until the next lookup from the same thread.
+      [[nodiscard]] static moneypunct_plan const & lookup(std::locale const & loc)
+      {
+        auto const * const punct = &std::use_facet<std::moneypunct<char, Intl>>(loc);
+        auto const * const put = &std::use_facet<std::money_put<char>>(loc);
+        auto & counters = moneypunct_statistics();
+
+        thread_local entry last{};
+        if (last.punct == punct && last.put == put)
+        {
+          counters.hits.fetch_add(1, std::memory_order_relaxed);
+          return *last.plan;
+        }
+
+        auto & cache = instance();
+        {
+          std::shared_lock const lock(cache.mutex_);
+          if (auto const * const found = cache.find(punct, put))
+          {
+            last = *found;
+            counters.hits.fetch_add(1, std::memory_order_relaxed);
+            return *last.plan;
+          }
+        }
+
+        // virtual calls and allocations out of the lock
+        auto plan = std::make_shared<moneypunct_plan const>(moneypunct_plan::snapshot(*punct, *put));
+        counters.misses.fetch_add(1, std::memory_order_relaxed);
+
+        std::unique_lock const lock(cache.mutex_);
+        if (auto const * const found = cache.find(punct, put)) { last = *found; }
+        else
+        {
+          last = entry{.locale = loc, .punct = punct, .put = put, .plan = std::move(plan)};
+          if (cache.entries_.size() < capacity)
+          {
+            cache.entries_.push_back(last);
+            counters.entries.fetch_add(1, std::memory_order_relaxed);
+          }
+          else { cache.entries_[cache.next_++ % capacity] = last; } // oldest first
+        }
+        return *last.plan;
+      }
+
+      static void clear()
+      {
+        auto & cache = instance();
+        std::unique_lock const lock(cache.mutex_);
+        moneypunct_statistics().entries.fetch_sub(cache.entries_.size(), std::memory_order_relaxed);
+        cache.entries_.clear();
+        cache.next_ = 0;
+      }
+
+    private:
+      struct entry
+      {
+        std::locale locale;
+        void const * punct{nullptr};
+        void const * put{nullptr};
+        std::shared_ptr<moneypunct_plan const> plan;
+      };
+
+      [[nodiscard]] static moneypunct_cache & instance()
+      {
+        static moneypunct_cache cache;
+        return cache;
+      }
+
+      [[nodiscard]] entry const * find(void const * punct, void const * put) const noexcept
+      {
+        auto const it =
+            std::ranges::find_if(entries_, [&](entry const & e) { return e.punct == punct && e.put == put; });
+        return it != entries_.end() ? &*it : nullptr;
+      }
+
+      std::shared_mutex mutex_;
+      std::vector<entry> entries_;
+      std::size_t next_{0};
+    };
+
+    // Minor units, as decimal digits after a '-' if negative, laid out like money_put does with the facet `plan`
+    // was taken from, on a stream with the given flags, width and fill.
+    class money_put_layout
+    {
+    public:
+      money_put_layout(moneypunct_plan const & plan, std::string_view amount, std::ios_base::fmtflags flags,
+                       std::streamsize width, char fill) noexcept
+          : plan_(plan), pattern_(amount.starts_with('-') ? plan.neg_format : plan.pos_format),
+            sign_(amount.starts_with('-') ? plan.negative_sign : plan.positive_sign), fill_(fill),
+            showbase_(0 != (flags & std::ios_base::showbase))
+      {
+        assert(amount.size() <= sizeof(digits_) && "Amounts have 40 characters at most.");
+        std::ranges::copy(amount, digits_);
+        first_ = amount.starts_with('-') ? 1 : 0;
+        length_ = amount.size() - first_;
+
+        // integral digits and their separators, split as std::__add_grouping does
+        auto const frac_digits = static_cast<long>(plan.frac_digits);
+        auto const padded = static_cast<long>(length_) - frac_digits;
+        integral_ = padded <= 0 ? 0 : (frac_digits < 0 ? length_ : static_cast<std::size_t>(padded));
+        head_ = integral_;
+        auto const & groups = plan.grouping;
+        while (!groups.empty() && static_cast<signed char>(groups[group_]) > 0 && CHAR_MAX != groups[group_] &&
+               head_ > static_cast<std::size_t>(groups[group_]))
+        {
+          head_ -= static_cast<std::size_t>(groups[group_]);
+          group_ < groups.size() - 1 ? ++group_ : ++repeat_;
+        }
+
+        auto const symbol = showbase_ ? plan.curr_symbol.size() : 0;
+        auto const fraction = 0 < frac_digits ? 1 + static_cast<std::size_t>(frac_digits) : 0;
+        auto const value = integral_ + group_ + repeat_ + fraction;
+        auto const content = value + sign_.size() + symbol;
+        auto const requested = static_cast<std::size_t>(std::max<std::streamsize>(width, 0));
+        auto const adjust = flags & std::ios_base::adjustfield;
+        if (std::ios_base::internal == adjust && content < requested) { internal_ = requested - content; }
+
+        size_ = content;
+        for (auto const field : pattern_.field)
+        {
+          if (std::money_base::space == field) { size_ += 0 != internal_ ? internal_ : 1; }
+          else if (std::money_base::none == field) { size_ += internal_; }
+        }
+        if (requested > size_)
+        {
+          (std::ios_base::left == adjust ? right_pad_ : left_pad_) = requested - size_;
+          size_ = requested;
+        }
+      }
+
+      [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+      // Write size() characters.
+      char * write(char * out) const noexcept
+      {
+        out = std::fill_n(out, left_pad_, fill_);
+        for (auto const field : pattern_.field)
+        {
+          switch (field)
+          {
+          case std::money_base::symbol:
+            if (showbase_) { out = std::ranges::copy(plan_.curr_symbol, out).out; }
+            break;
+          case std::money_base::sign:
+            if (!sign_.empty()) { *out++ = sign_.front(); }
+            break;
+          case std::money_base::value: out = write_value(out); break;
+          case std::money_base::space: out = std::fill_n(out, 0 != internal_ ? internal_ : 1, fill_); break;
+          case std::money_base::none: out = std::fill_n(out, internal_, fill_); break;
+          default: break;
+          }
+        }
+        // the rest of a multi-character sign goes last
+        if (sign_.size() > 1) { out = std::ranges::copy(sign_.substr(1), out).out; }
+        return std::fill_n(out, right_pad_, fill_);
+      }
+
+    private:
+      char * write_value(char * out) const noexcept
+      {
+        auto const * digit = digits_ + first_;
+        auto const copy_group = [&](char group)
+        {
+          *out++ = plan_.thousands_sep;
+          out = std::copy_n(digit, group, out);
+          digit += group;
+        };
+
+        out = std::copy_n(digit, head_, out);
+        digit += head_;
+        for (auto i = repeat_; 0 != i; --i) { copy_group(plan_.grouping[group_]); }
+        for (auto i = group_; 0 != i--;) { copy_group(plan_.grouping[i]); }
+
+        if (0 < plan_.frac_digits)
+        {
+          *out++ = plan_.decimal_point;
+          auto const frac_digits = static_cast<std::size_t>(plan_.frac_digits);
+          if (length_ >= frac_digits) { out = std::copy_n(digits_ + first_ + integral_, frac_digits, out); }
+          else
+          {
+            out = std::fill_n(out, frac_digits - length_, '0');
+            out = std::copy_n(digits_ + first_, length_, out);
+          }
+        }
+        return out;
+      }
+
+      moneypunct_plan const & plan_;
+      std::money_base::pattern pattern_;
+      std::string_view sign_;
+      char digits_[40]{}; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      std::size_t first_{0};  // index of the first digit
+      std::size_t length_{0}; // number of digits
+      std::size_t integral_{0};
+      std::size_t head_{0};   // integral digits before the first separator
+      std::size_t group_{0};  // index of the last group size used
+      std::size_t repeat_{0}; // repetitions of the last group size
+      std::size_t internal_{0};
+      std::size_t left_pad_{0};
+      std::size_t right_pad_{0};
+      std::size_t size_{0};
+      char fill_;
+      bool showbase_;
+    };
+
+    // Call f with the layout of amount written in a local buffer, or on the heap when it does not fit.
+    template <class F>
+    decltype(auto) with_money_put(money_put_layout const & layout, F && f)
+    {
+      char buffer[256]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+      if (layout.size() <= sizeof(buffer))
+      {
+        layout.write(buffer);
+        return std::forward<F>(f)(std::string_view(buffer, layout.size()));
+      }
+      std::string heap(layout.size(), '\0');
+      layout.write(heap.data());
+      return std::forward<F>(f)(std::string_view(heap));
+    }
+  } // namespace detail
+
+  // Hits and misses of the moneypunct cache behind io1::put_money and the m/M format specifications.
+  [[nodiscard]] inline moneypunct_cache_statistics moneypunct_cache_stats() noexcept
+  {
+    auto const & counters = detail::moneypunct_statistics();
+    return {.hits = counters.hits.load(std::memory_order_relaxed),
+            .misses = counters.misses.load(std::memory_order_relaxed),
+            .entries = counters.entries.load(std::memory_order_relaxed)};
+  }
+
+  // Drop the cached plans and reset the statistics. Threads keep the plan they last used.
+  inline void clear_moneypunct_cache()
+  {
+    detail::moneypunct_cache<false>::clear();
+    detail::moneypunct_cache<true>::clear();
+    auto & counters = detail::moneypunct_statistics();
+    counters.hits.store(0, std::memory_order_relaxed);
+    counters.misses.store(0, std::memory_order_relaxed);
+  }
+} // namespace io1
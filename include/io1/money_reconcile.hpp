@@ -0,0 +1,435 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_sort.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace io1
+{
+  struct ledger_entry
+  {
+    money amount;
+    std::chrono::sys_days date;
+    std::uint64_t reference;
+  };
+
+  struct reconciliation_options
+  {
+    std::chrono::days date_tolerance{0};
+    money amount_tolerance{0};               // approximate matches are only looked for when positive
+    std::size_t max_group_size{3};           // entries summing to a single one, no grouping below 2
+    std::size_t max_group_candidates{16};    // entries sharing a reference beyond which grouping is not attempted
+    std::size_t threads{0};                  // one per hardware thread if 0
+  };
+
+  struct reconciliation_pair
+  {
+    std::size_t left;
+    std::size_t right;
+
+    [[nodiscard]] friend bool operator==(reconciliation_pair const &, reconciliation_pair const &) noexcept = default;
+  };
+
+  // Several entries of one side matching a single entry of the other one.
+  struct reconciliation_group
+  {
+    std::vector<std::size_t> left;
+    std::vector<std::size_t> right;
+  };
+
+  struct reconciliation_result
+  {
+    std::vector<reconciliation_pair> exact;       // same amount
+    std::vector<reconciliation_pair> approximate; // amounts within the tolerance
+    std::vector<reconciliation_group> groups;     // same reference, amounts summing exactly
+    std::vector<std::size_t> unmatched_left;
+    std::vector<std::size_t> unmatched_right;
+  };
+
+  namespace detail
+  {
+    struct reconciler
+    {
+      std::span<ledger_entry const> left;
+      std::span<ledger_entry const> right;
+      reconciliation_options const & options;
+      std::size_t workers;
+      std::vector<std::uint8_t> left_matched = std::vector<std::uint8_t>(left.size(), 0);
+      std::vector<std::uint8_t> right_matched = std::vector<std::uint8_t>(right.size(), 0);
+
+      [[nodiscard]] bool close_dates(ledger_entry const & l, ledger_entry const & r) const noexcept
+      {
+        auto const gap = l.date < r.date ? r.date - l.date : l.date - r.date;
+        return gap <= options.date_tolerance;
+      }
+
+      void pair(std::size_t l, std::size_t r, std::vector<reconciliation_pair> & out) noexcept
+      {
+        left_matched[l] = right_matched[r] = 1;
+        out.push_back({.left = l, .right = r});
+      }
+
+      // Maximum matching of two date-sorted lists where entries may pair when their dates are close enough: pairing
+      // the earliest compatible entries first is optimal.
+      void match_by_date(std::span<std::size_t const> lefts, std::span<std::size_t const> rights,
+                         std::vector<reconciliation_pair> & out) noexcept
+      {
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < lefts.size() && j < rights.size())
+        {
+          auto const & l = left[lefts[i]];
+          auto const & r = right[rights[j]];
+          if (close_dates(l, r)) { pair(lefts[i++], rights[j++], out); }
+          else if (l.date < r.date) { ++i; }
+          else { ++j; }
+        }
+      }
+
+      // Entries sharing the same amount: pair the ones with the same reference first, then any by date.
+      void match_same_amount(std::vector<std::size_t> & lefts, std::vector<std::size_t> & rights,
+                             std::vector<reconciliation_pair> & out)
+      {
+        auto const by_reference = [](std::span<ledger_entry const> side)
+        {
+          return [side](std::size_t a, std::size_t b) noexcept
+          {
+            return side[a].reference != side[b].reference ? side[a].reference < side[b].reference
+                                                            : side[a].date < side[b].date;
+          };
+        };
+        std::ranges::sort(lefts, by_reference(left));
+        std::ranges::sort(rights, by_reference(right));
+
+        for (std::size_t i = 0, j = 0; i < lefts.size() && j < rights.size();)
+        {
+          auto const reference = left[lefts[i]].reference;
+          if (reference < right[rights[j]].reference) { ++i; }
+          else if (right[rights[j]].reference < reference) { ++j; }
+          else
+          {
+            auto i_end = i;
+            while (i_end < lefts.size() && left[lefts[i_end]].reference == reference) { ++i_end; }
+            auto j_end = j;
+            while (j_end < rights.size() && right[rights[j_end]].reference == reference) { ++j_end; }
+            match_by_date(std::span(lefts).subspan(i, i_end - i), std::span(rights).subspan(j, j_end - j), out);
+            i = i_end;
+            j = j_end;
+          }
+        }
+
+        std::erase_if(lefts, [this](std::size_t l) { return 0 != left_matched[l]; });
+        std::erase_if(rights, [this](std::size_t r) { return 0 != right_matched[r]; });
+        if (lefts.empty() || rights.empty()) { return; }
+
+        auto const by_date = [](std::span<ledger_entry const> side)
+        { return [side](std::size_t a, std::size_t b) noexcept { return side[a].date < side[b].date; }; };
+        std::ranges::stable_sort(lefts, by_date(left));
+        std::ranges::stable_sort(rights, by_date(right));
+        match_by_date(lefts, rights, out);
+      }
+
+      [[nodiscard]] static std::size_t partition_of(money amount, std::size_t partitions) noexcept
+      {
+        // splitmix64 finalizer: consecutive amounts must not land in consecutive partitions
+        auto x = std::bit_cast<std::uint64_t>(amount.data());
+        x = (x ^ (x >> 30U)) * 0xBF58'476D'1CE4'E5B9U;
+        x = (x ^ (x >> 27U)) * 0x94D0'49BB'1331'11EBU;
+        x ^= x >> 31U;
+        return static_cast<std::size_t>(x & (partitions - 1));
+      }
+
+      // Scatter the indices of one side into hash partitions of their amount, one bucket list per worker to avoid
+      // synchronization.
+      [[nodiscard]] std::vector<std::vector<std::vector<std::size_t>>> partition(std::span<ledger_entry const> side,
+                                                                                std::size_t partitions) const
+      {
+        std::vector<std::vector<std::vector<std::size_t>>> buckets(workers,
+                                                                   std::vector<std::vector<std::size_t>>(partitions));
+        parallel_chunks(side.size(), workers,
+                        [&](std::size_t w, std::size_t begin, std::size_t end)
+                        {
+                          for (auto i = begin; i < end; ++i)
+                          {
+                            buckets[w][partition_of(side[i].amount, partitions)].push_back(i);
+                          }
+                        });
+        return buckets;
+      }
+
+      void match_exact(std::vector<reconciliation_pair> & out)
+      {
+        auto const partitions = std::bit_ceil(workers * 8);
+        auto const left_buckets = partition(left, partitions);
+        auto const right_buckets = partition(right, partitions);
+
+        std::vector<std::vector<reconciliation_pair>> found(partitions);
+        parallel_chunks(
+            partitions, workers,
+            [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+              std::vector<std::size_t> lefts;
+              std::vector<std::size_t> rights;
+              std::vector<std::size_t> group_left;
+              std::vector<std::size_t> group_right;
+              for (auto p = begin; p < end; ++p)
+              {
+                lefts.clear();
+                rights.clear();
+                for (auto const & local : left_buckets) { lefts.insert(lefts.end(), local[p].begin(), local[p].end()); }
+                for (auto const & local : right_buckets)
+                {
+                  rights.insert(rights.end(), local[p].begin(), local[p].end());
+                }
+                if (lefts.empty() || rights.empty()) { continue; }
+
+                std::ranges::sort(lefts, {}, [this](std::size_t l) { return left[l].amount; });
+                std::ranges::sort(rights, {}, [this](std::size_t r) { return right[r].amount; });
+
+                // walk both sides one amount at a time
+                for (std::size_t i = 0, j = 0; i < lefts.size() && j < rights.size();)
+                {
+                  auto const amount = left[lefts[i]].amount;
+                  if (amount < right[rights[j]].amount) { ++i; }
+                  else if (right[rights[j]].amount < amount) { ++j; }
+                  else
+                  {
+                    group_left.clear();
+                    group_right.clear();
+                    for (; i < lefts.size() && left[lefts[i]].amount == amount; ++i) { group_left.push_back(lefts[i]); }
+                    for (; j < rights.size() && right[rights[j]].amount == amount; ++j)
+                    {
+                      group_right.push_back(rights[j]);
+                    }
+                    match_same_amount(group_left, group_right, found[p]);
+                  }
+                }
+              }
+            });
+
+        for (auto const & local : found) { out.insert(out.end(), local.begin(), local.end()); }
+      }
+
+      [[nodiscard]] static std::vector<std::size_t> unmatched(std::vector<std::uint8_t> const & matched)
+      {
+        std::vector<std::size_t> result;
+        for (std::size_t i = 0; i < matched.size(); ++i)
+        {
+          if (0 == matched[i]) { result.push_back(i); }
+        }
+        return result;
+      }
+
+      // Indices of the unmatched entries of a side sorted by amount.
+      [[nodiscard]] std::vector<std::size_t> sorted_unmatched(std::span<ledger_entry const> side,
+                                                              std::vector<std::uint8_t> const & matched) const
+      {
+        auto indices = unmatched(matched);
+        std::vector<money> amounts(indices.size());
+        for (std::size_t i = 0; i < indices.size(); ++i) { amounts[i] = side[indices[i]].amount; }
+        radix_sort(std::span<money>(amounts), std::span<std::size_t>(indices), options.threads);
+        return indices;
+      }
+
+      void match_approximate(std::vector<reconciliation_pair> & out)
+      {
+        auto const lefts = sorted_unmatched(left, left_matched);
+        auto const rights = sorted_unmatched(right, right_matched);
+        if (lefts.empty() || rights.empty()) { return; }
+
+        auto const tolerance = static_cast<int128_t>(options.amount_tolerance.data());
+        auto const amount_of = [](ledger_entry const & e) { return static_cast<int128_t>(e.amount.data()); };
+
+        // Chunks of rights whose first amounts are more than twice the tolerance apart: chunks k and k + 2 cannot
+        // compete for the same lefts, so even chunks run in parallel, then odd ones.
+        std::vector<std::size_t> starts{0};
+        auto const target = std::max<std::size_t>(1, rights.size() / (workers * 4));
+        while (true)
+        {
+          auto const start = starts.back();
+          auto next = std::min(rights.size(), start + target);
+          auto const limit = amount_of(right[rights[start]]) + 2 * tolerance;
+          while (next < rights.size() && amount_of(right[rights[next]]) <= limit) { ++next; }
+          if (next == rights.size()) { break; }
+          starts.push_back(next);
+        }
+        starts.push_back(rights.size());
+        auto const chunks = starts.size() - 1;
+
+        std::vector<std::vector<reconciliation_pair>> found(chunks);
+        auto const match_chunk = [&](std::size_t c)
+        {
+          for (auto k = starts[c]; k < starts[c + 1]; ++k)
+          {
+            auto const & r = right[rights[k]];
+            auto const target_amount = amount_of(r);
+            auto const first = std::ranges::lower_bound(lefts, target_amount - tolerance, {},
+                                                        [&](std::size_t l) { return amount_of(left[l]); });
+
+            // closest amount among the first unmatched candidates of the window with close enough dates
+            constexpr std::size_t max_scan = 256;
+            std::size_t best = lefts.size();
+            int128_t best_gap = 0;
+            std::size_t scanned = 0;
+            for (auto it = first; it != lefts.end() && scanned < max_scan; ++it, ++scanned)
+            {
+              auto const & l = left[*it];
+              auto const amount = amount_of(l);
+              if (amount > target_amount + tolerance) { break; }
+              if (0 != left_matched[*it] || !close_dates(l, r)) { continue; }
+              auto const gap = amount < target_amount ? target_amount - amount : amount - target_amount;
+              if (best == lefts.size() || gap < best_gap)
+              {
+                best = static_cast<std::size_t>(it - lefts.begin());
+                best_gap = gap;
+              }
+            }
+            if (best != lefts.size()) { pair(lefts[best], rights[k], found[c]); }
+          }
+        };
+
+        for (std::size_t parity = 0; parity < 2; ++parity)
+        {
+          auto const count = (chunks + 1 - parity) / 2;
+          parallel_chunks(count, std::min(workers, count),
+                          [&](std::size_t, std::size_t begin, std::size_t end)
+                          {
+                            for (auto i = begin; i < end; ++i) { match_chunk(2 * i + parity); }
+                          });
+        }
+
+        for (auto const & local : found) { out.insert(out.end(), local.begin(), local.end()); }
+      }
+
+      // Look for a subset of 2 to max_group_size candidates whose amounts sum to target.
+      [[nodiscard]] bool find_subset(std::span<ledger_entry const> side, std::span<std::size_t const> candidates,
+                                     int128_t target, std::size_t first, std::vector<std::size_t> & chosen) const
+      {
+        if (0 == target && chosen.size() >= 2) { return true; }
+        if (chosen.size() == options.max_group_size) { return false; }
+        for (auto i = first; i < candidates.size(); ++i)
+        {
+          chosen.push_back(candidates[i]);
+          if (find_subset(side, candidates, target - side[candidates[i]].amount.data(), i + 1, chosen)) { return true; }
+          chosen.pop_back();
+        }
+        return false;
+      }
+
+      // Match single entries of `one` with several entries of `many` sharing its reference.
+      void match_groups(std::span<ledger_entry const> one, std::span<std::size_t const> singles,
+                        std::vector<std::uint8_t> & one_matched, std::span<ledger_entry const> many,
+                        std::span<std::size_t const> parts, std::vector<std::uint8_t> & many_matched,
+                        bool one_is_right, std::vector<reconciliation_group> & out) const
+      {
+        if (parts.size() > options.max_group_candidates) { return; }
+
+        std::vector<std::size_t> candidates;
+        std::vector<std::size_t> chosen;
+        for (auto const s : singles)
+        {
+          if (0 != one_matched[s]) { continue; }
+          candidates.clear();
+          for (auto const p : parts)
+          {
+            auto const close = one_is_right ? close_dates(many[p], one[s]) : close_dates(one[s], many[p]);
+            if (0 == many_matched[p] && close) { candidates.push_back(p); }
+          }
+          chosen.clear();
+          if (candidates.size() < 2 || !find_subset(many, candidates, one[s].amount.data(), 0, chosen)) { continue; }
+
+          one_matched[s] = 1;
+          for (auto const c : chosen) { many_matched[c] = 1; }
+          if (one_is_right) { out.push_back({.left = chosen, .right = {s}}); }
+          else { out.push_back({.left = {s}, .right = chosen}); }
+        }
+      }
+
+      void match_groups(std::vector<reconciliation_group> & out)
+      {
+        auto lefts = unmatched(left_matched);
+        auto rights = unmatched(right_matched);
+        std::ranges::stable_sort(lefts, {}, [this](std::size_t l) { return left[l].reference; });
+        std::ranges::stable_sort(rights, {}, [this](std::size_t r) { return right[r].reference; });
+
+        // references present on both sides
+        struct span_pair
+        {
+          std::span<std::size_t const> lefts;
+          std::span<std::size_t const> rights;
+        };
+        std::vector<span_pair> references;
+        for (std::size_t i = 0, j = 0; i < lefts.size() && j < rights.size();)
+        {
+          auto const reference = left[lefts[i]].reference;
+          if (reference < right[rights[j]].reference) { ++i; }
+          else if (right[rights[j]].reference < reference) { ++j; }
+          else
+          {
+            auto i_end = i;
+            while (i_end < lefts.size() && left[lefts[i_end]].reference == reference) { ++i_end; }
+            auto j_end = j;
+            while (j_end < rights.size() && right[rights[j_end]].reference == reference) { ++j_end; }
+            references.push_back({std::span(lefts).subspan(i, i_end - i), std::span(rights).subspan(j, j_end - j)});
+            i = i_end;
+            j = j_end;
+          }
+        }
+
+        // references involve disjoint entries: no synchronization needed
+        std::vector<std::vector<reconciliation_group>> found(workers);
+        parallel_chunks(references.size(), workers,
+                        [&](std::size_t w, std::size_t begin, std::size_t end)
+                        {
+                          for (auto i = begin; i < end; ++i)
+                          {
+                            auto const & [ls, rs] = references[i];
+                            match_groups(right, rs, right_matched, left, ls, left_matched, true, found[w]);
+                            match_groups(left, ls, left_matched, right, rs, right_matched, false, found[w]);
+                          }
+                        });
+
+        for (auto & local : found) { std::ranges::move(local, std::back_inserter(out)); }
+      }
+    };
+  } // namespace detail
+
+  // Match the entries of two ledgers. Entries are paired, in this order:
+  //   1. with an entry of the same amount and dates within the tolerance, preferably with the same reference;
+  //   2. with an entry whose amount is within the amount tolerance and dates within the date tolerance;
+  //   3. with 2 to max_group_size entries of the other side sharing its reference, close dates and summing exactly.
+  [[nodiscard]] inline reconciliation_result reconcile(std::span<ledger_entry const> left,
+                                                       std::span<ledger_entry const> right,
+                                                       reconciliation_options const & options = {})
+  {
+    constexpr std::size_t grain = std::size_t{1} << 14U;
+    detail::reconciler engine{.left = left,
+                              .right = right,
+                              .options = options,
+                              .workers = detail::worker_count(std::max(left.size(), right.size()), grain,
+                                                              options.threads)};
+
+    reconciliation_result result;
+    engine.match_exact(result.exact);
+    if (options.amount_tolerance > money{0}) { engine.match_approximate(result.approximate); }
+    if (options.max_group_size >= 2) { engine.match_groups(result.groups); }
+
+    auto const by_right = [](reconciliation_pair const & p) { return p.right; };
+    std::ranges::sort(result.exact, {}, by_right);
+    std::ranges::sort(result.approximate, {}, by_right);
+    std::ranges::sort(result.groups, {}, [](reconciliation_group const & g) { return g.right.front(); });
+
+    result.unmatched_left = detail::reconciler::unmatched(engine.left_matched);
+    result.unmatched_right = detail::reconciler::unmatched(engine.right_matched);
+    return result;
+  }
+} // namespace io1
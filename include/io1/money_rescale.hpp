@@ -0,0 +1,135 @@
+#pragma once
+
+#include "io1/money_core.hpp"
+#include "io1/money_rounding.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace io1
+{
+  namespace detail
+  {
+    template <unsigned Digits>
+    inline constexpr std::int64_t pow10_v = 10 * pow10_v<Digits - 1>;
+
+    template <>
+    inline constexpr std::int64_t pow10_v<0> = 1;
+
+    // The power of ten between the two scales must fit in Int: 10^9 at most for 32-bit amounts.
+    template <unsigned FromDigits, unsigned ToDigits, class Int = money::value_type>
+    concept rescalable = FromDigits <= 18 && ToDigits <= 18 &&
+                         (FromDigits > ToDigits ? FromDigits - ToDigits : ToDigits - FromDigits) <=
+                             static_cast<unsigned>(std::numeric_limits<Int>::digits10);
+
+    // Scaling up overflows outside of [lowest, highest].
+    template <unsigned FromDigits, unsigned ToDigits, class Int>
+    struct rescale_range
+    {
+      static constexpr Int factor = ToDigits > FromDigits ? static_cast<Int>(pow10_v<ToDigits - FromDigits>) : 1;
+      static constexpr Int lowest = std::numeric_limits<Int>::lowest() / factor;
+      static constexpr Int highest = std::numeric_limits<Int>::max() / factor;
+    };
+
+    // Kernels with the rounding mode known at compile time: the division by a constant power of ten becomes a
+    // multiplication and the rounding adjustment is branchless.
+    template <unsigned FromDigits, unsigned ToDigits, rounding Mode>
+    void rescale_down(money const * in, money * out, std::size_t size) noexcept
+    {
+      constexpr auto divisor = pow10_v<FromDigits - ToDigits>;
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        out[i] = money{divide_rounded<money::value_type>(in[i].data(), divisor, Mode)};
+      }
+    }
+
+    template <unsigned FromDigits, unsigned ToDigits>
+    void rescale_up(money const * in, money * out, std::size_t size) noexcept
+    {
+      constexpr auto factor = pow10_v<ToDigits - FromDigits>;
+      for (std::size_t i = 0; i < size; ++i) { out[i] = money{in[i].data() * factor}; }
+    }
+  } // namespace detail
+
+  // Amount of minor units with FromDigits fractional digits expressed with ToDigits fractional digits, e.g. cents to
+  // mills with rescale<2, 3>. Throws std::overflow_error if scaling up overflows.
+  template <unsigned FromDigits, unsigned ToDigits, class Int>
+    requires detail::rescalable<FromDigits, ToDigits, Int>
+  [[nodiscard]] constexpr basic_money<Int> rescale(basic_money<Int> amount, rounding mode = rounding::half_even)
+  {
+    if constexpr (FromDigits > ToDigits)
+    {
+      constexpr auto divisor = static_cast<Int>(detail::pow10_v<FromDigits - ToDigits>);
+      return basic_money<Int>{detail::divide_rounded<Int>(amount.data(), divisor, mode)};
+    }
+    else
+    {
+      using range = detail::rescale_range<FromDigits, ToDigits, Int>;
+      if (amount.data() < range::lowest || amount.data() > range::highest)
+      {
+        throw std::overflow_error("io1::rescale: result out of range.");
+      }
+      return basic_money<Int>{static_cast<Int>(amount.data() * range::factor)};
+    }
+  }
+
+  // Rescale a column of amounts into out, which may be the same span. Throws std::overflow_error, with nothing
+  // written, if scaling up one of them overflows.
+  template <unsigned FromDigits, unsigned ToDigits>
+    requires detail::rescalable<FromDigits, ToDigits>
+  void rescale(std::span<money const> amounts, std::span<money> out, rounding mode = rounding::half_even)
+  {
+    assert(amounts.size() == out.size() && "Each amount must have a destination.");
+
+    auto const * const in = amounts.data();
+    auto const size = amounts.size();
+    if constexpr (FromDigits > ToDigits)
+    {
+      using enum rounding;
+      switch (mode)
+      {
+      case toward_zero: return detail::rescale_down<FromDigits, ToDigits, toward_zero>(in, out.data(), size);
+      case away_from_zero: return detail::rescale_down<FromDigits, ToDigits, away_from_zero>(in, out.data(), size);
+      case floor: return detail::rescale_down<FromDigits, ToDigits, floor>(in, out.data(), size);
+      case ceiling: return detail::rescale_down<FromDigits, ToDigits, ceiling>(in, out.data(), size);
+      case half_down: return detail::rescale_down<FromDigits, ToDigits, half_down>(in, out.data(), size);
+      case half_up: return detail::rescale_down<FromDigits, ToDigits, half_up>(in, out.data(), size);
+      case half_even: return detail::rescale_down<FromDigits, ToDigits, half_even>(in, out.data(), size);
+      }
+    }
+    else
+    {
+      // a branchless range check first: both loops vectorize
+      using range = detail::rescale_range<FromDigits, ToDigits, money::value_type>;
+      auto lowest = std::numeric_limits<money::value_type>::max();
+      auto highest = std::numeric_limits<money::value_type>::lowest();
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        auto const v = in[i].data();
+        lowest = v < lowest ? v : lowest;
+        highest = v > highest ? v : highest;
+      }
+      if (0 < size && (lowest < range::lowest || highest > range::highest))
+      {
+        std::size_t i = 0;
+        while (in[i].data() >= range::lowest && in[i].data() <= range::highest) { ++i; }
+        throw std::overflow_error("io1::rescale: amount at index " + std::to_string(i) + " out of range.");
+      }
+
+      detail::rescale_up<FromDigits, ToDigits>(in, out.data(), size);
+    }
+  }
+
+  template <unsigned FromDigits, unsigned ToDigits>
+    requires detail::rescalable<FromDigits, ToDigits>
+  void rescale(std::span<money> amounts, rounding mode = rounding::half_even)
+  {
+    rescale<FromDigits, ToDigits>(amounts, amounts, mode);
+  }
+} // namespace io1
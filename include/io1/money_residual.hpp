@@ -0,0 +1,323 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_rounding.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace io1
+{
+  // Residuals are fixed-point fractions of a minor unit with 64 fractional bits: residual_unit is one minor unit.
+  inline constexpr money128::value_type residual_unit = money128::value_type{1} << 64U;
+
+  struct scaled_money
+  {
+    money amount;                  // rounded
+    money128::value_type residual; // exact product minus amount, in 1 / residual_unit of a minor unit
+
+    [[nodiscard]] friend bool operator==(scaled_money const &, scaled_money const &) noexcept = default;
+  };
+
+  namespace detail
+  {
+    // A finite factor as (negative ? -1 : 1) * mantissa * 2^exponent, with an odd mantissa unless it is 0.
+    struct binary_factor
+    {
+      std::uint64_t mantissa;
+      int exponent;
+      bool negative;
+    };
+
+    template <std::floating_point T>
+    [[nodiscard]] inline binary_factor decompose(T factor) noexcept
+    {
+      assert(std::isfinite(factor) && "Only finite factors have a binary decomposition.");
+      binary_factor result{.mantissa = 0, .exponent = 0, .negative = std::signbit(factor)};
+      if constexpr (std::numeric_limits<T>::digits <= std::numeric_limits<double>::digits &&
+                    std::numeric_limits<double>::is_iec559)
+      {
+        // exact conversion, and the fields of a binary64 read without a call
+        auto const bits = std::bit_cast<std::uint64_t>(static_cast<double>(factor));
+        auto const biased = static_cast<int>((bits >> 52U) & 0x7FFU);
+        auto const fraction = bits & ((std::uint64_t{1} << 52U) - 1);
+        result.mantissa = 0 != biased ? fraction | (std::uint64_t{1} << 52U) : fraction;
+        result.exponent = std::max(biased, 1) - 1'075;
+      }
+      else
+      {
+        static_assert(std::numeric_limits<T>::digits <= 64, "Mantissas are 64-bit at most.");
+        int exponent = 0;
+        auto const fraction = std::frexp(std::fabs(factor), &exponent); // in [0.5, 1)
+        result.mantissa = static_cast<std::uint64_t>(std::ldexp(fraction, std::numeric_limits<T>::digits));
+        result.exponent = exponent - std::numeric_limits<T>::digits;
+      }
+
+      if (0 == result.mantissa) { result.exponent = 0; }
+      else
+      {
+        auto const zeros = std::countr_zero(result.mantissa);
+        result.mantissa >>= static_cast<unsigned>(zeros);
+        result.exponent += zeros;
+      }
+      return result;
+    }
+
+    struct scale_result
+    {
+      money::value_type amount;
+      int128_t residual;
+      bool overflow;
+    };
+
+    // The exact product is |amount| * mantissa, below 2^127, shifted by the exponent: it is rounded on the magnitude,
+    // and the bits shifted out make the residual.
+    template <rounding Mode>
+    [[nodiscard]] constexpr scale_result scale(money::value_type amount, binary_factor factor) noexcept
+    {
+      auto const negative = (amount < 0) != factor.negative;
+      auto const product = static_cast<uint128_t>(amount < 0 ? std::uint64_t{0} - static_cast<std::uint64_t>(amount)
+                                                             : static_cast<std::uint64_t>(amount)) *
+                           factor.mantissa;
+      // magnitudes up to 2^63 are representable when negative
+      auto const limit = static_cast<uint128_t>(std::numeric_limits<money::value_type>::max()) +
+                         static_cast<uint128_t>(negative);
+      // signs are applied without branches: they are as unpredictable as the amounts
+      auto const sign_mask = std::uint64_t{0} - static_cast<std::uint64_t>(negative);
+      auto const signed_amount = [sign_mask](uint128_t magnitude)
+      { return static_cast<money::value_type>((static_cast<std::uint64_t>(magnitude) ^ sign_mask) - sign_mask); };
+
+      if (0 <= factor.exponent)
+      {
+        auto const shift = static_cast<unsigned>(factor.exponent);
+        auto const overflow = 0 != product && (64 <= shift || product > (limit >> shift));
+        // a shift of 64 or more leaves no room but for a zero product, whose shift could exceed the width
+        return {.amount = overflow || 64 <= shift ? 0 : signed_amount(product << shift), .residual = 0,
+                .overflow = overflow};
+      }
+
+      // whether the magnitude of the quotient is rounded up, given the remainder and its comparison with a half
+      auto const away = [negative](bool inexact, bool above_half, bool tie, bool odd) -> bool
+      {
+        switch (Mode)
+        {
+        case rounding::toward_zero: return false;
+        case rounding::away_from_zero: return inexact;
+        case rounding::floor: return negative & inexact;
+        case rounding::ceiling: return !negative & inexact;
+        case rounding::half_down: return above_half;
+        case rounding::half_up: return above_half | tie;
+        case rounding::half_even: break;
+        }
+        return above_half | (tie & odd);
+      };
+      auto const result = [sign_mask, limit, &signed_amount](uint128_t quotient, bool up, uint128_t fraction)
+      {
+        auto const magnitude = quotient + static_cast<uint128_t>(up);
+        auto const overflow = magnitude > limit;
+        auto const residual = static_cast<uint128_t>(fraction) - (static_cast<uint128_t>(up) << 64U);
+        auto const mask = static_cast<uint128_t>(static_cast<int128_t>(static_cast<std::int64_t>(sign_mask)));
+        return scale_result{.amount = overflow ? 0 : signed_amount(magnitude),
+                            .residual = static_cast<int128_t>((residual ^ mask) - mask),
+                            .overflow = overflow};
+      };
+
+      auto const shift = static_cast<unsigned>(-factor.exponent);
+      if (shift <= 64)
+      {
+        // all factors of magnitude 2^-11 or more: the remainder and the fraction have 64 bits
+        auto const quotient = product >> shift;
+        auto const remainder = static_cast<std::uint64_t>(product) & (~std::uint64_t{0} >> (64 - shift));
+        auto const half = std::uint64_t{1} << (shift - 1);
+        auto const up = away(0 != remainder, remainder > half, remainder == half, 0 != (quotient & 1U));
+        return result(quotient, up, remainder << (64 - shift));
+      }
+
+      // the bits below 2^-64 are rounded to nearest, and the product is below 2^127: nothing is above a half of 2^128
+      auto const quotient = shift < 128 ? product >> shift : uint128_t{0};
+      auto const remainder = shift < 128 ? product & ((uint128_t{1} << shift) - 1) : product;
+      auto const half = shift < 128 ? uint128_t{1} << (shift - 1) : ~uint128_t{0};
+      auto const up = away(0 != remainder, remainder > half, remainder == half, 0 != (quotient & 1U));
+      auto const drop = shift - 64;
+      auto const fraction = drop < 128 ? (remainder >> drop) + ((remainder >> (drop - 1)) & 1U) : uint128_t{0};
+      return result(quotient, up, fraction);
+    }
+
+    template <class F>
+    decltype(auto) with_rounding(rounding mode, F && f)
+    {
+      using enum rounding;
+      switch (mode)
+      {
+      case toward_zero: return f.template operator()<toward_zero>();
+      case away_from_zero: return f.template operator()<away_from_zero>();
+      case floor: return f.template operator()<floor>();
+      case ceiling: return f.template operator()<ceiling>();
+      case half_down: return f.template operator()<half_down>();
+      case half_up: return f.template operator()<half_up>();
+      case half_even: break;
+      }
+      return f.template operator()<half_even>();
+    }
+
+    template <std::floating_point T>
+    [[nodiscard]] inline binary_factor checked_factor(T factor)
+    {
+      if (!std::isfinite(factor)) { throw std::invalid_argument("io1::scale: factor is not finite."); }
+      return decompose(factor);
+    }
+  } // namespace detail
+
+  // amount * factor rounded according to mode, with the exact residual of the rounding. The exact product is rounded:
+  // operator* rounds a long double product, itself rounded once |amount| times the mantissa of the factor exceeds 64
+  // bits, and may then differ by one unit on near ties. Residuals are exact when the factor is a multiple of 2^-64, as
+  // are all doubles of magnitude 2^-11 or more, and rounded to the nearest 2^-64 otherwise.
+  //
+  // Throws std::invalid_argument if the factor is not finite and std::overflow_error if the result is out of range.
+  template <std::floating_point T>
+  [[nodiscard]] inline scaled_money scale(money amount, T factor, rounding mode = rounding::half_even)
+  {
+    auto const f = detail::checked_factor(factor);
+    auto const result = detail::with_rounding(
+        mode, [&]<rounding Mode>() noexcept { return detail::scale<Mode>(amount.data(), f); });
+    if (result.overflow) { throw std::overflow_error("io1::scale: result out of range."); }
+    return {.amount = money{result.amount}, .residual = result.residual};
+  }
+
+  // Scale a column of amounts by the same factor into out, which may be the same span, on `threads` workers (one per
+  // hardware thread if 0), and return the sum of the residuals. Throws like (1), with nothing written.
+  template <std::floating_point T>
+  money128::value_type scale(std::span<money const> amounts, T factor, std::span<money> out,
+                             rounding mode = rounding::half_even, std::size_t threads = 0)
+  {
+    assert(amounts.size() == out.size() && "Each amount must have a destination.");
+    auto const f = detail::checked_factor(factor);
+    auto const * const in = amounts.data();
+    auto const size = amounts.size();
+
+    return detail::with_rounding(
+        mode,
+        [&]<rounding Mode>()
+        {
+          // the product is monotonic in the amount: the extreme amounts bound the results
+          auto lowest = std::numeric_limits<money::value_type>::max();
+          auto highest = std::numeric_limits<money::value_type>::lowest();
+          for (std::size_t i = 0; i < size; ++i)
+          {
+            auto const v = in[i].data();
+            lowest = v < lowest ? v : lowest;
+            highest = v > highest ? v : highest;
+          }
+          if (0 < size && (detail::scale<Mode>(lowest, f).overflow || detail::scale<Mode>(highest, f).overflow))
+          {
+            std::size_t i = 0;
+            while (!detail::scale<Mode>(in[i].data(), f).overflow) { ++i; }
+            throw std::overflow_error("io1::scale: amount at index " + std::to_string(i) + " out of range.");
+          }
+
+          constexpr std::size_t grain = std::size_t{1} << 14U;
+          auto const workers = detail::worker_count(size, grain, threads);
+          std::vector<money128::value_type> totals(workers, 0);
+          detail::parallel_chunks(size, workers,
+                                  [&](std::size_t w, std::size_t begin, std::size_t end) noexcept
+                                  {
+                                    money128::value_type total = 0;
+                                    for (auto i = begin; i < end; ++i)
+                                    {
+                                      auto const result = detail::scale<Mode>(in[i].data(), f);
+                                      out[i] = money{result.amount};
+                                      total += result.residual;
+                                    }
+                                    totals[w] = total;
+                                  });
+
+          money128::value_type total = 0;
+          for (auto const t : totals) { total += t; }
+          return total;
+        });
+  }
+
+  // Scale amounts[i] by factors[i] into out[i], which may be amounts, and add its residual to residuals[groups[i]],
+  // on `threads` workers (one per hardware thread if 0).
+  //
+  // Throws std::invalid_argument, with nothing written, for a factor that is not finite or a group without residual,
+  // and std::overflow_error if a result is out of range: residuals are then untouched, but out holds the results,
+  // and 0 for those out of range.
+  template <std::floating_point T>
+  void scale(std::span<money const> amounts, std::span<T const> factors, std::span<std::uint32_t const> groups,
+             std::span<money> out, std::span<money128::value_type> residuals, rounding mode = rounding::half_even,
+             std::size_t threads = 0)
+  {
+    assert(amounts.size() == factors.size() && amounts.size() == groups.size() && amounts.size() == out.size() &&
+           "Each amount must have a factor, a group and a destination.");
+    auto const size = amounts.size();
+
+    // branchless checks first: both loops vectorize
+    std::uint32_t last_group = 0;
+    bool finite = true;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      last_group = std::max(last_group, groups[i]);
+      finite &= std::isfinite(factors[i]);
+    }
+    if (0 < size && last_group >= residuals.size())
+    {
+      auto const i = static_cast<std::size_t>(
+          std::ranges::find_if(groups, [&](std::uint32_t g) { return g >= residuals.size(); }) - groups.begin());
+      throw std::invalid_argument("io1::scale: unknown group " + std::to_string(groups[i]) + " at index " +
+                                  std::to_string(i) + ".");
+    }
+    if (!finite)
+    {
+      auto const i = static_cast<std::size_t>(
+          std::ranges::find_if(factors, [](T f) { return !std::isfinite(f); }) - factors.begin());
+      throw std::invalid_argument("io1::scale: factor at index " + std::to_string(i) + " is not finite.");
+    }
+
+    constexpr std::size_t grain = std::size_t{1} << 14U;
+    auto const workers = detail::worker_count(size, grain, threads);
+    std::vector<std::vector<money128::value_type>> partials(workers);
+    std::vector<std::size_t> overflows(workers, size);
+    detail::with_rounding(mode,
+                          [&]<rounding Mode>()
+                          {
+                            detail::parallel_chunks(
+                                size, workers,
+                                [&](std::size_t w, std::size_t begin, std::size_t end)
+                                {
+                                  auto & partial = partials[w];
+                                  partial.assign(residuals.size(), 0);
+                                  // out may be amounts: the first overflow is recorded as it is found
+                                  for (auto i = begin; i < end; ++i)
+                                  {
+                                    auto const result =
+                                        detail::scale<Mode>(amounts[i].data(), detail::decompose(factors[i]));
+                                    out[i] = money{result.amount};
+                                    partial[groups[i]] += result.residual;
+                                    if (result.overflow && overflows[w] == size) { overflows[w] = i; }
+                                  }
+                                });
+                          });
+
+    if (auto const first = std::ranges::min(overflows); first != size)
+    {
+      throw std::overflow_error("io1::scale: amount at index " + std::to_string(first) + " out of range.");
+    }
+    for (auto const & partial : partials)
+    {
+      for (std::size_t g = 0; g < residuals.size(); ++g) { residuals[g] += partial[g]; }
+    }
+  }
+} // namespace io1
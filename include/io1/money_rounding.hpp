@@ -0,0 +1,94 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/money_core.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace io1
+{
+  enum class rounding
+  {
+    toward_zero,
+    away_from_zero,
+    floor,
+    ceiling,
+    half_down, // ties toward zero
+    half_up,   // ties away from zero, the school rounding
+    half_even  // ties to the even neighbor, the banker's rounding
+  };
+
+  namespace detail
+  {
+    // numerator / denominator rounded according to mode. The denominator must be positive. Branchless once the mode
+    // is known: loops over a constant mode vectorize or at least do not mispredict.
+    template <class Int>
+    [[nodiscard]] constexpr Int divide_rounded(Int numerator, Int denominator, rounding mode) noexcept
+    {
+      assert(denominator > 0 && "The sign is carried by the numerator.");
+      auto const quotient = static_cast<Int>(numerator / denominator);
+      auto const remainder = static_cast<Int>(numerator % denominator);
+
+      // remainder has the sign of the numerator: the exact result lies between quotient and quotient + step
+      auto const step = static_cast<Int>(remainder < 0 ? -1 : 1);
+      auto const magnitude = static_cast<Int>(remainder < 0 ? -remainder : remainder);
+      // compare 2 * |remainder| with the denominator without overflowing
+      auto const tie = magnitude == denominator - magnitude;
+      auto const above_half = magnitude > denominator - magnitude;
+
+      bool away = false;
+      switch (mode)
+      {
+      case rounding::toward_zero: break;
+      case rounding::away_from_zero: away = 0 != magnitude; break;
+      case rounding::floor: away = remainder < 0; break;
+      case rounding::ceiling: away = remainder > 0; break;
+      case rounding::half_down: away = above_half; break;
+      case rounding::half_up: away = above_half | tie; break;
+      case rounding::half_even: away = above_half | (tie & (0 != (quotient & 1))); break;
+      }
+      return static_cast<Int>(quotient + step * static_cast<Int>(away));
+    }
+
+    [[nodiscard]] constexpr bool fits_money(int128_t value) noexcept
+    {
+      return std::numeric_limits<money::value_type>::lowest() <= value &&
+             value <= std::numeric_limits<money::value_type>::max();
+    }
+
+    // amount * numerator / denominator, rounded, with a 64-bit division whenever the product fits in 64 bits.
+    [[nodiscard]] constexpr money::value_type muldiv(money::value_type amount, std::int64_t numerator,
+                                                     std::int64_t denominator, rounding mode)
+    {
+      assert(0 != denominator && "Division by zero is undefined behavior.");
+      // the signs are moved in 128 bits, where the lowest 64-bit terms have an opposite
+      auto product = static_cast<int128_t>(amount) * numerator;
+      int128_t divisor = denominator;
+      if (divisor < 0)
+      {
+        product = -product;
+        divisor = -divisor;
+      }
+
+      if (fits_money(product) && fits_money(divisor))
+      {
+        return divide_rounded(static_cast<money::value_type>(product), static_cast<money::value_type>(divisor), mode);
+      }
+
+      auto const result = divide_rounded<int128_t>(product, divisor, mode);
+      if (!fits_money(result)) { throw std::overflow_error("io1::muldiv: result out of range."); }
+      return static_cast<money::value_type>(result);
+    }
+  } // namespace detail
+
+  // Exact amount * numerator / denominator, rounded according to mode. The intermediate product has 128 bits: only a
+  // result out of the range of io1::money throws std::overflow_error.
+  [[nodiscard]] constexpr money muldiv(money amount, std::int64_t numerator, std::int64_t denominator,
+                                       rounding mode = rounding::half_even)
+  {
+    return money{detail::muldiv(amount.data(), numerator, denominator, mode)};
+  }
+} // namespace io1
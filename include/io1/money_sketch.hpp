@@ -0,0 +1,302 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace io1
+{
+  namespace detail
+  {
+    // Exact summary shared by the sketches: count, min, max and a sum that cannot overflow.
+    struct money_summary
+    {
+      std::uint64_t count{0};
+      money::value_type min{std::numeric_limits<money::value_type>::max()};
+      money::value_type max{std::numeric_limits<money::value_type>::lowest()};
+      int128_t sum{0};
+
+      constexpr void insert(money::value_type v, std::uint64_t n = 1) noexcept
+      {
+        count += n;
+        min = std::min(min, v);
+        max = std::max(max, v);
+        sum += static_cast<int128_t>(v) * static_cast<int128_t>(n);
+      }
+
+      constexpr void merge(money_summary const & o) noexcept
+      {
+        count += o.count;
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+        sum += o.sum;
+      }
+    };
+
+    // Rank, counted from 1, of the q-quantile among n values: the smallest value with at least ceil(q * n) values below
+    // or equal to it.
+    [[nodiscard]] inline std::uint64_t quantile_rank(double q, std::uint64_t n) noexcept
+    {
+      assert(0. <= q && q <= 1. && "Quantiles are within [0, 1].");
+      auto const rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(n)));
+      return std::clamp<std::uint64_t>(rank, 1, n);
+    }
+  } // namespace detail
+
+  // Log-linear histogram (HDR style). Amounts whose magnitude is below 2^SignificantBits are counted exactly, larger
+  // ones are grouped in buckets whose width is at most 2^(1-SignificantBits) of their value.
+  template <unsigned SignificantBits = 8>
+  class money_histogram
+  {
+    static_assert(2 <= SignificantBits && SignificantBits <= 16, "Unreasonable precision.");
+
+  public:
+    using sum_type = detail::int128_t;
+
+    static constexpr std::size_t exact_range = std::size_t{1} << SignificantBits;
+    static constexpr std::size_t half_range = exact_range / 2;
+    static constexpr std::size_t buckets_per_sign = exact_range + (64 - SignificantBits) * half_range;
+
+    money_histogram() : positive_(buckets_per_sign, 0), negative_(buckets_per_sign, 0) {}
+
+    void insert(money m, std::uint64_t n = 1) noexcept
+    {
+      auto const v = m.data();
+      summary_.insert(v, n);
+      if (v < 0) { negative_[bucket(magnitude(v))] += n; }
+      else { positive_[bucket(static_cast<std::uint64_t>(v))] += n; }
+    }
+
+    void insert(std::span<money const> values) noexcept
+    {
+      for (auto const m : values) { insert(m); }
+    }
+
+    money_histogram & merge(money_histogram const & o) noexcept
+    {
+      summary_.merge(o.summary_);
+      for (std::size_t i = 0; i < buckets_per_sign; ++i)
+      {
+        positive_[i] += o.positive_[i];
+        negative_[i] += o.negative_[i];
+      }
+      return *this;
+    }
+
+    [[nodiscard]] std::uint64_t count() const noexcept { return summary_.count; }
+    [[nodiscard]] bool empty() const noexcept { return 0 == summary_.count; }
+    [[nodiscard]] money min() const noexcept { return money{summary_.min}; }
+    [[nodiscard]] money max() const noexcept { return money{summary_.max}; }
+    [[nodiscard]] sum_type sum() const noexcept { return summary_.sum; }
+
+    // Approximation of the q-quantile: the middle of the bucket that holds it, clamped by the exact min and max.
+    [[nodiscard]] money quantile(double q) const noexcept
+    {
+      assert(!empty() && "No quantile without values.");
+      auto const rank = detail::quantile_rank(q, summary_.count);
+      std::uint64_t seen = 0;
+
+      for (auto i = buckets_per_sign; i-- > 0;)
+      {
+        seen += negative_[i];
+        if (seen >= rank) { return clamp(-representative(i)); }
+      }
+      for (std::size_t i = 0; i < buckets_per_sign; ++i)
+      {
+        seen += positive_[i];
+        if (seen >= rank) { return clamp(representative(i)); }
+      }
+      return max();
+    }
+
+  private:
+    [[nodiscard]] static constexpr std::uint64_t magnitude(money::value_type v) noexcept
+    {
+      return std::uint64_t{0} - static_cast<std::uint64_t>(v);
+    }
+
+    [[nodiscard]] static constexpr std::size_t bucket(std::uint64_t u) noexcept
+    {
+      if (u < exact_range) { return static_cast<std::size_t>(u); }
+      auto const shift = static_cast<std::size_t>(std::bit_width(u)) - SignificantBits;
+      auto const mantissa = static_cast<std::size_t>(u >> shift);
+      return exact_range + (shift - 1) * half_range + (mantissa - half_range);
+    }
+
+    // Middle of the bucket, as a signed 128-bit integer since the last buckets go beyond the range of money.
+    [[nodiscard]] static constexpr detail::int128_t representative(std::size_t index) noexcept
+    {
+      if (index < exact_range) { return static_cast<detail::int128_t>(index); }
+      auto const shift = (index - exact_range) / half_range + 1;
+      auto const mantissa = (index - exact_range) % half_range + half_range;
+      auto const lower = static_cast<detail::int128_t>(mantissa) << shift;
+      return lower + ((static_cast<detail::int128_t>(1) << shift) - 1) / 2;
+    }
+
+    [[nodiscard]] money clamp(detail::int128_t v) const noexcept
+    {
+      return money{static_cast<money::value_type>(std::clamp<detail::int128_t>(v, summary_.min, summary_.max))};
+    }
+
+    detail::money_summary summary_;
+    std::vector<std::uint64_t> positive_;
+    std::vector<std::uint64_t> negative_;
+  };
+
+  // KLL quantile sketch: a hierarchy of compactors where each item of level h stands for 2^h inserted amounts. Memory
+  // is O(K) and the rank error is about 1.7 / K of the count with high probability.
+  template <std::size_t K = 200>
+  class money_kll_sketch
+  {
+    static_assert(8 <= K, "Too few items per level.");
+
+  public:
+    using sum_type = detail::int128_t;
+
+    explicit money_kll_sketch(std::uint64_t seed = 0x9E37'79B9'7F4A'7C15) noexcept : random_(seed | 1) {}
+
+    void insert(money m)
+    {
+      summary_.insert(m.data());
+      if (levels_.empty()) { levels_.emplace_back(); }
+      levels_.front().push_back(m.data());
+      if (++size_ >= capacity_) { compress(); }
+    }
+
+    void insert(std::span<money const> values)
+    {
+      for (auto const m : values) { insert(m); }
+    }
+
+    money_kll_sketch & merge(money_kll_sketch const & o)
+    {
+      summary_.merge(o.summary_);
+      if (levels_.size() < o.levels_.size()) { levels_.resize(o.levels_.size()); }
+      for (std::size_t h = 0; h < o.levels_.size(); ++h)
+      {
+        levels_[h].insert(levels_[h].end(), o.levels_[h].begin(), o.levels_[h].end());
+      }
+      size_ += o.size_;
+      update_capacity();
+      while (size_ >= capacity_) { compress(); }
+      return *this;
+    }
+
+    [[nodiscard]] std::uint64_t count() const noexcept { return summary_.count; }
+    [[nodiscard]] bool empty() const noexcept { return 0 == summary_.count; }
+    [[nodiscard]] money min() const noexcept { return money{summary_.min}; }
+    [[nodiscard]] money max() const noexcept { return money{summary_.max}; }
+    [[nodiscard]] sum_type sum() const noexcept { return summary_.sum; }
+
+    // Number of amounts retained by the sketch.
+    [[nodiscard]] std::size_t retained() const noexcept { return size_; }
+
+    [[nodiscard]] money quantile(double q) const
+    {
+      assert(!empty() && "No quantile without values.");
+      if (q <= 0.) { return min(); }
+      if (q >= 1.) { return max(); }
+
+      std::vector<std::pair<money::value_type, std::uint64_t>> weighted;
+      weighted.reserve(size_);
+      for (std::size_t h = 0; h < levels_.size(); ++h)
+      {
+        for (auto const v : levels_[h]) { weighted.emplace_back(v, std::uint64_t{1} << h); }
+      }
+      std::ranges::sort(weighted, {}, &std::pair<money::value_type, std::uint64_t>::first);
+
+      std::uint64_t total = 0;
+      for (auto const & item : weighted) { total += item.second; }
+      auto const rank = detail::quantile_rank(q, total);
+
+      std::uint64_t seen = 0;
+      for (auto const & [v, weight] : weighted)
+      {
+        seen += weight;
+        if (seen >= rank) { return money{v}; }
+      }
+      return max();
+    }
+
+  private:
+    // Capacity of level h among `depth` levels: the top level holds K items, each level below 2/3 of the one above.
+    [[nodiscard]] static std::size_t level_capacity(std::size_t h, std::size_t depth) noexcept
+    {
+      auto const scaled = static_cast<double>(K) * std::pow(2. / 3., static_cast<double>(depth - h - 1));
+      return std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(scaled)));
+    }
+
+    void update_capacity() noexcept
+    {
+      capacity_ = 0;
+      for (std::size_t h = 0; h < levels_.size(); ++h) { capacity_ += level_capacity(h, levels_.size()); }
+    }
+
+    // Halve the first level over its capacity: sort it and promote every other item, starting at a random parity.
+    void compress()
+    {
+      for (std::size_t h = 0; h < levels_.size(); ++h)
+      {
+        if (levels_[h].size() < level_capacity(h, levels_.size())) { continue; }
+        if (h + 1 == levels_.size()) { levels_.emplace_back(); }
+
+        auto & level = levels_[h];
+        std::ranges::sort(level);
+        auto const odd = level.size() % 2;
+        auto const kept = odd ? level.back() : money::value_type{0};
+        auto const pairs = level.size() - odd;
+
+        auto & above = levels_[h + 1];
+        for (auto i = static_cast<std::size_t>(next_random() & 1U); i < pairs; i += 2) { above.push_back(level[i]); }
+        size_ -= pairs / 2;
+
+        level.clear();
+        if (odd) { level.push_back(kept); }
+        break;
+      }
+      update_capacity();
+    }
+
+    [[nodiscard]] std::uint64_t next_random() noexcept
+    {
+      // xorshift64: reproducible and cheap, statistical quality is not an issue for picking a parity
+      random_ ^= random_ << 13U;
+      random_ ^= random_ >> 7U;
+      random_ ^= random_ << 17U;
+      return random_;
+    }
+
+    detail::money_summary summary_;
+    std::vector<std::vector<money::value_type>> levels_;
+    std::size_t size_{0};
+    std::size_t capacity_{level_capacity(0, 1)};
+    std::uint64_t random_;
+  };
+
+  // Build a sketch of `values` by sketching chunks on `threads` workers (one per hardware thread if 0) and merging
+  // the results.
+  template <class Sketch>
+  [[nodiscard]] Sketch make_sketch(std::span<money const> values, std::size_t threads = 0)
+  {
+    constexpr std::size_t grain = std::size_t{1} << 16U;
+    auto const workers = detail::worker_count(values.size(), grain, threads);
+
+    std::vector<Sketch> partials(workers);
+    detail::parallel_chunks(values.size(), workers, [&](std::size_t w, std::size_t begin, std::size_t end)
+                            { partials[w].insert(values.subspan(begin, end - begin)); });
+
+    for (std::size_t w = 1; w < workers; ++w) { partials.front().merge(partials[w]); }
+    return std::move(partials.front());
+  }
+} // namespace io1
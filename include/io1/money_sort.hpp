@@ -0,0 +1,205 @@
+#pragma once
+
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace io1
+{
+  namespace detail
+  {
+    struct radix_no_payload
+    {
+    };
+
+    inline constexpr std::size_t radix_bits = 11;
+    inline constexpr std::size_t radix_buckets = std::size_t{1} << radix_bits;
+    inline constexpr std::size_t radix_passes = (sizeof(money::value_type) * 8 + radix_bits - 1) / radix_bits;
+    inline constexpr std::size_t radix_small_size = 64;
+    inline constexpr std::size_t radix_grain = std::size_t{1} << 16U;
+
+    using radix_histogram = std::array<std::size_t, radix_buckets>;
+
+    // Flipping the sign bit maps the signed order onto the unsigned order of the keys.
+    [[nodiscard]] inline std::uint64_t radix_key(money m) noexcept
+    {
+      return std::bit_cast<std::uint64_t>(m.data()) ^ (std::uint64_t{1} << 63U);
+    }
+
+    template <class Payload>
+    void radix_sort(std::span<money> keys, std::span<Payload> payload, std::size_t threads)
+    {
+      constexpr bool has_payload = !std::is_same_v<Payload, radix_no_payload>;
+      auto const n = keys.size();
+
+      if (n <= radix_small_size)
+      {
+        if constexpr (has_payload)
+        {
+          // insertion sort keeps equal keys in their original order
+          for (std::size_t i = 1; i < n; ++i)
+          {
+            auto const key = keys[i];
+            auto const value = payload[i];
+            auto j = i;
+            for (; j > 0 && key < keys[j - 1]; --j)
+            {
+              keys[j] = keys[j - 1];
+              payload[j] = payload[j - 1];
+            }
+            keys[j] = key;
+            payload[j] = value;
+          }
+        }
+        else { std::sort(keys.begin(), keys.end()); }
+        return;
+      }
+
+      auto const workers = worker_count(n, radix_grain, threads);
+
+      // Sorting key - min_key instead of key preserves the order and leaves the high digits at zero when the amounts
+      // span a narrow range, as most do: the passes over these digits are then skipped.
+      std::vector<std::uint64_t> minimums(workers);
+      parallel_chunks(n, workers,
+                      [&](std::size_t w, std::size_t begin, std::size_t end) noexcept
+                      {
+                        auto minimum = ~std::uint64_t{0};
+                        for (auto i = begin; i < end; ++i) { minimum = std::min(minimum, radix_key(keys[i])); }
+                        minimums[w] = minimum;
+                      });
+      auto const min_key = std::ranges::min(minimums);
+      auto const digit = [min_key](money m, std::size_t pass) noexcept
+      { return static_cast<std::size_t>(((radix_key(m) - min_key) >> (pass * radix_bits)) & (radix_buckets - 1)); };
+
+      // Digit counts do not depend on the order of the keys: compute all of them in a single read.
+      std::vector<std::array<radix_histogram, radix_passes>> counts(workers);
+      parallel_chunks(n, workers,
+                      [&](std::size_t w, std::size_t begin, std::size_t end) noexcept
+                      {
+                        auto & local = counts[w];
+                        for (auto & histogram : local) { histogram.fill(0); }
+                        for (auto i = begin; i < end; ++i)
+                        {
+                          auto key = radix_key(keys[i]) - min_key;
+                          for (std::size_t pass = 0; pass < radix_passes; ++pass, key >>= radix_bits)
+                          {
+                            ++local[pass][key & (radix_buckets - 1)];
+                          }
+                        }
+                      });
+
+      std::vector<money> key_buffer(n);
+      std::vector<std::conditional_t<has_payload, Payload, radix_no_payload>> payload_buffer(has_payload ? n : 0);
+
+      std::span<money> src = keys;
+      std::span<money> dst = key_buffer;
+      [[maybe_unused]] std::span<Payload> src_payload = payload;
+      [[maybe_unused]] std::span<Payload> dst_payload;
+      if constexpr (has_payload) { dst_payload = payload_buffer; }
+
+      std::vector<radix_histogram> offsets(workers);
+      bool reordered = false;
+      for (std::size_t pass = 0; pass < radix_passes; ++pass)
+      {
+        radix_histogram total{};
+        for (auto const & local : counts)
+        {
+          for (std::size_t b = 0; b < radix_buckets; ++b) { total[b] += local[pass][b]; }
+        }
+
+        // all the keys share this digit: the pass would be a plain copy
+        if (std::ranges::any_of(total, [n](std::size_t c) { return c == n; })) { continue; }
+
+        // each worker scatters its chunk right after the same bucket of the previous workers: the sort is stable
+        [[maybe_unused]] auto const chunk_begin = [n, workers](std::size_t w) { return n * w / workers; };
+        if (1 < workers && reordered)
+        {
+          // the chunks have been reordered by the previous pass: recount this digit
+          parallel_chunks(n, workers,
+                          [&](std::size_t w, std::size_t begin, std::size_t end) noexcept
+                          {
+                            auto & histogram = counts[w][pass];
+                            histogram.fill(0);
+                            for (auto i = begin; i < end; ++i) { ++histogram[digit(src[i], pass)]; }
+                          });
+        }
+
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < radix_buckets; ++b)
+        {
+          for (std::size_t w = 0; w < workers; ++w)
+          {
+            offsets[w][b] = sum;
+            sum += counts[w][pass][b];
+          }
+        }
+        assert(sum == n && "Histograms must account for every key.");
+
+        parallel_chunks(n, workers,
+                        [&](std::size_t w, std::size_t begin, std::size_t end) noexcept
+                        {
+                          assert(begin == chunk_begin(w) && "Chunks must match the ones used for counting.");
+                          // local copies: the compiler cannot tell the counters from the span members otherwise
+                          auto offset = offsets[w];
+                          auto const * const from = src.data();
+                          auto * const to = dst.data();
+                          [[maybe_unused]] auto const * const from_payload = src_payload.data();
+                          [[maybe_unused]] auto * const to_payload = dst_payload.data();
+                          for (auto i = begin; i < end; ++i)
+                          {
+                            auto const position = offset[digit(from[i], pass)]++;
+                            to[position] = from[i];
+                            if constexpr (has_payload) { to_payload[position] = from_payload[i]; }
+                          }
+                        });
+
+        reordered = true;
+        std::swap(src, dst);
+        if constexpr (has_payload) { std::swap(src_payload, dst_payload); }
+      }
+
+      if (src.data() != keys.data())
+      {
+        std::ranges::copy(src, keys.begin());
+        if constexpr (has_payload) { std::ranges::copy(src_payload, payload.begin()); }
+      }
+    }
+  } // namespace detail
+
+  // Sort amounts in ascending order with a LSD radix sort on the 64-bit representation. Large inputs are partitioned
+  // among `threads` workers (0 for one per hardware thread).
+  inline void radix_sort(std::span<money> values, std::size_t threads = 0)
+  {
+    detail::radix_sort(values, std::span<detail::radix_no_payload>{}, threads);
+  }
+
+  // Sort amounts in ascending order and apply the same permutation to `payload`. The sort is stable.
+  template <class Payload>
+    requires std::is_trivially_copyable_v<Payload>
+  void radix_sort(std::span<money> keys, std::span<Payload> payload, std::size_t threads = 0)
+  {
+    assert(keys.size() == payload.size() && "Each amount must have a payload.");
+    detail::radix_sort(keys, payload, threads);
+  }
+
+  // Return the permutation that sorts `values` in ascending order, ties keeping their original order.
+  [[nodiscard]] inline std::vector<std::size_t> radix_sort_indices(std::span<money const> values,
+                                                                   std::size_t threads = 0)
+  {
+    std::vector<money> keys(values.begin(), values.end());
+    std::vector<std::size_t> indices(values.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) { indices[i] = i; }
+    detail::radix_sort(std::span<money>(keys), std::span<std::size_t>(indices), threads);
+    return indices;
+  }
+} // namespace io1
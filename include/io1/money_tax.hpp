@@ -0,0 +1,253 @@
+#pragma once
+
+#include "io1/detail/money_int128.hpp"
+#include "io1/detail/money_parallel.hpp"
+#include "io1/money_core.hpp"
+#include "io1/money_rounding.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace io1
+{
+  // Exact tax rate: numerator / denominator, e.g. {20, 100} for 20% or {77, 1'000} for 7.7%.
+  struct tax_rate
+  {
+    std::int64_t numerator;
+    std::int64_t denominator{100};
+
+    [[nodiscard]] friend constexpr bool operator==(tax_rate const &, tax_rate const &) noexcept = default;
+  };
+
+  enum class tax_rounding
+  {
+    per_line,   // the tax of each line is rounded, subtotals are their sums
+    per_invoice // the tax of each rate of an invoice is rounded on the sum of its lines, and split among them
+  };
+
+  struct tax_subtotal
+  {
+    std::uint64_t invoice;
+    std::uint16_t rate;
+    money net;
+    money tax;
+
+    [[nodiscard]] friend bool operator==(tax_subtotal const &, tax_subtotal const &) noexcept = default;
+  };
+
+  struct invoice_total
+  {
+    std::uint64_t invoice;
+    money net;
+    money tax;
+    money gross;
+
+    [[nodiscard]] friend bool operator==(invoice_total const &, invoice_total const &) noexcept = default;
+  };
+
+  struct tax_result
+  {
+    std::vector<money> tax;                // per line
+    std::vector<money> gross;              // per line
+    std::vector<tax_subtotal> subtotals;   // per invoice and rate, in the order of the first line of each
+    std::vector<invoice_total> totals;     // per invoice, in the order of the lines
+  };
+
+  namespace detail
+  {
+    [[nodiscard]] inline money::value_type checked_money(int128_t value)
+    {
+      if (!fits_money(value)) { throw std::overflow_error("io1::compute_tax: amount out of range."); }
+      return static_cast<money::value_type>(value);
+    }
+
+    struct tax_calculator
+    {
+      std::span<std::uint16_t const> rate_ids;
+      std::span<money const> net;
+      std::span<tax_rate const> rates;
+      tax_rounding rule;
+      rounding mode;
+      money * tax;
+      money * gross;
+
+      struct group
+      {
+        std::uint16_t rate;
+        int128_t net{0};
+        int128_t tax{0};
+        std::vector<std::size_t> lines{};
+      };
+
+      std::vector<group> groups{}; // of the current invoice, reused
+      std::vector<std::pair<int128_t, std::size_t>> order{}; // reused
+
+      // Lines [begin, end) of one invoice.
+      void invoice(std::uint64_t id, std::size_t begin, std::size_t end, std::vector<tax_subtotal> & subtotals,
+                   std::vector<invoice_total> & totals)
+      {
+        std::size_t used = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+          auto const rate_id = rate_ids[i];
+          auto const & rate = rates[rate_id];
+          auto const line_tax = muldiv(net[i].data(), rate.numerator, rate.denominator, mode);
+          tax[i] = money{line_tax};
+
+          auto const found = std::find_if(groups.begin(), groups.begin() + static_cast<std::ptrdiff_t>(used),
+                                          [rate_id](group const & g) { return g.rate == rate_id; });
+          auto & g =
+              found != groups.begin() + static_cast<std::ptrdiff_t>(used) ? *found : next_group(used, rate_id);
+          g.net += net[i].data();
+          g.tax += line_tax;
+          g.lines.push_back(i);
+        }
+
+        int128_t invoice_net = 0;
+        int128_t invoice_tax = 0;
+        for (std::size_t k = 0; k < used; ++k)
+        {
+          auto & g = groups[k];
+          if (tax_rounding::per_invoice == rule) { split(g); }
+          subtotals.push_back(
+              {.invoice = id, .rate = g.rate, .net = money{checked_money(g.net)}, .tax = money{checked_money(g.tax)}});
+          invoice_net += g.net;
+          invoice_tax += g.tax;
+        }
+
+        for (auto i = begin; i < end; ++i)
+        {
+          gross[i] = money{checked_money(int128_t{net[i].data()} + tax[i].data())};
+        }
+        totals.push_back({.invoice = id,
+                          .net = money{checked_money(invoice_net)},
+                          .tax = money{checked_money(invoice_tax)},
+                          .gross = money{checked_money(invoice_net + invoice_tax)}});
+      }
+
+      group & next_group(std::size_t & used, std::uint16_t rate_id)
+      {
+        if (used == groups.size()) { groups.emplace_back(); }
+        auto & g = groups[used++];
+        g.rate = rate_id;
+        g.net = g.tax = 0;
+        g.lines.clear();
+        return g;
+      }
+
+      // Round the tax of the group on its net sum and move the difference with the sum of the rounded line taxes to
+      // the lines that lost the most to rounding, first lines first on ties. Each line moves by one unit at most.
+      void split(group & g)
+      {
+        auto const & rate = rates[g.rate];
+        auto const total =
+            divide_rounded<int128_t>(int128_t{checked_money(g.net)} * rate.numerator, rate.denominator, mode);
+        auto const difference = total - g.tax;
+        if (0 == difference) { return; }
+
+        auto const count = static_cast<std::size_t>(difference < 0 ? -difference : difference);
+        assert(count <= g.lines.size() && "Line taxes are less than a unit away from their exact value.");
+
+        // what each line lost to rounding, in units of 1 / denominator, negated when taking back
+        order.clear();
+        for (auto const line : g.lines)
+        {
+          auto const lost = static_cast<int128_t>(net[line].data()) * rate.numerator -
+                            static_cast<int128_t>(tax[line].data()) * rate.denominator;
+          order.emplace_back(difference > 0 ? -lost : lost, line);
+        }
+        std::ranges::nth_element(order, order.begin() + static_cast<std::ptrdiff_t>(count));
+
+        auto const step = difference > 0 ? 1 : -1;
+        for (std::size_t k = 0; k < count; ++k) { tax[order[k].second] += money{step}; }
+        g.tax = total;
+      }
+    };
+  } // namespace detail
+
+  // Tax of invoice lines given as parallel columns: the invoice of each line, the index of its rate in `rates` and its
+  // net amount. The lines of an invoice are contiguous. Taxes are rounded according to mode and rule, and line taxes
+  // always sum to the subtotals, which sum to the invoice totals. Invoices are split among `threads` workers (one per
+  // hardware thread if 0).
+  //
+  // Throws std::invalid_argument, before anything is computed, for an unknown rate or a rate with a non-positive
+  // denominator or a negative numerator, and std::overflow_error for amounts out of range.
+  [[nodiscard]] inline tax_result compute_tax(std::span<std::uint64_t const> invoices,
+                                              std::span<std::uint16_t const> rate_ids, std::span<money const> net,
+                                              std::span<tax_rate const> rates, tax_rounding rule,
+                                              rounding mode = rounding::half_even, std::size_t threads = 0)
+  {
+    assert(invoices.size() == rate_ids.size() && invoices.size() == net.size() &&
+           "Each line must have an invoice, a rate and a net amount.");
+
+    for (std::size_t r = 0; r < rates.size(); ++r)
+    {
+      if (rates[r].denominator <= 0 || rates[r].numerator < 0)
+      {
+        throw std::invalid_argument("io1::compute_tax: invalid rate " + std::to_string(r) + ".");
+      }
+    }
+    std::vector<std::size_t> starts; // of each invoice, then the end of the lines
+    for (std::size_t i = 0; i < invoices.size(); ++i)
+    {
+      if (rate_ids[i] >= rates.size())
+      {
+        throw std::invalid_argument("io1::compute_tax: unknown rate " + std::to_string(rate_ids[i]) + " at line " +
+                                    std::to_string(i) + ".");
+      }
+      if (0 == i || invoices[i] != invoices[i - 1]) { starts.push_back(i); }
+    }
+    starts.push_back(invoices.size());
+
+    tax_result result;
+    result.tax.resize(net.size());
+    result.gross.resize(net.size());
+
+    auto const count = starts.size() - 1;
+    constexpr std::size_t grain = 4'096;
+    auto const workers = detail::worker_count(count, grain, threads);
+    std::vector<std::vector<tax_subtotal>> subtotals(workers);
+    std::vector<std::vector<invoice_total>> totals(workers);
+    detail::parallel_chunks(count, workers,
+                            [&](std::size_t w, std::size_t begin, std::size_t end)
+                            {
+                              detail::tax_calculator calculator{.rate_ids = rate_ids,
+                                                                .net = net,
+                                                                .rates = rates,
+                                                                .rule = rule,
+                                                                .mode = mode,
+                                                                .tax = result.tax.data(),
+                                                                .gross = result.gross.data()};
+                              // untouched capacity costs no page fault: at most one subtotal per line
+                              totals[w].reserve(end - begin);
+                              subtotals[w].reserve(starts[end] - starts[begin]);
+                              for (auto k = begin; k < end; ++k)
+                              {
+                                calculator.invoice(invoices[starts[k]], starts[k], starts[k + 1], subtotals[w],
+                                                   totals[w]);
+                              }
+                            });
+
+    if (1 == workers)
+    {
+      result.totals = std::move(totals.front());
+      result.subtotals = std::move(subtotals.front());
+      return result;
+    }
+    result.totals.reserve(count);
+    result.subtotals.reserve(net.size());
+    for (std::size_t w = 0; w < workers; ++w)
+    {
+      result.totals.insert(result.totals.end(), totals[w].begin(), totals[w].end());
+      result.subtotals.insert(result.subtotals.end(), subtotals[w].begin(), subtotals[w].end());
+    }
+    return result;
+  }
+} // namespace io1
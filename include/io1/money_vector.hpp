@@ -0,0 +1,235 @@
+#pragma once
+
+#include "io1/money_core.hpp"
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace io1
+{
+  namespace detail
+  {
+    // Base class of every node of a money expression tree, used to opt types in the operators below.
+    struct money_expression_base
+    {
+    };
+  } // namespace detail
+
+  template <class E>
+  concept money_expression = std::derived_from<E, detail::money_expression_base> &&
+                             requires(E const & e, std::size_t i) {
+                               {
+                                 e.size()
+                               } -> std::same_as<std::size_t>;
+                               {
+                                 e[i]
+                               } -> std::same_as<money>;
+                             };
+
+  class money_vector;
+
+  // Non owning leaf of a money expression.
+  class money_column : public detail::money_expression_base
+  {
+  public:
+    constexpr money_column(std::span<money const> data) noexcept // NOLINT(google-explicit-constructor)
+        : data_(data)
+    {
+    }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return data_.size(); }
+    [[nodiscard]] constexpr money operator[](std::size_t i) const noexcept { return data_[i]; }
+
+  private:
+    std::span<money const> data_;
+  };
+
+  namespace detail
+  {
+    // Vectors are captured by reference: like views, expressions must be evaluated before their operands die.
+    template <class E>
+    using expression_operand_t =
+        std::conditional_t<std::is_same_v<std::remove_cvref_t<E>, money_vector>, money_column, std::remove_cvref_t<E>>;
+
+    struct money_plus
+    {
+      [[nodiscard]] constexpr money operator()(money lhs, money rhs) const noexcept { return lhs + rhs; }
+    };
+    struct money_minus
+    {
+      [[nodiscard]] constexpr money operator()(money lhs, money rhs) const noexcept { return lhs - rhs; }
+    };
+  } // namespace detail
+
+  template <money_expression L, money_expression R, class Op>
+  class money_binary_expression : public detail::money_expression_base
+  {
+  public:
+    constexpr money_binary_expression(L lhs, R rhs) noexcept : lhs_(lhs), rhs_(rhs)
+    {
+      assert(lhs_.size() == rhs_.size() && "Element-wise operations require columns of the same size.");
+    }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return lhs_.size(); }
+    [[nodiscard]] constexpr money operator[](std::size_t i) const noexcept { return Op{}(lhs_[i], rhs_[i]); }
+
+  private:
+    L lhs_;
+    R rhs_;
+  };
+
+  template <money_expression E>
+  class money_negate_expression : public detail::money_expression_base
+  {
+  public:
+    constexpr explicit money_negate_expression(E operand) noexcept : operand_(operand) {}
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return operand_.size(); }
+    [[nodiscard]] constexpr money operator[](std::size_t i) const noexcept { return -operand_[i]; }
+
+  private:
+    E operand_;
+  };
+
+  template <money_expression E, class T>
+  class money_scale_expression : public detail::money_expression_base
+  {
+  public:
+    constexpr money_scale_expression(E operand, T factor) noexcept : operand_(operand), factor_(factor) {}
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return operand_.size(); }
+    [[nodiscard]] constexpr money operator[](std::size_t i) const noexcept
+    {
+      if constexpr (std::integral<T>) { return operand_[i] * factor_; }
+      else { return factor_ * operand_[i]; }
+    }
+
+  private:
+    E operand_;
+    T factor_;
+  };
+
+  // Evaluate an expression in a single pass. dest may alias the operands since element i only depends on elements i.
+  template <money_expression E>
+  constexpr void evaluate(E const & expr, std::span<money> dest) noexcept
+  {
+    assert(expr.size() == dest.size() && "Destination size does not match the expression size.");
+    auto const n = dest.size();
+    auto * const out = dest.data();
+    for (std::size_t i = 0; i < n; ++i) { out[i] = expr[i]; }
+  }
+
+  class money_vector : public detail::money_expression_base
+  {
+  public:
+    using value_type = money;
+    using iterator = std::vector<money>::iterator;
+    using const_iterator = std::vector<money>::const_iterator;
+
+    money_vector() noexcept = default;
+    explicit money_vector(std::size_t size) : data_(size, money{0}) {}
+    money_vector(std::initializer_list<money> values) : data_(values) {}
+    explicit money_vector(std::span<money const> values) : data_(values.begin(), values.end()) {}
+
+    template <money_expression E>
+      requires(!std::is_same_v<E, money_vector>)
+    money_vector(E const & expr) : data_(expr.size()) // NOLINT(google-explicit-constructor)
+    {
+      evaluate(expr, data_);
+    }
+
+    template <money_expression E>
+      requires(!std::is_same_v<E, money_vector>)
+    money_vector & operator=(E const & expr)
+    {
+      if (data_.size() != expr.size())
+      {
+        // the expression may reference this vector, resizing would invalidate it
+        money_vector tmp(expr);
+        data_.swap(tmp.data_);
+      }
+      else { evaluate(expr, data_); }
+      return *this;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return data_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return data_.empty(); }
+    [[nodiscard]] money operator[](std::size_t i) const noexcept { return data_[i]; }
+    [[nodiscard]] money & operator[](std::size_t i) noexcept { return data_[i]; }
+
+    [[nodiscard]] money * data() noexcept { return data_.data(); }
+    [[nodiscard]] money const * data() const noexcept { return data_.data(); }
+
+    [[nodiscard]] iterator begin() noexcept { return data_.begin(); }
+    [[nodiscard]] iterator end() noexcept { return data_.end(); }
+    [[nodiscard]] const_iterator begin() const noexcept { return data_.begin(); }
+    [[nodiscard]] const_iterator end() const noexcept { return data_.end(); }
+
+    [[nodiscard]] friend bool operator==(money_vector const & lhs, money_vector const & rhs) noexcept
+    {
+      return lhs.data_ == rhs.data_;
+    }
+
+  private:
+    std::vector<money> data_;
+  };
+
+  template <class L, class R>
+    requires money_expression<std::remove_cvref_t<L>> && money_expression<std::remove_cvref_t<R>>
+  [[nodiscard]] constexpr auto operator+(L const & lhs, R const & rhs) noexcept
+  {
+    using lhs_t = detail::expression_operand_t<L>;
+    using rhs_t = detail::expression_operand_t<R>;
+    return money_binary_expression<lhs_t, rhs_t, detail::money_plus>(lhs_t(lhs), rhs_t(rhs));
+  }
+
+  template <class L, class R>
+    requires money_expression<std::remove_cvref_t<L>> && money_expression<std::remove_cvref_t<R>>
+  [[nodiscard]] constexpr auto operator-(L const & lhs, R const & rhs) noexcept
+  {
+    using lhs_t = detail::expression_operand_t<L>;
+    using rhs_t = detail::expression_operand_t<R>;
+    return money_binary_expression<lhs_t, rhs_t, detail::money_minus>(lhs_t(lhs), rhs_t(rhs));
+  }
+
+  template <class E>
+    requires money_expression<std::remove_cvref_t<E>>
+  [[nodiscard]] constexpr auto operator-(E const & operand) noexcept
+  {
+    using operand_t = detail::expression_operand_t<E>;
+    return money_negate_expression<operand_t>(operand_t(operand));
+  }
+
+  // Same dimensional rules as the scalar operators: no product of two amounts, floating factors only on the left.
+  template <class E, class T>
+    requires money_expression<std::remove_cvref_t<E>>
+  constexpr auto operator*(E const & lhs, T rhs) = delete;
+
+  template <class E, std::integral T>
+    requires money_expression<std::remove_cvref_t<E>>
+  [[nodiscard]] constexpr auto operator*(E const & lhs, T rhs) noexcept
+  {
+    using operand_t = detail::expression_operand_t<E>;
+    return money_scale_expression<operand_t, T>(operand_t(lhs), rhs);
+  }
+
+  template <std::integral T, class E>
+    requires money_expression<std::remove_cvref_t<E>>
+  [[nodiscard]] constexpr auto operator*(T lhs, E const & rhs) noexcept
+  {
+    return rhs * lhs;
+  }
+
+  template <std::floating_point T, class E>
+    requires money_expression<std::remove_cvref_t<E>>
+  [[nodiscard]] constexpr auto operator*(T lhs, E const & rhs) noexcept
+  {
+    using operand_t = detail::expression_operand_t<E>;
+    return money_scale_expression<operand_t, long double>(operand_t(rhs), static_cast<long double>(lhs));
+  }
+} // namespace io1
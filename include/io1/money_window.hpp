@@ -0,0 +1,254 @@
+#pragma once
+
+#include "io1/money_core.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace io1
+{
+  struct window_options
+  {
+    std::chrono::milliseconds width{std::chrono::minutes{1}};
+    std::chrono::milliseconds step{std::chrono::minutes{1}}; // width for tumbling windows, a divisor of it for sliding
+    std::chrono::milliseconds lateness{0}; // how far behind the latest event the others are still accepted
+  };
+
+  struct window_total
+  {
+    money128::value_type sum{0};
+    std::uint64_t count{0};
+
+    [[nodiscard]] friend bool operator==(window_total const &, window_total const &) noexcept = default;
+  };
+
+  // Totals per key of the amounts of an unbounded stream of timestamped events, over windows of `width` starting
+  // every `step`. Events may arrive out of order by up to `lateness`: a window is closed, and its totals final, once an
+  // event or advance() is `lateness` past its end. Older events are dropped.
+  //
+  // Each key holds the totals of the panes (intervals of `step`) of a window and of the late events in a ring, and the
+  // total of its latest closed window, updated by adding the panes entering the window and subtracting those leaving
+  // it: events are added and windows slide in constant amortized time. Keys take width / step + ceil(lateness / step)
+  // + 1 panes of 32 bytes each, and expire() recycles the memory of keys that have become idle.
+  template <class Key, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+  class money_window
+  {
+  public:
+    using time_point = std::chrono::sys_time<std::chrono::milliseconds>;
+
+    // Throws std::invalid_argument if step is not positive or does not divide width, or if lateness is negative.
+    explicit money_window(window_options const & options)
+        : step_(options.step.count()), lateness_(options.lateness.count())
+    {
+      if (0 >= step_ || 0 >= options.width.count() || 0 != options.width.count() % step_ || 0 > lateness_)
+      {
+        throw std::invalid_argument("io1::money_window: the step must be positive and divide the width, and the "
+                                    "lateness cannot be negative.");
+      }
+      window_panes_ = options.width.count() / step_;
+      ring_ = static_cast<std::size_t>(window_panes_ + (lateness_ + step_ - 1) / step_ + 1);
+    }
+
+    // Add an event. Returns false, and drops it, if it is older than the latest event by more than the lateness.
+    bool add(Key const & key, time_point time, money amount)
+    {
+      if (started_ && time.time_since_epoch().count() < latest_ - lateness_)
+      {
+        ++dropped_;
+        return false;
+      }
+      advance(time);
+
+      auto & state = state_of(key);
+      sync(state);
+      // whatever the slot held is older than the panes of the window: it is no longer part of any total
+      auto const pane = pane_of(time.time_since_epoch().count());
+      auto & slot = slot_of(state, pane);
+      if (slot.pane != pane) { slot = {.sum = 0, .count = 0, .pane = pane}; }
+      slot.sum += amount.data();
+      ++slot.count;
+      state.last = std::max(state.last, pane);
+      return true;
+    }
+
+    // Move time forward without an event, closing the windows ending `lateness` before now.
+    void advance(time_point now) noexcept
+    {
+      auto const ms = now.time_since_epoch().count();
+      if (started_ && ms <= latest_) { return; }
+      started_ = true;
+      latest_ = ms;
+      closed_ = pane_of(ms - lateness_);
+    }
+
+    // End of the latest closed window, time_point::min() before any event.
+    [[nodiscard]] time_point closed_until() const noexcept
+    {
+      return started_ ? time_point{std::chrono::milliseconds{closed_ * step_}} : time_point::min();
+    }
+
+    // Total of the key in the latest closed window, [closed_until() - width, closed_until()).
+    [[nodiscard]] window_total total(Key const & key)
+    {
+      auto const it = index_.find(key);
+      if (index_.end() == it) { return {}; }
+      auto & state = states_[it->second];
+      sync(state);
+      return {.sum = state.sum, .count = state.count};
+    }
+
+    // Call f(key, total) for the keys with events in the latest closed window.
+    template <class F>
+    void for_each(F f)
+    {
+      for (auto const & [key, index] : index_)
+      {
+        auto & state = states_[index];
+        sync(state);
+        if (0 != state.count) { f(key, window_total{.sum = state.sum, .count = state.count}); }
+      }
+    }
+
+    // Forget the keys without events in the latest closed window or after it, whose totals are zero until their next
+    // event, and reuse their memory for new keys. Returns the number of keys forgotten.
+    std::size_t expire()
+    {
+      return std::erase_if(index_,
+                           [this](auto const & entry)
+                           {
+                             if (states_[entry.second].last >= closed_ - window_panes_) { return false; }
+                             free_.push_back(entry.second);
+                             return true;
+                           });
+    }
+
+    // Make room for `keys` keys at once rather than growing as they come.
+    void reserve(std::size_t keys)
+    {
+      index_.reserve(keys);
+      states_.reserve(keys);
+      slots_.reserve(keys * ring_);
+    }
+
+    // Number of keys.
+    [[nodiscard]] std::size_t size() const noexcept { return index_.size(); }
+
+    // Number of events dropped for being too late.
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_; }
+
+  private:
+    static constexpr std::int64_t no_pane = std::numeric_limits<std::int64_t>::lowest();
+
+    struct pane_total
+    {
+      money128::value_type sum;
+      std::uint64_t count;
+      std::int64_t pane; // the slot is reused for later panes
+    };
+
+    struct key_state
+    {
+      money128::value_type sum; // of the panes of the window ending at synced
+      std::uint64_t count;
+      std::int64_t synced;      // end pane of the window summed
+      std::int64_t last;        // pane of the latest event
+      std::size_t slots;        // first of the ring of panes
+    };
+
+    [[nodiscard]] std::int64_t pane_of(std::int64_t ms) const noexcept
+    {
+      return ms / step_ - static_cast<std::int64_t>(ms % step_ < 0); // rounded down, also before the epoch
+    }
+
+    [[nodiscard]] pane_total & slot_of(key_state const & state, std::int64_t pane) noexcept
+    {
+      auto const ring = static_cast<std::int64_t>(ring_);
+      return slots_[state.slots + static_cast<std::size_t>((pane % ring + ring) % ring)];
+    }
+
+    key_state & state_of(Key const & key)
+    {
+      if (auto const it = index_.find(key); index_.end() != it) { return states_[it->second]; }
+
+      // the state exists before the key is indexed: a failed allocation leaves no key without one
+      auto const reuse = !free_.empty();
+      auto const index = reuse ? free_.back() : states_.size();
+      if (!reuse)
+      {
+        slots_.resize(slots_.size() + ring_, pane_total{.sum = 0, .count = 0, .pane = no_pane});
+        states_.push_back({.sum = 0, .count = 0, .synced = 0, .last = no_pane, .slots = slots_.size() - ring_});
+      }
+      index_.emplace(key, index);
+      auto & state = states_[index];
+      if (reuse)
+      {
+        free_.pop_back();
+        std::fill_n(slots_.begin() + static_cast<std::ptrdiff_t>(state.slots), ring_,
+                    pane_total{.sum = 0, .count = 0, .pane = no_pane});
+      }
+      state = {.sum = 0, .count = 0, .synced = closed_, .last = no_pane, .slots = state.slots};
+      return state;
+    }
+
+    // Slide the window of the key to the latest closed one: panes enter and leave it once each.
+    void sync(key_state & state) noexcept
+    {
+      if (state.synced >= closed_) { return; }
+      auto const enter = [this, &state](std::int64_t pane)
+      {
+        if (auto const & slot = slot_of(state, pane); slot.pane == pane)
+        {
+          state.sum += slot.sum;
+          state.count += slot.count;
+        }
+      };
+      auto const leave = [this, &state](std::int64_t pane)
+      {
+        if (auto const & slot = slot_of(state, pane); slot.pane == pane)
+        {
+          state.sum -= slot.sum;
+          state.count -= slot.count;
+        }
+      };
+
+      // panes after the latest event of the key, or of an empty window, hold nothing and are not read
+      auto const end = std::min(closed_, state.last + 1);
+      if (closed_ - state.synced >= window_panes_)
+      {
+        state.sum = 0;
+        state.count = 0;
+        for (auto pane = closed_ - window_panes_; pane < end; ++pane) { enter(pane); }
+      }
+      else
+      {
+        if (0 != state.count)
+        {
+          auto const left = std::min(closed_, end + window_panes_) - window_panes_;
+          for (auto pane = state.synced - window_panes_; pane < left; ++pane) { leave(pane); }
+        }
+        for (auto pane = state.synced; pane < end; ++pane) { enter(pane); }
+      }
+      state.synced = closed_;
+    }
+
+    std::int64_t step_;
+    std::int64_t lateness_;
+    std::int64_t window_panes_{1};
+    std::size_t ring_{1}; // panes per key
+    bool started_{false};
+    std::int64_t latest_{0}; // time of the latest event, in ms
+    std::int64_t closed_{0}; // end pane of the latest closed window
+    std::uint64_t dropped_{0};
+    std::unordered_map<Key, std::size_t, Hash, KeyEqual> index_; // of the state of each key
+    std::vector<key_state> states_;
+    std::vector<pane_total> slots_;
+    std::vector<std::size_t> free_; // states of expired keys
+  };
+} // namespace io1
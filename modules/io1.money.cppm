@@ -0,0 +1,41 @@
+module;
+
+#include "io1/money.hpp"
+
+export module io1.money;
+
+// The amounts of io1/money.hpp, their arithmetic, streams and std::format support. Companion headers are not part of
+// the module: include them after the import.
+export namespace io1
+{
+  using io1::basic_money;
+  using io1::money;
+  using io1::money128;
+  using io1::money32;
+
+  using io1::operator+;
+  using io1::operator-;
+  using io1::operator*;
+  using io1::operator/;
+  using io1::operator<<;
+  using io1::operator>>;
+
+  using io1::basic_moneydiv_t;
+  using io1::div;
+  using io1::get_money;
+  using io1::money_cast;
+  using io1::moneydiv_t;
+  using io1::put_money;
+
+  using io1::counting_observer;
+  using io1::money_event_counts;
+  using io1::money_observer;
+  using io1::null_observer;
+
+  inline namespace literals
+  {
+    using io1::literals::operator""_money;
+    using io1::literals::operator""_money128;
+    using io1::literals::operator""_money32;
+  } // namespace literals
+} // namespace io1
@@ -0,0 +1,146 @@
+#include "io1/money_accrual.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  constexpr std::chrono::sys_days day(int y, unsigned m, unsigned d) noexcept
+  {
+    return std::chrono::year{y} / static_cast<int>(m) / static_cast<int>(d);
+  }
+
+  template <io1::day_count DayCount>
+  io1::money accrue_daily(io1::money balance, io1::fixed_rate rate, std::chrono::sys_days start,
+                          std::chrono::sys_days end, std::int64_t & residual)
+  {
+    io1::money total{0};
+    for (auto d = start; d < end; d += std::chrono::days{1})
+    {
+      total += io1::accrue<DayCount>(balance, rate, d, d + std::chrono::days{1}, residual);
+    }
+    return total;
+  }
+} // namespace
+
+TEST_CASE("Day count conventions")
+{
+  static_assert(io1::day_count<io1::act_360> && io1::day_count<io1::act_365f> && io1::day_count<io1::thirty_360> &&
+                io1::day_count<io1::act_act>);
+
+  static_assert(181 == io1::act_360::numerator(day(2024, 1, 1), day(2024, 6, 30)));
+  static_assert(366 == io1::act_365f::numerator(day(2024, 1, 1), day(2025, 1, 1)));
+
+  static_assert(30 == io1::thirty_360::numerator(day(2023, 1, 31), day(2023, 2, 28)) + 2);
+  static_assert(30 == io1::thirty_360::numerator(day(2023, 1, 30), day(2023, 2, 28)) + 2);
+  static_assert(30 == io1::thirty_360::numerator(day(2023, 3, 31), day(2023, 4, 30)));
+  static_assert(30 == io1::thirty_360::numerator(day(2023, 3, 30), day(2023, 4, 30)));
+  static_assert(31 == io1::thirty_360::numerator(day(2023, 3, 1), day(2023, 3, 31)) + 1);
+  static_assert(360 == io1::thirty_360::numerator(day(2023, 3, 31), day(2024, 3, 31)));
+  static_assert(0 == io1::thirty_360::numerator(day(2023, 3, 30), day(2023, 3, 31)));
+
+  // a whole year is one, whether it is a leap year or not
+  static_assert(io1::act_act::basis == io1::act_act::numerator(day(2023, 1, 1), day(2024, 1, 1)));
+  static_assert(io1::act_act::basis == io1::act_act::numerator(day(2024, 1, 1), day(2025, 1, 1)));
+  // 2023-12-15 to 2024-01-15: 17 days over 365 and 14 over 366
+  static_assert(17 * 366 + 14 * 365 == io1::act_act::numerator(day(2023, 12, 15), day(2024, 1, 15)));
+}
+
+TEST_CASE("Accrual of a single account")
+{
+  std::int64_t residual = 0;
+  // 1,000,000.00 at 5% for 90 days
+  CHECK_EQ(12'500.00_money, io1::accrue<io1::act_360>(1'000'000.00_money, io1::fixed_rate{5'000'000}, day(2024, 1, 1),
+                                                       day(2024, 3, 31), residual));
+  CHECK_EQ(0, residual);
+
+  CHECK_EQ(0.13_money, io1::accrue<io1::act_365f>(1'000.00_money, {5'000'000}, day(2024, 1, 1), day(2024, 1, 2),
+                                                 residual));
+  CHECK_EQ(500'000'000'000 % (365 * io1::fixed_rate::one), residual);
+
+  residual = 0;
+  CHECK_EQ(-0.13_money, io1::accrue<io1::act_365f>(-1'000.00_money, {5'000'000}, day(2024, 1, 1), day(2024, 1, 2),
+                                                  residual));
+  CHECK(residual < 0);
+
+  CHECK_THROWS_AS((void)io1::accrue<io1::act_360>(1_money, {10 * io1::fixed_rate::one + 1}, day(2024, 1, 1),
+                                                   day(2024, 1, 2), residual),
+                  std::invalid_argument);
+  residual = 0;
+  auto const max = io1::money{std::numeric_limits<std::int64_t>::max()};
+  CHECK_THROWS_AS((void)io1::accrue<io1::act_360>(max, {io1::fixed_rate::one}, day(2024, 1, 1), day(2025, 1, 1),
+                                                   residual),
+                  std::overflow_error);
+}
+
+TEST_CASE("Residuals do not drift")
+{
+  // accruing day by day sums to the interest of the whole period, which a rounded daily accrual does not
+  auto const balance = 1'234.56_money;
+  io1::fixed_rate const rate{3'750'000};
+  auto const start = day(2023, 6, 15);
+  auto const end = day(2025, 6, 15);
+
+  std::int64_t whole = 0;
+  std::int64_t daily = 0;
+  CHECK_EQ(io1::accrue<io1::act_act>(balance, rate, start, end, whole),
+           accrue_daily<io1::act_act>(balance, rate, start, end, daily));
+  CHECK_EQ(whole, daily);
+
+  whole = daily = 0;
+  CHECK_EQ(io1::accrue<io1::act_360>(balance, rate, start, end, whole),
+           accrue_daily<io1::act_360>(balance, rate, start, end, daily));
+  whole = daily = 0;
+  CHECK_EQ(io1::accrue<io1::thirty_360>(balance, rate, start, end, whole),
+           accrue_daily<io1::thirty_360>(balance, rate, start, end, daily));
+  CHECK_EQ(whole, daily);
+}
+
+TEST_CASE("Accrual of a column of accounts")
+{
+  std::mt19937_64 gen(39);
+  std::uniform_int_distribution<std::int64_t> balances_dist(-1'000'000'00, 100'000'000'00);
+  std::uniform_int_distribution<std::int64_t> rates_dist(-1'000'000, 20'000'000);
+
+  std::vector<io1::money> balances(200'000);
+  std::vector<io1::fixed_rate> rates(balances.size());
+  for (std::size_t i = 0; i < balances.size(); ++i)
+  {
+    balances[i] = io1::money{balances_dist(gen)};
+    rates[i] = {rates_dist(gen)};
+  }
+  // beyond the 64-bit kernel
+  balances[150'000] = io1::money{std::numeric_limits<std::int64_t>::max() / 100};
+
+  std::vector<std::int64_t> residuals(balances.size(), 0);
+  std::vector<std::int64_t> expected_residuals(balances.size(), 0);
+  std::vector<io1::money> interest(balances.size());
+  std::vector<io1::money> expected(balances.size());
+  for (auto d = day(2024, 2, 27); d < day(2024, 3, 3); d += std::chrono::days{1})
+  {
+    io1::accrue<io1::act_act>(balances, rates, d, d + std::chrono::days{1}, residuals, interest, 4);
+    for (std::size_t i = 0; i < balances.size(); ++i)
+    {
+      expected[i] = io1::accrue<io1::act_act>(balances[i], rates[i], d, d + std::chrono::days{1},
+                                              expected_residuals[i]);
+    }
+    CHECK(expected == interest);
+    CHECK(expected_residuals == residuals);
+  }
+
+  // rates are checked first
+  rates[7] = {-11 * io1::fixed_rate::one};
+  std::vector<io1::money> untouched(balances.size(), 1_money);
+  CHECK_THROWS_WITH_AS(io1::accrue<io1::act_360>(balances, rates, day(2024, 1, 1), day(2024, 1, 2), residuals,
+                                                 untouched),
+                       "io1::accrue: rate of account 7 beyond 1000%.", std::invalid_argument);
+  CHECK(std::vector<io1::money>(balances.size(), 1_money) == untouched);
+}
@@ -0,0 +1,132 @@
+#include "io1/money_amortization.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  // Invariants of the rows [begin, end) of a schedule for l.
+  bool consistent(io1::amortization_schedule const & schedule, io1::loan const & l, std::size_t begin,
+                  std::size_t end, io1::rounding mode)
+  {
+    auto const payment = io1::level_payment(l);
+    auto outstanding = l.principal;
+    for (auto row = begin; row < end; ++row)
+    {
+      auto const interest = io1::muldiv(outstanding, l.rate.numerator, l.rate.denominator, mode);
+      if (interest != schedule.interest[row] || schedule.principal[row] < 0_money) { return false; }
+      if (row + 1 < end && 0_money != schedule.balance[row] && payment != interest + schedule.principal[row])
+      {
+        return false;
+      }
+      outstanding -= schedule.principal[row];
+      if (outstanding != schedule.balance[row]) { return false; }
+    }
+    return 0_money == outstanding;
+  }
+} // namespace
+
+TEST_CASE("Level payments")
+{
+  // 100,000.00 at 6% a year over 30 years of monthly payments
+  io1::loan const mortgage{.principal = 100'000.00_money, .rate = {6, 1'200}, .periods = 360};
+  CHECK_EQ(599.55_money, io1::level_payment(mortgage));
+  CHECK_EQ(3'333.33_money, io1::level_payment({.principal = 10'000.00_money, .rate = {0, 1}, .periods = 3}));
+  CHECK_EQ(1'100.00_money, io1::level_payment({.principal = 1'000.00_money, .rate = {1, 10}, .periods = 1}));
+
+  // tiny loans still decrease
+  CHECK_EQ(0.01_money, io1::level_payment({.principal = 0.01_money, .rate = {5, 1'200}, .periods = 360}));
+  CHECK_EQ(0.01_money, io1::level_payment({.principal = 1.00_money, .rate = {0, 1}, .periods = 1'000}));
+
+  std::mt19937_64 gen(38);
+  std::uniform_int_distribution<std::int64_t> principals(1'000'00, 10'000'000'00);
+  std::uniform_int_distribution<std::int64_t> rates(1, 2'000);
+  std::uniform_int_distribution<std::uint32_t> periods(1, 480);
+  for (int i = 0; i < 1'000; ++i)
+  {
+    io1::loan const l{.principal = io1::money{principals(gen)}, .rate = {rates(gen), 120'000}, .periods = periods(gen)};
+    auto const r = static_cast<long double>(l.rate.numerator) / l.rate.denominator;
+    auto const expected = static_cast<long double>(l.principal.data()) * r / (1 - std::pow(1 + r, -1.0L * l.periods));
+    CHECK(std::abs(expected - static_cast<long double>(io1::level_payment(l).data())) <= 0.5L + 1e-6L);
+  }
+
+  CHECK_THROWS_AS((void)io1::level_payment({.principal = -1_money, .rate = {1, 100}, .periods = 12}),
+                  std::invalid_argument);
+  CHECK_THROWS_AS((void)io1::level_payment({.principal = 1_money, .rate = {1, 1}, .periods = 12}),
+                  std::invalid_argument);
+  CHECK_THROWS_AS((void)io1::level_payment({.principal = 1_money, .rate = {1, 100}, .periods = 0}),
+                  std::invalid_argument);
+  auto const max = io1::money{std::numeric_limits<std::int64_t>::max()};
+  CHECK_THROWS_AS((void)io1::level_payment({.principal = max, .rate = {1, 2}, .periods = 1}), std::overflow_error);
+}
+
+TEST_CASE("Amortization schedules")
+{
+  io1::loan const loans[] = {{.principal = 100'000.00_money, .rate = {6, 1'200}, .periods = 360},
+                             {.principal = 10'000.00_money, .rate = {0, 1}, .periods = 3},
+                             {.principal = 0_money, .rate = {1, 100}, .periods = 2},
+                             {.principal = 0.05_money, .rate = {5, 1'200}, .periods = 12}};
+  auto const schedule = io1::amortize(loans);
+
+  CHECK(std::vector<std::size_t>{0, 360, 363, 365, 377} == schedule.offsets);
+  CHECK_EQ(500.00_money, schedule.interest[0]);
+  CHECK_EQ(99.55_money, schedule.principal[0]);
+  CHECK_EQ(99'900.45_money, schedule.balance[0]);
+  CHECK_EQ(0_money, schedule.balance[359]);
+  CHECK_EQ(3'333.34_money, schedule.principal[362]);
+  CHECK_EQ(0.01_money, schedule.principal[365]);
+
+  for (std::size_t i = 0; i < std::size(loans); ++i)
+  {
+    auto const begin = schedule.offsets[i];
+    auto const end = schedule.offsets[i + 1];
+    CHECK(consistent(schedule, loans[i], begin, end, io1::rounding::half_even));
+    CHECK_EQ(loans[i].principal, std::accumulate(schedule.principal.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                 schedule.principal.begin() + static_cast<std::ptrdiff_t>(end),
+                                                 0_money));
+  }
+
+  // nothing is computed for an invalid portfolio
+  io1::loan const invalid[] = {loans[0], {.principal = 1_money, .rate = {-1, 100}, .periods = 12}};
+  CHECK_THROWS_WITH_AS((void)io1::amortize(invalid), "io1::amortize: loan 1 has a rate out of [0, 1).",
+                       std::invalid_argument);
+}
+
+TEST_CASE("Parallel amortization of a portfolio")
+{
+  std::mt19937_64 gen(380);
+  std::uniform_int_distribution<std::int64_t> principals(0, 1'000'000'00);
+  std::uniform_int_distribution<std::int64_t> rates(0, 3'000);
+  std::uniform_int_distribution<std::uint32_t> periods(1, 120);
+  std::vector<io1::loan> portfolio(5'000);
+  for (auto & l : portfolio)
+  {
+    l = {.principal = io1::money{principals(gen)}, .rate = {rates(gen), 120'000}, .periods = periods(gen)};
+  }
+
+  auto const serial = io1::amortize(portfolio, io1::rounding::half_up, 1);
+  auto const parallel = io1::amortize(portfolio, io1::rounding::half_up, 4);
+  CHECK(serial.offsets == parallel.offsets);
+  CHECK(serial.interest == parallel.interest);
+  CHECK(serial.principal == parallel.principal);
+  CHECK(serial.balance == parallel.balance);
+
+  std::size_t inconsistent = 0;
+  for (std::size_t i = 0; i < portfolio.size(); ++i)
+  {
+    if (!consistent(parallel, portfolio[i], parallel.offsets[i], parallel.offsets[i + 1], io1::rounding::half_up))
+    {
+      ++inconsistent;
+    }
+  }
+  CHECK_EQ(0, inconsistent);
+}
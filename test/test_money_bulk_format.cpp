@@ -0,0 +1,89 @@
+#include "io1/money_bulk_format.hpp"
+
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <locale>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  class grouping_moneypunct : public std::moneypunct<char, false>
+  {
+  private:
+    char do_thousands_sep() const override { return ','; }
+    std::string do_grouping() const override { return "\3"; }
+    std::string do_curr_symbol() const override { return "$"; }
+    std::string do_negative_sign() const override { return "()"; }
+    int do_frac_digits() const override { return 2; }
+    pattern do_neg_format() const override { return {{symbol, sign, value, none}}; }
+  };
+
+  class custom_money_put : public std::money_put<char>
+  {
+  };
+
+  std::vector<io1::money> column(std::size_t size)
+  {
+    std::mt19937_64 gen(47);
+    std::uniform_int_distribution<std::int64_t> dist(-100'000'000, 100'000'000);
+    std::vector<io1::money> amounts(size);
+    for (auto & amount : amounts) { amount = io1::money{dist(gen)}; }
+    amounts[0] = io1::money{std::numeric_limits<std::int64_t>::lowest()};
+    amounts[1] = io1::money{std::numeric_limits<std::int64_t>::max()};
+    amounts[2] = 0_money;
+    amounts[3] = io1::money{-7};
+    return amounts;
+  }
+
+  std::string one_by_one(std::string_view spec, std::vector<io1::money> const & amounts, std::string_view separator,
+                         std::locale const & locale)
+  {
+    auto const field = "{:" + std::string(spec) + '}';
+    std::string text;
+    for (auto const amount : amounts)
+    {
+      text += std::vformat(locale, field, std::make_format_args(amount));
+      text += separator;
+    }
+    return text;
+  }
+} // namespace
+
+TEST_CASE("Same text as std::format")
+{
+  auto const amounts = column(20'000);
+  std::locale const grouping(std::locale::classic(), new grouping_moneypunct);
+  std::locale const custom(grouping, new custom_money_put);
+
+  for (std::string_view const spec :
+       {"", "+", "m", "#m", "M", "#M", ">20m", "pen_US", "#pfr_FR:EUR", "*^24#pde_CH:CHF"})
+  {
+    for (auto const & locale : {std::locale::classic(), grouping, custom})
+    {
+      auto const expected = one_by_one(spec, amounts, ";\n", locale);
+      for (std::size_t threads : {1, 3})
+      {
+        io1::bulk_format const layout(spec, amounts, ";\n", locale, threads);
+        CHECK_EQ(expected.size(), layout.size());
+        std::string text(layout.size() + 1, '?');
+        CHECK_EQ(text.data() + layout.size(), layout.write(text.data()));
+        CHECK_EQ('?', text.back());
+        text.pop_back();
+        CHECK_EQ(expected, text);
+      }
+    }
+  }
+
+  CHECK_EQ("$12.34 -$5.00 ", io1::format_bulk("#pen_US:USD", std::vector{12.34_money, -5.00_money}, " "));
+  CHECK_EQ("", io1::format_bulk("m", std::vector<io1::money>{}));
+  CHECK_THROWS_AS((void)io1::format_bulk("pxx_XX", amounts), std::format_error);
+  CHECK_THROWS_AS((void)io1::format_bulk("mz", amounts), std::format_error);
+}
@@ -0,0 +1,29 @@
+// Included first and alone: the core must not depend on what other headers include.
+#include "io1/money_core.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+TEST_CASE("Arithmetic of the core header")
+{
+  static_assert(std::is_same_v<io1::detail::observer, io1::null_observer>);
+  static_assert(12.34_money == 10.00_money + 2.34_money);
+  static_assert(-1'234_money128 == io1::money128{-1'234});
+
+  auto amount = 10.00_money;
+  amount *= 1.5;
+  CHECK_EQ(15.00_money, amount);
+  CHECK_THROWS_AS(amount /= 7, io1::money::InexactDivision);
+  CHECK_EQ(5.00_money, amount / 3);
+
+  auto const [quot, rem] = io1::div(amount, 4);
+  CHECK_EQ(3.75_money, quot);
+  CHECK_EQ(0_money, rem);
+
+  CHECK_EQ(io1::money32{1'500}, io1::money_cast<io1::money32>(amount));
+  CHECK_THROWS_AS((void)io1::money_cast<io1::money32>(io1::money{std::int64_t{1} << 40U}), std::overflow_error);
+}
@@ -0,0 +1,175 @@
+#include "io1/money_currency.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  using usd = io1::tagged_money<io1::currency<"USD">>;
+  using eur = io1::tagged_money<io1::currency<"EUR">>;
+  using jpy = io1::tagged_money<io1::currency<"JPY">>;
+  using kwd = io1::tagged_money<io1::currency<"KWD">>;
+
+  // not an ISO 4217 currency
+  struct satoshi_tag
+  {
+    static constexpr std::string_view code = "BTC";
+    static constexpr unsigned minor_unit = 8;
+  };
+  using btc = io1::tagged_money<satoshi_tag>;
+
+  template <class L, class R>
+  concept addable = requires(L l, R r) { l + r; };
+
+  template <class L, class R>
+  concept comparable = requires(L l, R r) { l == r; };
+
+  template <class T>
+  io1::money parse(std::string_view text, std::errc expected_ec = {},
+                   std::size_t expected_size = std::string_view::npos)
+  {
+    T value{-1};
+    auto const [ptr, ec] = from_chars(text.data(), text.data() + text.size(), value);
+    CHECK(expected_ec == ec);
+    CHECK_EQ(std::min(expected_size, text.size()), static_cast<std::size_t>(ptr - text.data()));
+    return value.amount();
+  }
+
+  template <class T>
+  std::string to_string(T value)
+  {
+    char buffer[32];
+    auto const [ptr, ec] = to_chars(std::begin(buffer), std::end(buffer), value);
+    CHECK(std::errc{} == ec);
+    return {std::begin(buffer), ptr};
+  }
+} // namespace
+
+TEST_CASE("ISO 4217 table")
+{
+  static_assert(2 == io1::find_currency("USD")->minor_unit);
+  static_assert(0 == io1::find_currency("JPY")->minor_unit);
+  static_assert(3 == io1::find_currency("BHD")->minor_unit);
+  static_assert(978 == io1::find_currency("EUR")->numeric);
+  static_assert("CHF" == io1::find_currency(std::uint16_t{756})->code);
+  static_assert(nullptr == io1::find_currency("XYZ"));
+  static_assert(nullptr == io1::find_currency(std::uint16_t{1}));
+  static_assert("ZWG" == io1::find_currency(std::uint16_t{924})->code);
+  static_assert("VED" == io1::find_currency(std::uint16_t{926})->code);
+  static_assert("XCG" == io1::find_currency(std::uint16_t{532})->code);
+  static_assert(nullptr == io1::find_currency("ANG") && nullptr == io1::find_currency("ZWL")); // withdrawn
+  static_assert(nullptr == io1::find_currency("XAU")); // precious metals are not currencies
+
+  for (auto const & info : io1::currencies())
+  {
+    CHECK_EQ(&info, io1::find_currency(info.code));
+    CHECK_EQ(&info, io1::find_currency(info.numeric));
+  }
+
+  static_assert("EUR" == io1::currency<"EUR">::code);
+  static_assert(4 == io1::currency<"CLF">::minor_unit);
+  static_assert(840 == io1::currency<"USD">::numeric);
+}
+
+TEST_CASE("Tagged money type safety")
+{
+  static_assert(sizeof(usd) == sizeof(io1::money) && std::is_trivially_copyable_v<btc>);
+  static_assert(addable<usd, usd> && comparable<usd, usd>);
+  static_assert(!addable<usd, eur> && !comparable<usd, eur>);
+  static_assert(!addable<usd, io1::money> && !comparable<usd, io1::money>);
+  static_assert(!std::is_convertible_v<io1::money, usd> && !std::is_convertible_v<usd, io1::money>);
+  static_assert(!std::is_constructible_v<usd, double>);
+  static_assert(!std::is_constructible_v<usd, eur>);
+}
+
+TEST_CASE("Tagged money arithmetic")
+{
+  constexpr usd a{1'050};
+  constexpr usd b{250};
+  static_assert(usd{1'300} == a + b);
+  static_assert(usd{800} == a - b);
+  static_assert(usd{-250} == -b);
+  static_assert(usd{2'100} == a * 2);
+  static_assert(usd{2'100} == 2 * a);
+  static_assert(usd{525} == a / 2);
+  static_assert(a > b);
+
+  CHECK_THROWS_AS((void)(a / 4), io1::money::InexactDivision);
+  CHECK_EQ(usd{1'575}, 1.5 * a);
+  CHECK_EQ(usd{840}, a / 1.25);
+
+  auto c = a;
+  CHECK_EQ(usd{1'050}, c++);
+  CHECK_EQ(usd{1'052}, ++c);
+  c -= b;
+  CHECK_EQ(usd{802}, c);
+  CHECK_EQ(802_money, c.amount());
+}
+
+TEST_CASE("Tagged money to_chars")
+{
+  CHECK_EQ("12.30", to_string(usd{1'230}));
+  CHECK_EQ("-0.05", to_string(usd{-5}));
+  CHECK_EQ("0.00", to_string(usd{0}));
+  CHECK_EQ("1230", to_string(jpy{1'230}));
+  CHECK_EQ("-1.230", to_string(kwd{-1'230}));
+  CHECK_EQ("0.00000001", to_string(btc{1}));
+  CHECK_EQ("-92233720368547758.08", to_string(usd{std::numeric_limits<std::int64_t>::lowest()}));
+  CHECK_EQ("92233720368547758.07", to_string(usd{std::numeric_limits<std::int64_t>::max()}));
+
+  char small[4];
+  auto const [ptr, ec] = to_chars(std::begin(small), std::end(small), usd{1'230});
+  CHECK(std::errc::value_too_large == ec);
+  CHECK_EQ(std::end(small), ptr);
+
+  std::ostringstream stream;
+  stream << kwd{12'345};
+  CHECK_EQ("12.345", stream.str());
+}
+
+TEST_CASE("Tagged money from_chars")
+{
+  CHECK_EQ(io1::money{1'230}, parse<usd>("12.30"));
+  CHECK_EQ(io1::money{1'230}, parse<usd>("12.3"));
+  CHECK_EQ(io1::money{1'200}, parse<usd>("12"));
+  CHECK_EQ(io1::money{-5}, parse<usd>("-0.05"));
+  CHECK_EQ(io1::money{50}, parse<usd>(".5"));
+  CHECK_EQ(io1::money{1'234}, parse<usd>("12.345", {}, 5));
+  CHECK_EQ(io1::money{1'200}, parse<usd>("12.", {}, 2));
+  CHECK_EQ(io1::money{1'200}, parse<usd>("12 USD", {}, 2));
+  CHECK_EQ(io1::money{-1}, parse<usd>("abc", std::errc::invalid_argument, 0));
+  CHECK_EQ(io1::money{-1}, parse<usd>("-", std::errc::invalid_argument, 0));
+  CHECK_EQ(io1::money{-1}, parse<usd>("92233720368547758.08", std::errc::result_out_of_range));
+  CHECK_EQ(io1::money{std::numeric_limits<std::int64_t>::lowest()}, parse<usd>("-92233720368547758.08"));
+  CHECK_EQ(io1::money{1'234}, parse<jpy>("1234.56", {}, 4));
+  CHECK_EQ(io1::money{123'456'789}, parse<btc>("1.23456789"));
+
+  constexpr auto constant = []
+  {
+    std::string_view const text = "-7.5";
+    kwd value{};
+    from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+  }();
+  static_assert(kwd{-7'500} == constant);
+}
+
+TEST_CASE("Tagged money format")
+{
+  CHECK_EQ("12.30", std::format("{}", usd{1'230}));
+  CHECK_EQ("1230", std::format("{}", jpy{1'230}));
+  CHECK_EQ("12.30 USD", std::format("{:#}", usd{1'230}));
+  CHECK_EQ("   12.30", std::format("{:>8}", usd{1'230}));
+  CHECK_EQ("-1.230 KWD**", std::format("{:*<12#}", kwd{-1'230}));
+  CHECK_EQ("0.00000001 BTC", std::format("{:#}", btc{1}));
+}
@@ -0,0 +1,98 @@
+#include "io1/money_filter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  std::vector<io1::money> random_amounts(std::size_t size, std::int64_t magnitude)
+  {
+    std::mt19937_64 gen(size);
+    std::uniform_int_distribution<std::int64_t> dist(-magnitude, magnitude);
+    std::vector<io1::money> result;
+    result.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) result.emplace_back(dist(gen));
+    return result;
+  }
+} // namespace
+
+TEST_CASE("Selection bitmap")
+{
+  io1::selection_bitmap bitmap(130);
+  CHECK_EQ(130, bitmap.size());
+  CHECK_EQ(3, bitmap.words().size());
+  CHECK_EQ(0, bitmap.count());
+
+  bitmap.set(0);
+  bitmap.set(64);
+  bitmap.set(129);
+  CHECK(bitmap.test(64));
+  CHECK_FALSE(bitmap.test(65));
+  CHECK_EQ(3, bitmap.count());
+
+  std::vector<std::size_t> rows;
+  bitmap.for_each([&rows](std::size_t i) { rows.push_back(i); });
+  CHECK(std::vector<std::size_t>{0, 64, 129} == rows);
+}
+
+TEST_CASE("Range filters match scalar comparisons")
+{
+  for (std::size_t const size : {0, 1, 3, 63, 64, 65, 1000, 4099})
+  {
+    auto const values = random_amounts(size, 100);
+    auto const lower = -50_money;
+    auto const upper = 0_money;
+
+    auto const bitmap = io1::select_between(values, lower, upper);
+    std::vector<std::size_t> indices;
+    CHECK_EQ(bitmap.count(), io1::select_indices(values, lower, upper, indices));
+
+    std::vector<std::size_t> expected;
+    auto expected_sum = 0_money;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      auto const selected = lower <= values[i] && values[i] <= upper;
+      CHECK_EQ(selected, bitmap.test(i));
+      if (selected)
+      {
+        expected.push_back(i);
+        expected_sum += values[i];
+      }
+    }
+    CHECK(expected == indices);
+    CHECK_EQ(expected_sum, io1::gather_sum(values, bitmap));
+    CHECK_EQ(expected_sum, io1::gather_sum(values, indices));
+
+    std::vector<io1::money> gathered;
+    io1::gather(values, bitmap, gathered);
+    REQUIRE_EQ(expected.size(), gathered.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) CHECK_EQ(values[expected[i]], gathered[i]);
+  }
+}
+
+TEST_CASE("Range filter bounds")
+{
+  std::vector<io1::money> const values{-9'223'372'036'854'775'807_money - 1_money, -1_money, 0_money,
+                                       10'000.00_money, 10'000.01_money, 9'223'372'036'854'775'807_money};
+
+  CHECK_EQ(3, io1::select_at_least(values, 10'000.00_money).count());
+  CHECK_EQ(2, io1::select_at_least(values, ++10'000.00_money).count());
+  CHECK_EQ(2, io1::select_at_most(values, -1_money).count());
+  CHECK_EQ(values.size(), io1::select_at_least(values, -9'223'372'036'854'775'807_money - 1_money).count());
+  CHECK_EQ(0, io1::select_between(values, 1_money, -1_money).count());
+
+  // composing filters without copying amounts
+  auto const refunds = io1::select_at_most(values, -1_money);
+  auto const large = io1::select_at_least(values, 10'000.00_money);
+  auto const either = refunds | large;
+  CHECK_EQ(5, either.count());
+  CHECK_EQ(0, (refunds & large).count());
+  CHECK_EQ(10'000.00_money + 10'000.01_money,
+           io1::gather_sum(values, io1::select_between(values, 1_money, 20'000.00_money)));
+}
@@ -0,0 +1,148 @@
+#include "io1/money_fx.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  constexpr std::uint16_t usd = 840;
+  constexpr std::uint16_t eur = 978;
+  constexpr std::uint16_t gbp = 826;
+  constexpr std::uint16_t jpy = 392;
+  constexpr std::uint16_t kwd = 414;
+  constexpr std::uint16_t chf = 756;
+
+  io1::fx_table make_table()
+  {
+    io1::fx_table table(usd);
+    table.set_rate(eur, {108'345, 100'000}); // 1 EUR = 1.08345 USD
+    table.set_rate(gbp, {12'712, 10'000});   // 1 GBP = 1.2712 USD
+    table.set_rate(jpy, {1, 150});           // 1 USD = 150 JPY
+    table.set_rate(kwd, {3'25, 1'00});       // 1 KWD = 3.25 USD
+    return table;
+  }
+} // namespace
+
+TEST_CASE("FX rates")
+{
+  auto const table = make_table();
+  CHECK_EQ(usd, table.pivot());
+  CHECK(io1::fx_rate{21'669, 20'000} == table.rate(eur, usd));
+  CHECK(io1::fx_rate{20'000, 21'669} == table.rate(usd, eur));
+  CHECK(io1::fx_rate{1, 1} == table.rate(chf, chf));
+
+  // triangulated through the pivot: 1.08345 / 1.2712
+  CHECK(io1::fx_rate{21'669, 25'424} == table.rate(eur, gbp));
+
+  // direct rates take precedence, in both directions
+  auto direct = table;
+  direct.set_rate(eur, gbp, {85, 100});
+  CHECK(io1::fx_rate{17, 20} == direct.rate(eur, gbp));
+  CHECK(io1::fx_rate{20, 17} == direct.rate(gbp, eur));
+
+  CHECK_THROWS_AS((void)table.rate(chf, usd), io1::fx_table::MissingRate);
+  CHECK_THROWS_AS(direct.set_rate(usd, {2, 1}), std::invalid_argument);
+  CHECK_THROWS_AS(direct.set_rate(1, {2, 1}), std::invalid_argument);
+  CHECK_THROWS_AS(io1::fx_table(2), std::invalid_argument);
+
+  // rates are positive fractions
+  for (auto const rate : {io1::fx_rate{1, 0}, io1::fx_rate{0, 1}, io1::fx_rate{-2, 1}, io1::fx_rate{2, -1}})
+  {
+    CHECK_THROWS_WITH_AS(direct.set_rate(eur, rate), "io1::fx_table: rates must be positive.", std::invalid_argument);
+    CHECK_THROWS_WITH_AS(direct.set_rate(eur, gbp, rate), "io1::fx_table: rates must be positive.",
+                         std::invalid_argument);
+  }
+  CHECK(io1::fx_rate{17, 20} == direct.rate(eur, gbp));
+}
+
+TEST_CASE("FX minor unit rescaling")
+{
+  auto const table = make_table();
+  // 1 USD cent = 1.5 yen
+  CHECK(io1::fx_rate{3, 2} == table.minor_unit_factor(usd, jpy));
+  // 1 KWD fils = 0.325 USD cent
+  CHECK(io1::fx_rate{13, 40} == table.minor_unit_factor(kwd, usd));
+
+  CHECK_EQ(io1::money{15}, table.convert(10_money, usd, jpy));
+  CHECK_EQ(io1::money{2}, table.convert(1_money, usd, jpy));
+  CHECK_EQ(io1::money{1}, table.convert(1_money, usd, jpy, io1::rounding::toward_zero));
+  CHECK_EQ(325.00_money, table.convert(io1::money{100'000}, kwd, usd));
+  CHECK_EQ(io1::money{100'000}, table.convert(325.00_money, usd, kwd));
+  CHECK_EQ(io1::money{461'539}, table.convert(1'500.00_money, usd, kwd, io1::rounding::ceiling));
+  CHECK_EQ(io1::money{461'538}, table.convert(1'500.00_money, usd, kwd, io1::rounding::floor));
+
+  // EUR -> JPY through USD: 1.08345 * 150
+  CHECK_EQ(io1::money{16'252}, table.convert(100.00_money, eur, jpy));
+  CHECK_EQ(io1::money{-16'252}, table.convert(-100.00_money, eur, jpy));
+}
+
+TEST_CASE("FX batch conversion")
+{
+  auto const table = make_table();
+  std::uint16_t const ids[] = {usd, eur, gbp, jpy, kwd};
+
+  std::mt19937_64 gen(3);
+  std::uniform_int_distribution<std::int64_t> amounts(-10'000'000, 10'000'000);
+  std::uniform_int_distribution<std::size_t> pick(0, 4);
+  std::size_t const size = 300'000;
+  std::vector<io1::money> values(size);
+  std::vector<std::uint16_t> currencies(size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    values[i] = io1::money{amounts(gen)};
+    currencies[i] = ids[pick(gen)];
+  }
+
+  for (auto const mode : {io1::rounding::half_even, io1::rounding::floor})
+  {
+    std::vector<io1::money> parallel(size);
+    table.convert(values, currencies, eur, parallel, mode);
+    std::vector<io1::money> sequential(size);
+    table.convert(values, currencies, eur, sequential, mode, 1);
+    CHECK(parallel == sequential);
+
+    bool same = true;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      same = same && parallel[i] == table.convert(values[i], currencies[i], eur, mode);
+    }
+    CHECK(same);
+  }
+
+  currencies[size / 2] = chf;
+  std::vector<io1::money> out(size);
+  CHECK_THROWS_AS(table.convert(values, currencies, eur, out), io1::fx_table::MissingRate);
+  CHECK_THROWS_AS(table.convert(values, currencies, 2, out), std::invalid_argument);
+}
+
+TEST_CASE("FX overflow")
+{
+  io1::fx_table table(usd);
+  table.set_rate(eur, {2, 1});
+  CHECK_EQ(io1::money{std::numeric_limits<std::int64_t>::max() / 2 * 2},
+           table.convert(io1::money{std::numeric_limits<std::int64_t>::max() / 2}, eur, usd));
+  CHECK_THROWS_AS((void)table.convert(io1::money{std::numeric_limits<std::int64_t>::max()}, eur, usd),
+                  std::overflow_error);
+
+  // terms that would no longer fit in 64 bits once triangulated
+  table.set_rate(gbp, {999'999'999'989, 999'999'999'959});
+  table.set_rate(chf, {999'999'999'961, 999'999'999'937});
+  CHECK_THROWS_AS((void)table.rate(gbp, chf), std::overflow_error);
+
+  // only the rows whose factor is out of range are an error
+  std::vector<io1::money> const values = {1.00_money, 2.00_money};
+  std::vector<std::uint16_t> currencies = {usd, eur};
+  std::vector<io1::money> out(2);
+  table.convert(values, currencies, chf, out);
+  CHECK_EQ(table.convert(2.00_money, eur, chf), out[1]);
+  currencies[1] = gbp;
+  CHECK_THROWS_AS(table.convert(values, currencies, chf, out), std::overflow_error);
+}
@@ -0,0 +1,206 @@
+#include "io1/money_journal.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  struct posting
+  {
+    std::uint64_t account;
+    io1::money amount;
+  };
+
+  // a journal file in the temporary directory that is removed at the end of the test
+  struct temporary_journal
+  {
+    explicit temporary_journal(std::string const & name)
+        : path(std::filesystem::temp_directory_path() / ("io1_" + name + ".journal"))
+    {
+      std::filesystem::remove(path);
+    }
+    temporary_journal(temporary_journal const &) = delete;
+    temporary_journal(temporary_journal &&) = delete;
+    temporary_journal & operator=(temporary_journal const &) = delete;
+    temporary_journal & operator=(temporary_journal &&) = delete;
+    ~temporary_journal() noexcept { std::filesystem::remove(path); }
+
+    std::filesystem::path path;
+  };
+
+  auto replay(std::filesystem::path const & path)
+  {
+    std::vector<posting> postings;
+    auto const recovery =
+        io1::journal<posting>::recover(path, [&postings](posting const & p) { postings.push_back(p); });
+    return std::make_pair(recovery, postings);
+  }
+} // namespace
+
+TEST_CASE("Journal append and replay")
+{
+  temporary_journal const tmp("append");
+
+  {
+    io1::journal<posting> journal(tmp.path);
+    CHECK_EQ(0, journal.recovery().records);
+    CHECK_EQ(0, journal.append({1, 10.50_money}));
+    CHECK_EQ(1, journal.append({2, -3.25_money}));
+    journal.commit(1);
+    CHECK_EQ(2, journal.append({1, 0.01_money}));
+    journal.commit();
+  }
+
+  auto const [recovery, postings] = replay(tmp.path);
+  CHECK_EQ(3, recovery.records);
+  CHECK_EQ(0, recovery.truncated_bytes);
+  REQUIRE_EQ(3, postings.size());
+  CHECK_EQ(1, postings[0].account);
+  CHECK_EQ(10.50_money, postings[0].amount);
+  CHECK_EQ(2, postings[1].account);
+  CHECK_EQ(-3.25_money, postings[1].amount);
+  CHECK_EQ(0.01_money, postings[2].amount);
+
+  // reopening continues the sequence
+  io1::journal<posting> journal(tmp.path);
+  CHECK_EQ(3, journal.recovery().records);
+  CHECK_EQ(3, journal.append({3, 1_money}));
+  CHECK_THROWS_AS(journal.commit(4), std::out_of_range);
+}
+
+TEST_CASE("Journal group commit")
+{
+  temporary_journal const tmp("group");
+
+  constexpr std::uint64_t threads = 8;
+  constexpr std::uint64_t per_thread = 500;
+
+  {
+    io1::journal<posting> journal(tmp.path, {.policy = io1::fsync_policy::periodic, .sync_interval = 16});
+    std::vector<std::thread> workers;
+    for (std::uint64_t t = 0; t < threads; ++t)
+    {
+      workers.emplace_back(
+          [&journal, t]()
+          {
+            for (std::uint64_t i = 0; i < per_thread; ++i)
+            {
+              journal.commit(journal.append({t, io1::money(static_cast<std::int64_t>(i))}));
+            }
+          });
+    }
+    for (auto & worker : workers) worker.join();
+    journal.sync();
+    CHECK_EQ(threads * per_thread, journal.size());
+  }
+
+  auto const [recovery, postings] = replay(tmp.path);
+  CHECK_EQ(threads * per_thread, recovery.records);
+
+  // records of each writer are persisted in order
+  std::vector<io1::money> next(threads, 0_money);
+  for (auto const & p : postings)
+  {
+    CHECK_EQ(next[p.account], p.amount);
+    ++next[p.account];
+  }
+}
+
+TEST_CASE("Journal max pending")
+{
+  temporary_journal const tmp("pending");
+  {
+    io1::journal<posting> journal(tmp.path, {.policy = io1::fsync_policy::never, .max_pending = 2});
+    for (std::uint64_t i = 0; i < 5; ++i) { static_cast<void>(journal.append({i, 1_money})); }
+    CHECK_EQ(io1::journal<posting>::header_size + 4 * io1::journal<posting>::frame_size,
+             std::filesystem::file_size(tmp.path));
+  }
+  CHECK_EQ(5, replay(tmp.path).first.records);
+}
+
+TEST_CASE("Journal recovery truncates torn tail")
+{
+  temporary_journal const tmp("torn");
+  {
+    io1::journal<posting> journal(tmp.path);
+    for (std::uint64_t i = 0; i < 10; ++i) { static_cast<void>(journal.append({i, 2_money})); }
+    journal.commit();
+  }
+
+  auto const full_size = std::filesystem::file_size(tmp.path);
+  std::filesystem::resize_file(tmp.path, full_size - 3);
+
+  auto const [recovery, postings] = replay(tmp.path);
+  CHECK_EQ(9, recovery.records);
+  CHECK_EQ(io1::journal<posting>::frame_size - 3, recovery.truncated_bytes);
+  CHECK_EQ(full_size - io1::journal<posting>::frame_size, std::filesystem::file_size(tmp.path));
+  CHECK_EQ(9, postings.size());
+
+  io1::journal<posting> journal(tmp.path);
+  CHECK_EQ(9, journal.append({9, 3_money}));
+  journal.commit();
+}
+
+TEST_CASE("Journal recovery stops at a corrupted record")
+{
+  temporary_journal const tmp("corrupted");
+  {
+    io1::journal<posting> journal(tmp.path);
+    for (std::uint64_t i = 0; i < 10; ++i) { static_cast<void>(journal.append({i, 2_money})); }
+    journal.commit();
+  }
+
+  {
+    // flip one byte in the amount of the 7th record
+    std::fstream file(tmp.path, std::ios::in | std::ios::out | std::ios::binary);
+    auto const offset = io1::journal<posting>::header_size + 6 * io1::journal<posting>::frame_size +
+                        sizeof(std::uint32_t) + sizeof(std::uint64_t);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.put('\x7F');
+  }
+
+  auto const [recovery, postings] = replay(tmp.path);
+  CHECK_EQ(6, recovery.records);
+  CHECK_EQ(4 * io1::journal<posting>::frame_size, recovery.truncated_bytes);
+  CHECK_EQ(6, postings.size());
+}
+
+TEST_CASE("Journal rejects foreign files")
+{
+  temporary_journal const tmp("foreign");
+  {
+    io1::journal<posting> journal(tmp.path);
+  }
+  CHECK_THROWS_AS(io1::journal<io1::money>{tmp.path}, io1::journal<io1::money>::BadHeader);
+}
+
+TEST_CASE("Journal recovery of a header torn while being created")
+{
+  temporary_journal const tmp("short");
+  CHECK_EQ(0, replay(tmp.path).first.records);
+  CHECK_EQ(io1::journal<posting>::header_size, std::filesystem::file_size(tmp.path));
+
+  // the first bytes of a header are restored to a full one
+  std::filesystem::resize_file(tmp.path, 5);
+  auto const [recovery, postings] = replay(tmp.path);
+  CHECK_EQ(0, recovery.records);
+  CHECK_EQ(5, recovery.truncated_bytes);
+  CHECK_EQ(io1::journal<posting>::header_size, std::filesystem::file_size(tmp.path));
+
+  // other short files are not journals and are left untouched
+  {
+    std::ofstream file(tmp.path, std::ios::binary | std::ios::trunc);
+    file << "hello";
+  }
+  CHECK_THROWS_AS(replay(tmp.path), io1::journal<posting>::BadHeader);
+  CHECK_THROWS_AS(io1::journal<posting>{tmp.path}, io1::journal<posting>::BadHeader);
+  CHECK_EQ(5, std::filesystem::file_size(tmp.path));
+}
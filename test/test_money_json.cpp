@@ -0,0 +1,175 @@
+#include "io1/money_json.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  // Events as text, to compare them at once.
+  struct recorder
+  {
+    std::string events;
+
+    void on_object_begin() { events += '{'; }
+    void on_object_end() { events += '}'; }
+    void on_array_begin() { events += '['; }
+    void on_array_end() { events += ']'; }
+    void on_key(std::string_view key) { events.append("k:").append(key).append(" "); }
+    void on_amount(io1::money amount) { events.append(std::to_string(amount.data())).append(" "); }
+    void on_string(std::string_view text) { events.append("s:").append(text).append(" "); }
+    void on_bool(bool value) { events += value ? "true " : "false "; }
+    void on_null() { events += "null "; }
+  };
+
+  std::string events(std::string_view json, unsigned digits = 2)
+  {
+    recorder handler;
+    io1::parse_json(json, handler, digits);
+    return handler.events;
+  }
+
+  std::string error(std::string_view json, unsigned digits = 2)
+  {
+    try
+    {
+      (void)events(json, digits);
+    }
+    catch (std::exception const & e)
+    {
+      return e.what();
+    }
+    return {};
+  }
+} // namespace
+
+TEST_CASE("JSON writer")
+{
+  std::string json;
+  io1::json_writer writer(json);
+  std::vector const amounts{12.34_money, -0.05_money, 0_money};
+  writer.begin_object()
+      .key("total")
+      .amount(-1'234'567.89_money)
+      .key("lines")
+      .amounts(amounts)
+      .key("empty")
+      .amounts({})
+      .key("meta")
+      .begin_array()
+      .string("a\"b\\c\nd\x01")
+      .boolean(true)
+      .null()
+      .begin_object()
+      .end_object()
+      .end_array()
+      .end_object();
+  CHECK_EQ(R"({"total":-1234567.89,"lines":[12.34,-0.05,0.00],"empty":[],"meta":["a\"b\\c\nd\u0001",true,null,{}]})",
+           json);
+
+  json.clear();
+  io1::json_writer(json, 0).amount(io1::money{-42});
+  CHECK_EQ("-42", json);
+}
+
+TEST_CASE("JSON reader")
+{
+  CHECK_EQ("{k:total -123456789 k:lines [1234 -5 0 ]k:meta [s:a\"b\\c/\n\t true false null {}[]]}",
+           events(R"( { "total" : -1234567.89, "lines": [12.34, -0.05, 0],
+                        "meta": ["a\"b\\c\/\n\t", true, false, null, {}, []] } )"));
+
+  // numbers are exact, whatever their notation
+  CHECK_EQ("[1500 1500 1500 -1 120 0 0 ]",
+           events("[15, 1.5e1, 150E-1, -0.010, 1.2000000000000000000000000e0, 0e9, -0.0]"));
+  CHECK_EQ("100 ", events("1e-16", 18));
+  CHECK_EQ("12 ", events("12", 0));
+
+  // escaped strings, including code points beyond the basic plane
+  CHECK_EQ("s:\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80 ", events(R"("\u00e9\u20AC\ud83d\ude00")"));
+
+  std::vector<io1::money> amounts;
+  io1::parse_money_array("[1, 2.5]", amounts);
+  io1::parse_money_array(" [ ] ", amounts);
+  CHECK((std::vector{1.00_money, 2.50_money} == amounts));
+  CHECK_THROWS_AS(io1::parse_money_array("[1, [2]]", amounts), std::invalid_argument);
+  CHECK_THROWS_AS(io1::parse_money_array("[1, \"2\"]", amounts), std::invalid_argument);
+  CHECK_THROWS_AS(io1::parse_money_array("1", amounts), std::invalid_argument);
+}
+
+TEST_CASE("Invalid JSON")
+{
+  CHECK_EQ("io1::parse_json: unexpected end at offset 0.", error(""));
+  CHECK_EQ("io1::parse_json: unexpected end at offset 4.", error("[1, "));
+  CHECK_EQ("io1::parse_json: expected a comma at offset 3.", error("[1 2]"));
+  CHECK_EQ("io1::parse_json: unexpected character at offset 2.", error("[]]"));
+  CHECK_EQ("io1::parse_json: unexpected character at offset 3.", error("[1,]"));
+  CHECK_EQ("io1::parse_json: expected a comma at offset 6.", error("{\"a\":1]"));
+  CHECK_EQ("io1::parse_json: expected a key at offset 1.", error("{1:2}"));
+  CHECK_EQ("io1::parse_json: expected a colon at offset 5.", error("{\"a\" 1}"));
+  CHECK_EQ("io1::parse_json: invalid literal at offset 1.", error("[tru]"));
+  CHECK_EQ("io1::parse_json: unterminated string at offset 4.", error("\"abc"));
+  CHECK_EQ("io1::parse_json: invalid escape at offset 2.", error("\"\\x\""));
+  CHECK_EQ("io1::parse_json: unpaired surrogate at offset 7.", error("\"\\ud83d\""));
+  CHECK_EQ("io1::parse_json: control character in string at offset 3.", error("\"\\n\n\""));
+  CHECK_EQ("io1::parse_json: invalid number at offset 2.", error("1.e2"));
+  CHECK_EQ("io1::parse_json: unexpected character at offset 1.", error("01"));
+  CHECK_EQ("io1::parse_json: unexpected character at offset 1.", error("-x"));
+  CHECK_EQ("io1::parse_json: too deep nesting at offset 256.", error(std::string(257, '[')));
+
+  CHECK_EQ("io1::parse_json: amount at offset 1 has more than 2 fractional digits.", error("[0.125]"));
+  CHECK_EQ("io1::parse_json: amount at offset 0 has more than 0 fractional digits.", error("1e-1", 0));
+  CHECK_EQ("io1::parse_json: amount at offset 1 out of range.", error("[92233720368547758.08]"));
+  CHECK_EQ("io1::parse_json: amount at offset 0 out of range.", error("1e400"));
+  CHECK_EQ("io1::parse_json: amount at offset 0 out of range.", error(std::string(30, '9')));
+  CHECK_THROWS_AS((void)events("[1e17]"), std::overflow_error);
+
+  // digits beyond 64 bits are too precise or too large depending on where they fall
+  CHECK_EQ("io1::parse_json: amount at offset 0 has more than 2 fractional digits.",
+           error("1.0000000000000000000001"));
+  CHECK_THROWS_AS((void)events("1.0000000000000000000001"), std::invalid_argument);
+  CHECK_THROWS_AS((void)events("12345678901234567890123e-25"), std::invalid_argument);
+  CHECK_THROWS_AS((void)events("1.0000000000000000000001e22"), std::overflow_error);
+  std::vector<io1::money> amounts;
+  io1::parse_money_array("[100000000000000000000000e-23, 1.00000000000000000000000]", amounts);
+  CHECK((std::vector<io1::money>{1.00_money, 1.00_money} == amounts));
+
+  // events are sent up to the error
+  recorder handler;
+  CHECK_THROWS_AS(io1::parse_json("[1, 2, x]", handler), std::invalid_argument);
+  CHECK_EQ("[100 200 ", handler.events);
+}
+
+TEST_CASE("Exact round trip over the whole range")
+{
+  std::mt19937_64 gen(48);
+  std::uniform_int_distribution<std::int64_t> dist(std::numeric_limits<std::int64_t>::lowest(),
+                                                   std::numeric_limits<std::int64_t>::max());
+  std::vector<io1::money> amounts(10'000);
+  for (auto & amount : amounts) { amount = io1::money{dist(gen)}; }
+  amounts[0] = io1::money{std::numeric_limits<std::int64_t>::lowest()};
+  amounts[1] = io1::money{std::numeric_limits<std::int64_t>::max()};
+  amounts[2] = io1::money{-1};
+  amounts[3] = 0_money;
+
+  for (unsigned digits = 0; digits <= 18; ++digits)
+  {
+    std::string json;
+    io1::json_writer(json, digits).amounts(amounts);
+    std::vector<io1::money> parsed;
+    io1::parse_money_array(json, parsed, digits);
+    CHECK((amounts == parsed));
+  }
+
+  std::string json;
+  io1::json_writer(json, 2).amount(io1::money{std::numeric_limits<std::int64_t>::lowest()});
+  CHECK_EQ("-92233720368547758.08", json);
+  CHECK_EQ("io1::parse_json: amount at offset 0 out of range.", error("-92233720368547758.09"));
+}
@@ -0,0 +1,33 @@
+// Built into its own executable, with module support: the amounts come from the io1.money module.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <format>
+#include <locale>
+#include <sstream>
+
+#include <doctest/doctest.h>
+
+import io1.money;
+
+using namespace io1::literals;
+
+TEST_CASE("Amounts imported from the module")
+{
+  auto amount = 12.34_money + 2 * 1.00_money;
+  CHECK_EQ(io1::money{1'434}, amount);
+  CHECK_EQ(io1::money{2'151}, 1.5 * amount);
+  CHECK_EQ(io1::money32{1'434}, io1::money_cast<io1::money32>(amount));
+
+  auto const [quot, rem] = io1::div(amount, 100);
+  CHECK_EQ(14_money, quot);
+  CHECK_EQ(34_money, rem);
+
+  std::stringstream stream;
+  stream.imbue(std::locale::classic());
+  stream << amount << ' ' << io1::put_money(amount);
+  CHECK_EQ("1434 1434", stream.str());
+  stream >> amount;
+  CHECK_EQ(1'434_money128, io1::money128{amount});
+
+  CHECK_EQ("1434", std::format("{}", amount));
+}
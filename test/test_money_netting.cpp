@@ -0,0 +1,89 @@
+#include "io1/money_netting.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  // Positions once the transfers are paid.
+  std::vector<io1::money128::value_type> after(std::vector<io1::money128::value_type> positions,
+                                               std::vector<io1::settlement_transfer> const & transfers)
+  {
+    for (auto const & t : transfers)
+    {
+      CHECK(0_money < t.amount);
+      CHECK(positions[t.from] < 0);
+      CHECK(0 < positions[t.to]);
+      positions[t.from] += t.amount.data();
+      positions[t.to] -= t.amount.data();
+    }
+    return positions;
+  }
+} // namespace
+
+TEST_CASE("Settlement of a few parties")
+{
+  // 0 owes 1, which owes 2: 0 pays 2
+  std::vector<io1::obligation> const chain = {{0, 1, 10.00_money}, {1, 2, 10.00_money}, {2, 2, 5.00_money}};
+  auto const result = io1::net_obligations(chain, 3);
+  CHECK((std::vector<io1::money128::value_type>{-1'000, 0, 1'000} == result.positions));
+  CHECK((std::vector<io1::settlement_transfer>{{0, 2, 10.00_money}} == result.transfers));
+
+  // opposite positions of the same size are paired, the others settled largest first
+  std::vector<io1::money128::value_type> const positions = {-700, 300, -300, 500, 200};
+  CHECK((std::vector<io1::settlement_transfer>{{2, 1, 3.00_money}, {0, 3, 5.00_money}, {0, 4, 2.00_money}} ==
+         io1::settle(positions)));
+
+  CHECK(io1::settle(std::vector<io1::money128::value_type>(5, 0)).empty());
+  CHECK_THROWS_WITH_AS((void)io1::settle(std::vector<io1::money128::value_type>{-1, 2}),
+                       "io1::settle: positions do not sum to zero.", std::invalid_argument);
+  auto const huge = std::numeric_limits<io1::money128::value_type>::max();
+  CHECK_THROWS_AS((void)io1::settle(std::vector<io1::money128::value_type>{huge, huge, huge, -1}), std::overflow_error);
+  CHECK_THROWS_WITH_AS((void)io1::net_positions(chain, 2), "io1::net_positions: party out of range at index 1.",
+                       std::out_of_range);
+}
+
+TEST_CASE("Positions beyond the range of amounts")
+{
+  auto const max = io1::money{std::numeric_limits<std::int64_t>::max()};
+  std::vector<io1::obligation> const obligations(5, {1, 0, max});
+  auto const result = io1::net_obligations(obligations, 2);
+  CHECK_EQ(5 * static_cast<io1::money128::value_type>(max.data()), result.positions[0]);
+  CHECK((std::vector<io1::settlement_transfer>(5, {1, 0, max}) == result.transfers));
+}
+
+TEST_CASE("Netting of many obligations")
+{
+  std::mt19937_64 gen(50);
+  constexpr std::size_t parties = 1'000;
+  std::uniform_int_distribution<std::size_t> party(0, parties - 1);
+  std::uniform_int_distribution<std::int64_t> amount(-1'000'000, 10'000'000);
+  std::vector<io1::obligation> obligations(300'000);
+  std::vector<io1::money128::value_type> expected(parties, 0);
+  for (auto & o : obligations)
+  {
+    o = {party(gen), party(gen), io1::money{amount(gen)}};
+    expected[o.debtor] -= o.amount.data();
+    expected[o.creditor] += o.amount.data();
+  }
+
+  for (std::size_t threads : {1, 4})
+  {
+    auto const result = io1::net_obligations(obligations, parties, threads);
+    CHECK((expected == result.positions));
+    CHECK(result.transfers.size() < parties);
+    CHECK((std::vector<io1::money128::value_type>(parties, 0) == after(result.positions, result.transfers)));
+  }
+
+  obligations[200'000].creditor = parties;
+  CHECK_THROWS_WITH_AS((void)io1::net_positions(obligations, parties, 4),
+                       "io1::net_positions: party out of range at index 200000.", std::out_of_range);
+}
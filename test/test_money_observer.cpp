@@ -0,0 +1,123 @@
+// Built into its own executable: the observer must be the same in every translation unit.
+#define IO1_MONEY_OBSERVER io1::counting_observer
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "io1/money.hpp"
+
+#include <format>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  class dollar_moneypunct : public std::moneypunct<char, false>
+  {
+  private:
+    int do_frac_digits() const override { return 2; }
+    std::string do_negative_sign() const override { return "-"; }
+  };
+
+  class custom_money_put : public std::money_put<char>
+  {
+  };
+
+  std::locale dollars() { return {std::locale::classic(), new dollar_moneypunct}; }
+} // namespace
+
+static_assert(std::is_same_v<io1::detail::observer, io1::counting_observer>);
+
+TEST_CASE("Arithmetic events")
+{
+  io1::counting_observer::reset();
+
+  auto amount = 10.00_money;
+  CHECK_THROWS_AS(amount /= 3, io1::money::InexactDivision);
+  amount /= 5;
+  amount *= 1.5;   // 300, exact
+  amount *= 0.333; // 99.9, rounded
+  amount /= 8.;    // 12.5, rounded
+  amount += io1::money{1'023};
+  amount -= io1::money{4'096};
+
+  auto const counts = io1::counting_observer::snapshot();
+  CHECK_EQ(1, counts.inexact_divisions);
+  CHECK_EQ(3, counts.float_scalings);
+  CHECK_EQ(2, counts.float_roundings);
+  CHECK_EQ(12, counts.sum_bits); // -3'061
+
+  // the closer sums get to overflowing, the more bits they use
+  auto large = io1::money{std::numeric_limits<std::int64_t>::max() - 1};
+  large += io1::money{1};
+  CHECK_EQ(63, io1::counting_observer::snapshot().sum_bits);
+  auto huge = io1::money128{std::numeric_limits<std::int64_t>::min()};
+  huge -= io1::money128{std::numeric_limits<std::int64_t>::max()};
+  CHECK_EQ(64, io1::counting_observer::snapshot().sum_bits);
+
+  // constant evaluation is not observed
+  constexpr auto constant = 1_money + 2_money;
+  static_assert(3_money == constant);
+  CHECK_EQ(64, io1::counting_observer::snapshot().sum_bits);
+}
+
+TEST_CASE("Stream and format events")
+{
+  io1::counting_observer::reset();
+
+  std::istringstream in("1234 abc");
+  in.imbue(dollars());
+  io1::money amount{0};
+  in >> io1::get_money(amount);
+  CHECK_EQ(1'234, amount.data());
+  in >> io1::get_money(amount);
+
+  std::ostringstream out;
+  out.imbue(dollars());
+  out << io1::put_money(amount);
+  out.imbue(std::locale(dollars(), new custom_money_put));
+  out << io1::put_money(amount);
+
+  CHECK_EQ("1234", std::format("{}", 12.34_money));
+  (void)std::format(dollars(), "{:m}", amount);
+  (void)std::format("{:pen_US:USD}", amount);
+  (void)std::format(std::locale(dollars(), new custom_money_put), "{:m}", amount);
+
+  auto const counts = io1::counting_observer::snapshot();
+  CHECK_EQ(2, counts.get_money_calls);
+  CHECK_EQ(1, counts.get_money_failures);
+  CHECK_EQ(2, counts.put_money_calls);
+  CHECK_EQ(1, counts.put_money_fallbacks);
+  CHECK_EQ(4, counts.formats);
+  CHECK_EQ(1, counts.format_fallbacks);
+}
+
+TEST_CASE("Counts of all threads")
+{
+  io1::counting_observer::reset();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back(
+        []
+        {
+          auto amount = 1_money;
+          for (int i = 0; i < 1'000; ++i) { amount *= 1.001; }
+        });
+  }
+  for (auto & thread : threads) { thread.join(); }
+
+  auto const counts = io1::counting_observer::snapshot();
+  CHECK_EQ(4'000, counts.float_scalings);
+
+  io1::counting_observer::reset();
+  CHECK_EQ(io1::money_event_counts{}, io1::counting_observer::snapshot());
+}
@@ -0,0 +1,175 @@
+#include "io1/money_pipeline.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  std::vector<io1::money> collect(io1::money_batches batches, std::size_t batch_size = SIZE_MAX)
+  {
+    std::vector<io1::money> amounts;
+    for (auto const batch : batches)
+    {
+      CHECK(0 < batch.size());
+      CHECK(batch.size() <= batch_size);
+      amounts.insert(amounts.end(), batch.begin(), batch.end());
+    }
+    return amounts;
+  }
+
+  io1::money_batches parse(std::istream & in, std::size_t chunk_size, std::size_t batch_size = 4'096)
+  {
+    return io1::parse_amounts(io1::read_chunks(in, chunk_size), 2, batch_size);
+  }
+
+  io1::money_batches failing(std::size_t batches)
+  {
+    std::vector<io1::money> const batch(10, 1_money);
+    for (std::size_t i = 0; i < batches; ++i) { co_yield std::span<io1::money const>(batch); }
+    throw std::runtime_error("feed interrupted");
+  }
+} // namespace
+
+TEST_CASE("Amounts parsed from chunks of any size")
+{
+  std::string const feed = "12.34 -0.5\n\n  7\t-1234567.89\r\n1 .25 ";
+  std::vector<io1::money> const expected = {12.34_money, -0.50_money, 7.00_money, -1'234'567.89_money, 1.00_money,
+                                            0.25_money};
+
+  for (std::size_t chunk_size : {1, 2, 3, 7, 64})
+  {
+    std::istringstream in(feed);
+    CHECK(expected == collect(parse(in, chunk_size, 4), 4));
+  }
+
+  std::istringstream empty("  \n ");
+  CHECK(collect(parse(empty, 16)).empty());
+
+  // a batch is valid until the next one is asked for
+  std::istringstream three("0.01 0.02 0.03");
+  auto doubled = io1::transform(parse(three, 4, 1), [](io1::money m) noexcept { return 2 * m; });
+  CHECK((std::vector<io1::money>{0.02_money, 0.04_money, 0.06_money} == collect(std::move(doubled), 1)));
+}
+
+TEST_CASE("Invalid feeds")
+{
+  auto const check_error = [](std::string const & feed, std::size_t chunk_size)
+  {
+    std::istringstream in(feed);
+    std::vector<io1::money> amounts;
+    try
+    {
+      for (auto const batch : parse(in, chunk_size, 2)) { amounts.insert(amounts.end(), batch.begin(), batch.end()); }
+    }
+    catch (std::exception const & e)
+    {
+      return std::string(e.what()) + " after " + std::to_string(amounts.size());
+    }
+    return std::string();
+  };
+
+  for (std::size_t chunk_size : {1, 5, 64})
+  {
+    CHECK_EQ("io1::parse_amounts: invalid amount at index 2. after 2", check_error("1 2 1.2.3 4", chunk_size));
+    CHECK_EQ("io1::parse_amounts: invalid amount at index 1. after 0", check_error("1 1.234", chunk_size));
+    CHECK_EQ("io1::parse_amounts: amount at index 0 out of range. after 0",
+             check_error("92233720368547758.08", chunk_size));
+    CHECK_EQ("io1::parse_amounts: amount at index 0 out of range. after 0",
+             check_error(std::string(1'000, '1'), chunk_size));
+    CHECK_EQ("io1::parse_amounts: invalid amount at index 0. after 0",
+             check_error(std::string(1'000, 'x'), chunk_size));
+  }
+
+  // too long even without its leading zeros, wherever the chunks end
+  for (std::size_t chunk_size : {5, 40, 100, 200})
+  {
+    CHECK_EQ("io1::parse_amounts: invalid amount at index 1. after 0",
+             check_error("7 " + std::string(70, '0') + "1" + std::string(64, '.'), chunk_size));
+  }
+}
+
+TEST_CASE("Same amounts whatever the chunk size")
+{
+  // leading zeros make tokens longer than the longest amount
+  std::string const feed = "  " + std::string(70, '0') + "1 5 -" + std::string(100, '0') + ".25 " +
+                           std::string(200, '0') + " 00012.5 -0 " + std::string(65, '0') + "92233720368547758.07\n";
+  std::vector<io1::money> const expected = {1.00_money, 5.00_money, -0.25_money, 0_money, 12.50_money, 0_money,
+                                            io1::money{std::numeric_limits<std::int64_t>::max()}};
+
+  for (std::size_t chunk_size : {1, 2, 3, 7, 40, 64, 65, 100, 1'000})
+  {
+    std::istringstream in(feed);
+    CHECK(expected == collect(parse(in, chunk_size, 3), 3));
+  }
+}
+
+TEST_CASE("Transformed and aggregated batches")
+{
+  std::mt19937_64 gen(46);
+  std::uniform_int_distribution<std::int64_t> dist(-1'000'000, 1'000'000);
+  std::string feed;
+  std::int64_t expected = 0;
+  for (int i = 0; i < 100'000; ++i)
+  {
+    auto const amount = dist(gen);
+    char buffer[32]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    auto const end = io1::detail::to_decimal_chars(buffer, buffer + sizeof(buffer), amount, 2).ptr;
+    feed.append(buffer, end).push_back('\n');
+    expected += 3 * amount;
+  }
+
+  for (std::size_t threads : {1, 4})
+  {
+    std::istringstream in(feed);
+    auto tripled = io1::transform(parse(in, 1'000, 50'000), [](io1::money m) noexcept { return 3 * m; }, threads);
+    auto const total = io1::aggregate(std::move(tripled), std::int64_t{0},
+                                      [](std::int64_t sum, std::span<io1::money const> batch) noexcept
+                                      {
+                                        for (auto const m : batch) { sum += m.data(); }
+                                        return sum;
+                                      });
+    CHECK_EQ(expected, total);
+  }
+}
+
+TEST_CASE("Buffered stages")
+{
+  std::string feed;
+  for (int i = 0; i < 10'000; ++i) { feed += std::to_string(i) + ".00 "; }
+  std::vector<io1::money> expected;
+  for (int i = 0; i < 10'000; ++i) { expected.emplace_back(i * 100); }
+
+  for (std::size_t depth : {1, 3})
+  {
+    std::istringstream in(feed);
+    CHECK(expected == collect(io1::buffered(parse(in, 100, 64), depth), 64));
+  }
+
+  // errors reach the consumer after the batches produced before them
+  std::size_t received = 0;
+  auto const consume = [&received]
+  {
+    for (auto const batch : io1::buffered(failing(5), 2)) { received += batch.size(); }
+  };
+  CHECK_THROWS_WITH_AS(consume(), "feed interrupted", std::runtime_error);
+  CHECK_EQ(50, received);
+
+  // the producer is stopped when the consumer stops early
+  std::istringstream in(feed);
+  auto batches = io1::buffered(parse(in, 100, 16), 1);
+  auto it = batches.begin();
+  CHECK_EQ(0_money, (*it)[0]);
+  ++it;
+  CHECK_EQ(16.00_money, (*it)[0]);
+}
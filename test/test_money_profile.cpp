@@ -0,0 +1,116 @@
+#include "io1/money_currency.hpp"
+#include "io1/money_profile.hpp"
+
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  // UTF-8 spelled out so that the expectations do not depend on the source encoding
+  std::string const euro = "\xE2\x82\xAC";
+  std::string const rupee = "\xE2\x82\xB9";
+  std::string const nbsp = "\xC2\xA0";
+  std::string const narrow_nbsp = "\xE2\x80\xAF";
+  std::string const apostrophe = "\xE2\x80\x99";
+} // namespace
+
+TEST_CASE("Currency symbols")
+{
+  static_assert("$" == io1::find_currency("USD")->symbol);
+  static_assert("\xE2\x82\xAC" == io1::find_currency("EUR")->symbol);
+  static_assert("CHF" == io1::find_currency("CHF")->symbol);
+  static_assert("CDF" == io1::find_currency("CDF")->symbol);
+
+  for (auto const & currency : io1::currencies()) { CHECK_FALSE(currency.symbol.empty()); }
+}
+
+TEST_CASE("Format profiles")
+{
+  static_assert(nullptr != io1::find_profile("en_US"));
+  static_assert(nullptr == io1::find_profile("xx_XX"));
+  for (auto const & profile : io1::format_profiles()) { CHECK_EQ(&profile, io1::find_profile(profile.name)); }
+
+  // no currency: no symbol and 2 digits
+  CHECK_EQ("1,234,567.89", std::format("{:pen_US}", 1'234'567.89_money));
+  CHECK_EQ("-1,234,567.89", std::format("{:#pen_US}", -1'234'567.89_money));
+  CHECK_EQ("1234567.89", std::format("{:pplain}", 1'234'567.89_money));
+
+  CHECK_EQ("$1,234.56", std::format("{:#pen_US:USD}", 1'234.56_money));
+  CHECK_EQ("-$1,234.56", std::format("{:#pen_US:USD}", -1'234.56_money));
+  CHECK_EQ("1,234.56", std::format("{:pen_US:USD}", 1'234.56_money));
+  CHECK_EQ("$0.05", std::format("{:#pen_US:USD}", 5_money));
+  CHECK_EQ("$123.00", std::format("{:#pen_US:USD}", 123.00_money));
+  CHECK_EQ("($1,234.56)", std::format("{:#paccounting:USD}", -1'234.56_money));
+  CHECK_EQ("-USD 1,234.56", std::format("{:#piso:USD}", -1'234.56_money));
+  CHECK_EQ("-" + rupee + "12,34,567.89", std::format("{:#pen_IN:INR}", -12'34'567.89_money));
+  CHECK_EQ("1" + narrow_nbsp + "234,56" + nbsp + euro, std::format("{:#pfr_FR:EUR}", 1'234.56_money));
+  CHECK_EQ("-1.234,56" + nbsp + euro, std::format("{:#pde_DE:EUR}", -1'234.56_money));
+  CHECK_EQ(euro + nbsp + "-1.234,56", std::format("{:#pnl_NL:EUR}", -1'234.56_money));
+  CHECK_EQ("CHF" + nbsp + "-1" + apostrophe + "234.56", std::format("{:#pde_CH:CHF}", -1'234.56_money));
+  CHECK_EQ("-1.234,56", std::format("{:pnl_NL:EUR}", -1'234.56_money));
+
+  // minor units of the currency
+  CHECK_EQ("123,456", std::format("{:pen_US:JPY}", 123'456_money));
+  CHECK_EQ("123.456", std::format("{:pen_US:KWD}", 123'456_money));
+
+  // extremes
+  auto const lowest = io1::money{std::numeric_limits<std::int64_t>::lowest()};
+  CHECK_EQ("-92,233,720,368,547,758.08", std::format("{:pen_US}", lowest));
+  CHECK_EQ("-9,223,372,036,854,775,808", std::format("{:pen_US:JPY}", lowest));
+
+  // fill, align and width, including a 'p' fill
+  CHECK_EQ("   $12.35", std::format("{:>9#pen_US:USD}", 12.35_money));
+  CHECK_EQ("ppp12.35", std::format("{:p>8pen_US}", 12.35_money));
+  CHECK_EQ("12.35***", std::format("{:*<8pen_US}", 12.35_money));
+
+  // the usual specifications are unchanged
+  CHECK_EQ("1235", std::format("{}", 12.35_money));
+  CHECK_EQ("  1235", std::format("{:6}", 12.35_money));
+}
+
+TEST_CASE("Format profiles of tagged amounts")
+{
+  using usd = io1::tagged_money<io1::currency<"USD">>;
+  using jpy = io1::tagged_money<io1::currency<"JPY">>;
+
+  CHECK_EQ("-$1,234.56", std::format("{:#pen_US}", usd{-123'456}));
+  CHECK_EQ("1,234.56", std::format("{:pen_US}", usd{123'456}));
+  CHECK_EQ("JPY 123,456", std::format("{:#piso}", jpy{123'456}));
+  CHECK_EQ("12.30 USD", std::format("{:#}", usd{1'230}));
+}
+
+TEST_CASE("Allocation free profile formatting")
+{
+  auto const & profile = *io1::find_profile("en_US");
+  auto const & currency = *io1::find_currency("USD");
+
+  char buffer[16];
+  auto const [ptr, ec] =
+      io1::to_chars(std::begin(buffer), std::end(buffer), -1'234.56_money, profile, currency, true);
+  CHECK(std::errc{} == ec);
+  CHECK_EQ("-$1,234.56", std::string_view(std::begin(buffer), ptr));
+
+  auto const small = io1::to_chars(std::begin(buffer), std::begin(buffer) + 4, -1'234.56_money, profile, currency);
+  CHECK(std::errc::value_too_large == small.ec);
+
+  using chf = io1::tagged_money<io1::currency<"CHF">>;
+  auto const tagged = io1::to_chars(std::begin(buffer), std::end(buffer), chf{123'456}, *io1::find_profile("de_CH"));
+  CHECK_EQ("1" + apostrophe + "234.56", std::string_view(std::begin(buffer), tagged.ptr));
+
+  constexpr auto constant = []
+  {
+    char out[32]{};
+    auto const size = io1::detail::format_with_profile(out, -123'456'789, 2, *io1::find_profile("en_IN"), "Rs");
+    return std::string_view("-Rs12,34,567.89").size() == size && '-' == out[0] && '9' == out[size - 1];
+  }();
+  static_assert(constant);
+}
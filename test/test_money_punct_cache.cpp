@@ -0,0 +1,221 @@
+#include "io1/money.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <ios>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  struct facet_settings
+  {
+    char decimal_point{'.'};
+    char thousands_sep{','};
+    std::string grouping;
+    std::string curr_symbol;
+    std::string positive_sign;
+    std::string negative_sign{"-"};
+    int frac_digits{2};
+    std::money_base::pattern pos_format{};
+    std::money_base::pattern neg_format{};
+  };
+
+  template <bool Intl>
+  class settings_moneypunct : public std::moneypunct<char, Intl>
+  {
+  public:
+    using pattern = std::money_base::pattern;
+
+    explicit settings_moneypunct(facet_settings settings) : settings_(std::move(settings)) {}
+
+  private:
+    char do_decimal_point() const override { return settings_.decimal_point; }
+    char do_thousands_sep() const override { return settings_.thousands_sep; }
+    std::string do_grouping() const override { return settings_.grouping; }
+    std::string do_curr_symbol() const override { return settings_.curr_symbol; }
+    std::string do_positive_sign() const override { return settings_.positive_sign; }
+    std::string do_negative_sign() const override { return settings_.negative_sign; }
+    int do_frac_digits() const override { return settings_.frac_digits; }
+    pattern do_pos_format() const override { return settings_.pos_format; }
+    pattern do_neg_format() const override { return settings_.neg_format; }
+
+    facet_settings settings_;
+  };
+
+  // a money_put that is not the standard one
+  class bracket_money_put : public std::money_put<char>
+  {
+  private:
+    iter_type do_put(iter_type out, bool, std::ios_base &, char, long double units) const override
+    {
+      return std::ranges::copy("[" + std::to_string(static_cast<long long>(units)) + "]", out).out;
+    }
+    iter_type do_put(iter_type out, bool, std::ios_base &, char, string_type const & digits) const override
+    {
+      return std::ranges::copy("[" + digits + "]", out).out;
+    }
+  };
+
+  std::money_base::pattern random_pattern(std::mt19937 & gen)
+  {
+    std::money_base::pattern result{};
+    char fields[4] = {std::money_base::symbol, std::money_base::sign, std::money_base::value,
+                      std::bernoulli_distribution(0.5)(gen) ? std::money_base::space : std::money_base::none};
+    std::shuffle(std::begin(fields), std::end(fields), gen);
+    std::ranges::copy(fields, result.field);
+    return result;
+  }
+
+  std::string random_string(std::mt19937 & gen, std::string_view alphabet, int max_size)
+  {
+    std::string result(static_cast<std::size_t>(std::uniform_int_distribution(0, max_size)(gen)), ' ');
+    for (auto & c : result)
+    {
+      c = alphabet[std::uniform_int_distribution<std::size_t>(0, alphabet.size() - 1)(gen)];
+    }
+    return result;
+  }
+
+  facet_settings random_settings(std::mt19937 & gen)
+  {
+    facet_settings settings;
+    settings.decimal_point = ",._"[std::uniform_int_distribution(0, 2)(gen)];
+    settings.thousands_sep = "', "[std::uniform_int_distribution(0, 2)(gen)];
+    settings.grouping = random_string(gen, std::string_view("\001\002\003\004\000\177", 6), 3);
+    settings.curr_symbol = random_string(gen, "$EURCH ", 4);
+    settings.positive_sign = random_string(gen, "+ ", 2);
+    settings.negative_sign = random_string(gen, "-()", 2);
+    settings.frac_digits = std::uniform_int_distribution(-1, 7)(gen);
+    settings.pos_format = random_pattern(gen);
+    settings.neg_format = random_pattern(gen);
+    return settings;
+  }
+
+  std::string standard_put(std::locale const & loc, std::int64_t amount, bool intl, std::ios_base::fmtflags flags,
+                           std::streamsize width, char fill)
+  {
+    std::ostringstream stream;
+    stream.imbue(loc);
+    stream.flags(flags);
+    stream.fill(fill);
+    stream << std::setw(static_cast<int>(width)) << std::put_money(std::to_string(amount), intl);
+    return stream.str();
+  }
+
+  std::string cached_put(std::locale const & loc, std::int64_t amount, bool intl, std::ios_base::fmtflags flags,
+                         std::streamsize width, char fill)
+  {
+    std::ostringstream stream;
+    stream.imbue(loc);
+    stream.flags(flags);
+    stream.fill(fill);
+    stream << std::setw(static_cast<int>(width)) << io1::put_money(io1::money{amount}, intl);
+    return stream.str();
+  }
+} // namespace
+
+TEST_CASE("Cached moneypunct plans match money_put")
+{
+  std::mt19937 gen(35);
+  std::uniform_int_distribution<std::int64_t> amounts(std::numeric_limits<std::int64_t>::lowest(),
+                                                       std::numeric_limits<std::int64_t>::max());
+  std::uniform_int_distribution<std::int64_t> small_amounts(-100'000, 100'000);
+  std::ios_base::fmtflags const adjustments[] = {{}, std::ios_base::left, std::ios_base::right,
+                                                 std::ios_base::internal};
+
+  std::size_t mismatches = 0;
+  for (int facet = 0; facet < 200; ++facet)
+  {
+    auto const settings = random_settings(gen);
+    auto const intl = 0 == facet % 2;
+    auto const loc = intl ? std::locale(std::locale::classic(), new settings_moneypunct<true>(settings))
+                          : std::locale(std::locale::classic(), new settings_moneypunct<false>(settings));
+
+    for (int i = 0; i < 100; ++i)
+    {
+      auto const amount = 0 == i ? std::numeric_limits<std::int64_t>::lowest() : (i % 2 ? amounts : small_amounts)(gen);
+      auto flags = adjustments[std::uniform_int_distribution(0, 3)(gen)];
+      if (std::bernoulli_distribution(0.5)(gen)) { flags |= std::ios_base::showbase; }
+      auto const width = std::uniform_int_distribution<std::streamsize>(0, 40)(gen);
+      auto const fill = "*. "[std::uniform_int_distribution(0, 2)(gen)];
+
+      if (standard_put(loc, amount, intl, flags, width, fill) != cached_put(loc, amount, intl, flags, width, fill))
+      {
+        ++mismatches;
+      }
+    }
+  }
+  CHECK_EQ(0, mismatches);
+}
+
+TEST_CASE("Cached moneypunct plans in the m format")
+{
+  facet_settings settings;
+  settings.grouping = "\003";
+  settings.curr_symbol = "$";
+  settings.pos_format = {std::money_base::symbol, std::money_base::sign, std::money_base::value, std::money_base::none};
+  settings.neg_format = settings.pos_format;
+  std::locale const loc(std::locale::classic(), new settings_moneypunct<false>(settings));
+
+  CHECK_EQ("1,234,567.89", std::format(loc, "{:m}", 1'234'567.89_money));
+  CHECK_EQ("$-1,234,567.89", std::format(loc, "{:#m}", -1'234'567.89_money));
+  CHECK_EQ("  $.05", std::format(loc, "{:>6#m}", 0.05_money));
+
+  std::ostringstream stream;
+  stream.imbue(loc);
+  stream << std::showbase << io1::put_money(-5_money);
+  CHECK_EQ("$-.05", stream.str());
+}
+
+TEST_CASE("Custom money_put facets are used")
+{
+  std::locale const loc(std::locale::classic(), new bracket_money_put);
+
+  std::ostringstream stream;
+  stream.imbue(loc);
+  stream << io1::put_money(-1234_money);
+  CHECK_EQ("[-1234]", stream.str());
+  CHECK_EQ("[1234]", std::format(loc, "{:m}", 1234_money));
+}
+
+TEST_CASE("Moneypunct cache statistics")
+{
+  io1::clear_moneypunct_cache();
+  CHECK_EQ(0, io1::moneypunct_cache_stats().entries);
+
+  std::locale const first(std::locale::classic(), new settings_moneypunct<false>(facet_settings{}));
+  std::locale const second(std::locale::classic(), new settings_moneypunct<false>(facet_settings{}));
+  for (int i = 0; i < 10; ++i)
+  {
+    (void)std::format(first, "{:m}", 1_money);
+    (void)std::format(second, "{:m}", 1_money);
+    (void)std::format(second, "{:M}", 1_money);
+  }
+
+  auto const stats = io1::moneypunct_cache_stats();
+  CHECK_EQ(3, stats.misses);
+  CHECK_EQ(27, stats.hits);
+  CHECK_EQ(3, stats.entries);
+
+  // a new locale per call is bounded by the capacity of the cache
+  for (int i = 0; i < 100; ++i)
+  {
+    (void)std::format(std::locale(std::locale::classic(), new settings_moneypunct<true>(facet_settings{})), "{:M}",
+                      1_money);
+  }
+  CHECK_LE(io1::moneypunct_cache_stats().entries, 2 * io1::detail::moneypunct_cache<true>::capacity);
+
+  io1::clear_moneypunct_cache();
+  CHECK_EQ(0, io1::moneypunct_cache_stats().misses);
+  CHECK_EQ(0, io1::moneypunct_cache_stats().entries);
+}
@@ -0,0 +1,231 @@
+#include "io1/money_reconcile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  constexpr std::chrono::sys_days day(int d) noexcept
+  {
+    return std::chrono::sys_days{std::chrono::year{2024} / 1 / 1} + std::chrono::days{d};
+  }
+
+  // A statement and the matching ledger: copies a few days late, amounts off by a few cents, split payments and
+  // entries without counterpart.
+  struct synthetic_ledgers
+  {
+    std::vector<io1::ledger_entry> bank;
+    std::vector<io1::ledger_entry> books;
+    std::size_t exact{0};
+    std::size_t approximate{0};
+    std::size_t groups{0};
+  };
+
+  synthetic_ledgers generate_ledgers(std::size_t size)
+  {
+    std::mt19937_64 gen(7);
+    std::uniform_int_distribution<std::int64_t> amounts(1, 5'000'000);
+    std::uniform_int_distribution<int> dates(0, 365);
+    std::uniform_int_distribution<int> delay(0, 2);
+    std::uniform_int_distribution<int> kind(0, 99);
+
+    synthetic_ledgers result;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      auto const amount = io1::money{amounts(gen)};
+      auto const date = day(dates(gen));
+      auto const reference = static_cast<std::uint64_t>(i);
+      result.bank.push_back({amount, date, reference});
+
+      auto const k = kind(gen);
+      auto const booked = date + std::chrono::days{delay(gen)};
+      if (k < 80)
+      {
+        result.books.push_back({amount, booked, reference});
+        ++result.exact;
+      }
+      else if (k < 88)
+      {
+        // amounts of the tolerance pass are odd multiples of 1000, too sparse for the exact pass to find another one
+        result.bank.back().amount = io1::money{amount.data() * 2000 + 1000};
+        result.books.push_back({io1::money{amount.data() * 2000 + 1003}, booked, reference});
+        ++result.approximate;
+      }
+      else if (k < 96)
+      {
+        auto const first = io1::money{amount.data() / 3};
+        result.books.push_back({first, booked, reference});
+        result.books.push_back({amount - first, booked, reference});
+        ++result.groups;
+      }
+      // else: no counterpart
+    }
+    return result;
+  }
+
+  void check_consistency(std::vector<io1::ledger_entry> const & left, std::vector<io1::ledger_entry> const & right,
+                         io1::reconciliation_result const & result, io1::reconciliation_options const & options)
+  {
+    std::vector<int> left_uses(left.size(), 0);
+    std::vector<int> right_uses(right.size(), 0);
+    auto const within = [&](io1::ledger_entry const & l, io1::ledger_entry const & r)
+    { return (l.date < r.date ? r.date - l.date : l.date - r.date) <= options.date_tolerance; };
+
+    for (auto const & [l, r] : result.exact)
+    {
+      ++left_uses[l];
+      ++right_uses[r];
+      CHECK_EQ(left[l].amount, right[r].amount);
+      CHECK(within(left[l], right[r]));
+    }
+    for (auto const & [l, r] : result.approximate)
+    {
+      ++left_uses[l];
+      ++right_uses[r];
+      CHECK_LE(left[l].amount - right[r].amount, options.amount_tolerance);
+      CHECK_LE(right[r].amount - left[l].amount, options.amount_tolerance);
+      CHECK(within(left[l], right[r]));
+    }
+    for (auto const & group : result.groups)
+    {
+      CHECK((1 == group.left.size() || 1 == group.right.size()));
+      CHECK(2 <= group.left.size() + group.right.size() - 1);
+      auto left_sum = 0_money;
+      auto right_sum = 0_money;
+      for (auto const l : group.left)
+      {
+        ++left_uses[l];
+        left_sum += left[l].amount;
+      }
+      for (auto const r : group.right)
+      {
+        ++right_uses[r];
+        right_sum += right[r].amount;
+      }
+      CHECK_EQ(left_sum, right_sum);
+    }
+    for (auto const l : result.unmatched_left) ++left_uses[l];
+    for (auto const r : result.unmatched_right) ++right_uses[r];
+
+    CHECK(std::ranges::all_of(left_uses, [](int uses) { return 1 == uses; }));
+    CHECK(std::ranges::all_of(right_uses, [](int uses) { return 1 == uses; }));
+  }
+} // namespace
+
+TEST_CASE("Exact reconciliation")
+{
+  std::vector<io1::ledger_entry> const bank{
+      {10_money, day(0), 1}, {10_money, day(5), 2}, {25_money, day(1), 3}, {7_money, day(3), 4}};
+  std::vector<io1::ledger_entry> const books{
+      {10_money, day(5), 2}, {10_money, day(1), 1}, {25_money, day(9), 3}, {8_money, day(3), 4}};
+
+  io1::reconciliation_options options;
+  options.date_tolerance = std::chrono::days{1};
+  auto const result = io1::reconcile(bank, books, options);
+
+  CHECK(result.exact == std::vector<io1::reconciliation_pair>{{1, 0}, {0, 1}});
+  CHECK(result.approximate.empty());
+  CHECK(result.groups.empty());
+  CHECK(result.unmatched_left == std::vector<std::size_t>{2, 3});
+  CHECK(result.unmatched_right == std::vector<std::size_t>{2, 3});
+  check_consistency(bank, books, result, options);
+}
+
+TEST_CASE("Same amounts prefer the same reference")
+{
+  std::vector<io1::ledger_entry> const bank{{10_money, day(0), 1}, {10_money, day(0), 2}};
+  std::vector<io1::ledger_entry> const books{{10_money, day(0), 2}, {10_money, day(0), 1}};
+
+  auto const result = io1::reconcile(bank, books);
+  CHECK(result.exact == std::vector<io1::reconciliation_pair>{{1, 0}, {0, 1}});
+
+  std::vector<io1::ledger_entry> const other{{10_money, day(0), 3}};
+  auto const fallback = io1::reconcile(bank, other);
+  CHECK_EQ(1, fallback.exact.size());
+  CHECK_EQ(1, fallback.unmatched_left.size());
+}
+
+TEST_CASE("Tolerance window reconciliation")
+{
+  std::vector<io1::ledger_entry> const bank{
+      {100.00_money, day(0), 1}, {200.00_money, day(0), 2}, {300.00_money, day(0), 3}};
+  std::vector<io1::ledger_entry> const books{
+      {io1::money{30'002}, day(0), 3}, {io1::money{10'005}, day(0), 1}, {io1::money{20'010}, day(0), 2}};
+
+  io1::reconciliation_options options;
+  options.amount_tolerance = io1::money{5};
+  auto const result = io1::reconcile(bank, books, options);
+
+  CHECK(result.exact.empty());
+  CHECK(result.approximate == std::vector<io1::reconciliation_pair>{{2, 0}, {0, 1}});
+  CHECK(result.unmatched_left == std::vector<std::size_t>{1});
+  CHECK(result.unmatched_right == std::vector<std::size_t>{2});
+
+  // the closest amount wins
+  std::vector<io1::ledger_entry> const close{{io1::money{10'004}, day(0), 9}, {io1::money{10'001}, day(0), 9}};
+  auto const closest = io1::reconcile(std::span(bank).first(1), close, options);
+  CHECK(closest.approximate == std::vector<io1::reconciliation_pair>{{0, 1}});
+}
+
+TEST_CASE("One to many reconciliation")
+{
+  std::vector<io1::ledger_entry> const bank{{100_money, day(0), 1}, {50_money, day(0), 2}, {20_money, day(0), 3}};
+  std::vector<io1::ledger_entry> const books{{30_money, day(0), 1}, {45_money, day(0), 1}, {25_money, day(0), 1},
+                                             {5_money, day(0), 1},  {30_money, day(0), 2}, {21_money, day(0), 4},
+                                             {12_money, day(0), 3}, {8_money, day(0), 3}};
+
+  auto const result = io1::reconcile(bank, books);
+  REQUIRE_EQ(2, result.groups.size());
+  CHECK(result.groups[0].left == std::vector<std::size_t>{0});
+  CHECK(result.groups[0].right == std::vector<std::size_t>{0, 1, 2});
+  CHECK(result.groups[1].left == std::vector<std::size_t>{2});
+  CHECK(result.groups[1].right == std::vector<std::size_t>{6, 7});
+  CHECK(result.unmatched_left == std::vector<std::size_t>{1});
+  CHECK(result.unmatched_right == std::vector<std::size_t>{3, 4, 5});
+
+  // several bank entries paying a single invoice
+  auto const reversed = io1::reconcile(books, bank);
+  REQUIRE_EQ(2, reversed.groups.size());
+  CHECK(reversed.groups[0].left == std::vector<std::size_t>{0, 1, 2});
+  CHECK(reversed.groups[0].right == std::vector<std::size_t>{0});
+
+  io1::reconciliation_options options;
+  options.max_group_size = 2;
+  CHECK_EQ(1, io1::reconcile(bank, books, options).groups.size());
+  options.max_group_size = 1;
+  CHECK(io1::reconcile(bank, books, options).groups.empty());
+}
+
+TEST_CASE("Synthetic ledgers reconciliation")
+{
+  auto const ledgers = generate_ledgers(100'000);
+
+  io1::reconciliation_options options;
+  options.date_tolerance = std::chrono::days{2};
+  options.amount_tolerance = io1::money{3};
+
+  auto const parallel = io1::reconcile(ledgers.bank, ledgers.books, options);
+  check_consistency(ledgers.bank, ledgers.books, parallel, options);
+
+  // random amounts may collide: allow a handful of entries to be paired with an unexpected counterpart
+  CHECK_LE(ledgers.exact, parallel.exact.size());
+  CHECK_LE(parallel.exact.size(), ledgers.exact + 50);
+  CHECK_LE(ledgers.approximate, parallel.approximate.size() + 50);
+  CHECK_LE(ledgers.groups, parallel.groups.size() + 50);
+
+  options.threads = 1;
+  auto const sequential = io1::reconcile(ledgers.bank, ledgers.books, options);
+  CHECK_EQ(parallel.exact.size(), sequential.exact.size());
+  CHECK_EQ(parallel.approximate.size(), sequential.approximate.size());
+  CHECK_EQ(parallel.groups.size(), sequential.groups.size());
+  CHECK(parallel.unmatched_left == sequential.unmatched_left);
+  CHECK(parallel.unmatched_right == sequential.unmatched_right);
+}
@@ -0,0 +1,95 @@
+#include "io1/money_rescale.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  constexpr io1::rounding all_modes[] = {io1::rounding::toward_zero, io1::rounding::away_from_zero,
+                                         io1::rounding::floor,       io1::rounding::ceiling,
+                                         io1::rounding::half_down,   io1::rounding::half_up,
+                                         io1::rounding::half_even};
+} // namespace
+
+TEST_CASE("Rescale single amounts")
+{
+  // cents to mills and back
+  static_assert(12'340_money == io1::rescale<2, 3>(1'234_money));
+  static_assert(-12'340_money == io1::rescale<2, 3>(-1'234_money));
+  static_assert(1'234_money == io1::rescale<2, 2>(1'234_money));
+  static_assert(1'234_money == io1::rescale<3, 2>(12'345_money));
+  static_assert(1'236_money == io1::rescale<3, 2>(12'355_money));
+  static_assert(1'235_money == io1::rescale<3, 2>(12'345_money, io1::rounding::half_up));
+  static_assert(-1'235_money == io1::rescale<3, 2>(-12'341_money, io1::rounding::floor));
+  static_assert(-1'234_money == io1::rescale<3, 2>(-12'349_money, io1::rounding::toward_zero));
+
+  // micro-units of a crypto feed to cents
+  static_assert(123_money == io1::rescale<6, 2>(1'234'567_money));
+  static_assert(1_money32 == io1::rescale<8, 0>(io1::money32{99'999'999}));
+  static_assert(io1::money128{std::numeric_limits<std::int64_t>::max()} * 1'000 ==
+                io1::rescale<0, 3>(io1::money128{std::numeric_limits<std::int64_t>::max()}));
+
+  // the power of ten between the scales must fit in the amount
+  constexpr auto rescalable = []<unsigned From, unsigned To>(auto amount)
+  { return requires { io1::rescale<From, To>(amount); }; };
+  static_assert(rescalable.operator()<0, 9>(io1::money32{1}));
+  static_assert(!rescalable.operator()<0, 10>(io1::money32{1}));
+  static_assert(!rescalable.operator()<12, 0>(io1::money32{1}));
+  static_assert(rescalable.operator()<12, 0>(io1::money{1}));
+  CHECK_THROWS_AS((void)(io1::rescale<0, 9>(io1::money32{3})), std::overflow_error);
+
+  constexpr auto max = std::numeric_limits<io1::money::value_type>::max();
+  CHECK_EQ(io1::money{max / 100 * 100}, io1::rescale<0, 2>(io1::money{max / 100}));
+  CHECK_THROWS_AS((void)(io1::rescale<0, 2>(io1::money{max / 100 + 1})), std::overflow_error);
+  CHECK_THROWS_AS((void)(io1::rescale<0, 18>(-100_money)), std::overflow_error);
+}
+
+TEST_CASE("Rescale columns")
+{
+  std::mt19937_64 gen(37);
+  std::uniform_int_distribution<std::int64_t> amounts(-1'000'000'000'000, 1'000'000'000'000);
+  std::vector<io1::money> feed(10'000);
+  for (auto & amount : feed) { amount = io1::money{amounts(gen)}; }
+  feed[0] = io1::money{std::numeric_limits<std::int64_t>::lowest()};
+  feed[1] = io1::money{std::numeric_limits<std::int64_t>::max()};
+  feed[2] = io1::money{-5'000};
+  feed[3] = io1::money{15'000};
+
+  std::vector<io1::money> out(feed.size());
+  for (auto const mode : all_modes)
+  {
+    io1::rescale<6, 2>(feed, out, mode);
+    CHECK(std::ranges::equal(out, feed, {}, {}, [mode](io1::money m) { return io1::rescale<6, 2>(m, mode); }));
+  }
+
+  // in place
+  auto copy = feed;
+  io1::rescale<4, 0>(copy);
+  CHECK(std::ranges::equal(copy, feed, {}, {}, [](io1::money m) { return io1::rescale<4, 0>(m); }));
+
+  io1::rescale<0, 3>(copy);
+  CHECK(std::ranges::equal(copy, feed, {}, {}, [](io1::money m) { return io1::rescale<0, 3>(io1::rescale<4, 0>(m)); }));
+}
+
+TEST_CASE("Rescale overflow leaves the column untouched")
+{
+  std::vector<io1::money> feed(1'000, 1_money);
+  feed[600] = io1::money{std::numeric_limits<std::int64_t>::max() / 10};
+  feed[900] = io1::money{std::numeric_limits<std::int64_t>::lowest() / 10};
+
+  std::vector<io1::money> out(feed.size(), 7_money);
+  CHECK_THROWS_WITH_AS((io1::rescale<2, 4>(feed, out)), "io1::rescale: amount at index 600 out of range.",
+                       std::overflow_error);
+  CHECK(std::ranges::all_of(out, [](io1::money m) { return 7_money == m; }));
+
+  io1::rescale<2, 3>(feed, out);
+  CHECK_EQ(10_money, out[0]);
+}
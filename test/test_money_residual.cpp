@@ -0,0 +1,205 @@
+#include "io1/money_residual.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  constexpr io1::rounding all_modes[] = {io1::rounding::toward_zero, io1::rounding::away_from_zero,
+                                         io1::rounding::floor,       io1::rounding::ceiling,
+                                         io1::rounding::half_down,   io1::rounding::half_up,
+                                         io1::rounding::half_even};
+
+  constexpr auto half_unit = io1::residual_unit / 2;
+
+  // amount * factor * residual_unit, exact for factors that are multiples of 2^-64 and small enough products
+  io1::money128::value_type exact_product(io1::money amount, double factor)
+  {
+    auto const f = io1::detail::decompose(factor);
+    auto const product =
+        static_cast<io1::money128::value_type>(amount.data()) * static_cast<io1::money128::value_type>(f.mantissa);
+    auto const shifted = 64 + f.exponent < 0 ? product >> -(64 + f.exponent) : product << (64 + f.exponent);
+    return f.negative ? -shifted : shifted;
+  }
+} // namespace
+
+TEST_CASE("Residual of a single scaling")
+{
+  CHECK(io1::scaled_money{.amount = io1::money{2}, .residual = -half_unit} == io1::scale(io1::money{3}, 0.5));
+  CHECK(io1::scaled_money{.amount = io1::money{2}, .residual = -half_unit} ==
+        io1::scale(io1::money{3}, 0.5f, io1::rounding::half_up));
+  CHECK(io1::scaled_money{.amount = io1::money{1}, .residual = half_unit} ==
+        io1::scale(io1::money{3}, 0.5L, io1::rounding::floor));
+  CHECK(io1::scaled_money{.amount = io1::money{-2}, .residual = half_unit} == io1::scale(io1::money{-3}, 0.5));
+  CHECK(io1::scaled_money{.amount = io1::money{-8}, .residual = half_unit} == io1::scale(io1::money{3}, -2.5));
+  CHECK(io1::scaled_money{.amount = io1::money{30}, .residual = 0} == io1::scale(io1::money{10}, 3.));
+  CHECK(io1::scaled_money{.amount = 0_money, .residual = 0} == io1::scale(0_money, 1e300));
+
+  // the double closest to 0.1 is 3602879701896397 * 2^-55: ten times it is 1 + 2^-54
+  CHECK(io1::scaled_money{.amount = io1::money{1}, .residual = 1'024} == io1::scale(io1::money{10}, 0.1));
+
+  // the bits below 2^-64 are rounded
+  CHECK(io1::scaled_money{.amount = 0_money, .residual = 15'625'000'000} ==
+        io1::scale(io1::money{1'000'000'000'000}, std::ldexp(1., -70)));
+  CHECK(io1::scaled_money{.amount = 0_money, .residual = 0} == io1::scale(io1::money{1}, 1e-30));
+
+  // the extremes of the range
+  constexpr auto max = std::numeric_limits<io1::money::value_type>::max();
+  constexpr auto lowest = std::numeric_limits<io1::money::value_type>::lowest();
+  CHECK_EQ(io1::money{lowest}, io1::scale(io1::money{lowest / 2}, 2.).amount);
+  CHECK_EQ(io1::money{lowest}, io1::scale(io1::money{max}, -1., io1::rounding::floor).amount - io1::money{1});
+  CHECK_THROWS_AS((void)io1::scale(io1::money{max}, 2.), std::overflow_error);
+  CHECK_THROWS_AS((void)io1::scale(io1::money{max}, 1.5), std::overflow_error);
+  CHECK_THROWS_AS((void)io1::scale(io1::money{1}, 1e300), std::overflow_error);
+  CHECK_THROWS_WITH_AS((void)io1::scale(1_money, std::numeric_limits<double>::quiet_NaN()),
+                       "io1::scale: factor is not finite.", std::invalid_argument);
+}
+
+TEST_CASE("Rounded amounts and residuals add up to the exact products")
+{
+  std::mt19937_64 gen(44);
+  std::uniform_int_distribution<std::int64_t> amounts(-(std::int64_t{1} << 40U), std::int64_t{1} << 40U);
+  std::uniform_real_distribution<double> factors(-4., 4.);
+
+  for (int i = 0; i < 10'000; ++i)
+  {
+    auto const amount = io1::money{amounts(gen)};
+    auto factor = factors(gen);
+    if (std::fabs(factor) < 1e-3) { factor = 1e-3; }
+    auto const exact = exact_product(amount, factor);
+
+    for (auto const mode : all_modes)
+    {
+      auto const [rounded, residual] = io1::scale(amount, factor, mode);
+      REQUIRE_EQ(exact, static_cast<io1::money128::value_type>(rounded.data()) * io1::residual_unit + residual);
+      REQUIRE(-io1::residual_unit < residual);
+      REQUIRE(residual < io1::residual_unit);
+      switch (mode)
+      {
+      case io1::rounding::toward_zero: REQUIRE((exact < 0 ? residual <= 0 : residual >= 0)); break;
+      case io1::rounding::away_from_zero: REQUIRE((exact < 0 ? residual >= 0 : residual <= 0)); break;
+      case io1::rounding::floor: REQUIRE(residual >= 0); break;
+      case io1::rounding::ceiling: REQUIRE(residual <= 0); break;
+      default: REQUIRE((-half_unit <= residual && residual <= half_unit)); break;
+      }
+    }
+  }
+}
+
+TEST_CASE("Same rounding as the multiplication operator")
+{
+  std::mt19937_64 gen(45);
+  // the long double product of operator* is exact for these amounts
+  std::uniform_int_distribution<std::int64_t> amounts(-2'047, 2'047);
+  std::uniform_real_distribution<double> factors(-100., 100.);
+
+  for (int i = 0; i < 10'000; ++i)
+  {
+    auto const amount = io1::money{amounts(gen)};
+    auto const factor = factors(gen);
+    auto const [rounded, residual] = io1::scale(amount, factor);
+    REQUIRE_EQ(factor * amount, rounded);
+    auto const exact = static_cast<long double>(amount.data()) * static_cast<long double>(factor);
+    REQUIRE_EQ(exact - static_cast<long double>(rounded.data()),
+               std::ldexp(static_cast<long double>(residual), -64));
+  }
+}
+
+TEST_CASE("Total residual of a column")
+{
+  std::mt19937_64 gen(46);
+  std::uniform_int_distribution<std::int64_t> dist(-1'000'000'000, 1'000'000'000);
+  std::vector<io1::money> amounts(100'000);
+  for (auto & amount : amounts) { amount = io1::money{dist(gen)}; }
+
+  constexpr auto factor = 1.0725;
+  io1::money128::value_type expected = 0;
+  std::vector<io1::money> rounded;
+  for (auto const amount : amounts)
+  {
+    auto const [a, r] = io1::scale(amount, factor, io1::rounding::half_up);
+    rounded.push_back(a);
+    expected += r;
+  }
+
+  std::vector<io1::money> serial(amounts.size());
+  std::vector<io1::money> parallel(amounts.size());
+  CHECK((expected == io1::scale<double>(amounts, factor, serial, io1::rounding::half_up, 1)));
+  CHECK((expected == io1::scale<double>(amounts, factor, parallel, io1::rounding::half_up, 4)));
+  CHECK(rounded == serial);
+  CHECK(rounded == parallel);
+
+  // nothing is written on overflow
+  amounts[77'777] = io1::money{std::numeric_limits<io1::money::value_type>::max()};
+  std::vector<io1::money> out(amounts.size());
+  CHECK_THROWS_WITH_AS((void)io1::scale<double>(amounts, factor, out),
+                       "io1::scale: amount at index 77777 out of range.", std::overflow_error);
+  CHECK(std::vector<io1::money>(amounts.size()) == out);
+}
+
+TEST_CASE("Residuals per group")
+{
+  std::mt19937_64 gen(47);
+  std::uniform_int_distribution<std::int64_t> amount_dist(-1'000'000, 1'000'000);
+  std::uniform_real_distribution<double> factor_dist(0., 2.);
+  std::uniform_int_distribution<std::uint32_t> group_dist(0, 7);
+
+  constexpr std::size_t size = 100'000;
+  std::vector<io1::money> amounts(size);
+  std::vector<double> factors(size);
+  std::vector<std::uint32_t> groups(size);
+  std::vector<io1::money128::value_type> expected(8, 0);
+  std::vector<io1::money> rounded(size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    amounts[i] = io1::money{amount_dist(gen)};
+    factors[i] = factor_dist(gen);
+    groups[i] = group_dist(gen);
+    auto const [a, r] = io1::scale(amounts[i], factors[i]);
+    rounded[i] = a;
+    expected[groups[i]] += r;
+  }
+
+  for (std::size_t threads : {1, 4})
+  {
+    std::vector<io1::money> out(size);
+    std::vector<io1::money128::value_type> residuals(8, 0);
+    io1::scale<double>(amounts, factors, groups, out, residuals, io1::rounding::half_even, threads);
+    CHECK(rounded == out);
+    CHECK(expected == residuals);
+  }
+
+  std::vector<io1::money> out(size);
+  std::vector<io1::money128::value_type> residuals(8, 0);
+  groups[5] = 8;
+  CHECK_THROWS_WITH_AS(io1::scale<double>(amounts, factors, groups, out, residuals),
+                       "io1::scale: unknown group 8 at index 5.", std::invalid_argument);
+  groups[5] = 0;
+  factors[9] = std::numeric_limits<double>::infinity();
+  CHECK_THROWS_WITH_AS(io1::scale<double>(amounts, factors, groups, out, residuals),
+                       "io1::scale: factor at index 9 is not finite.", std::invalid_argument);
+  factors[9] = 1e300;
+  amounts[9] = 1_money;
+  CHECK_THROWS_WITH_AS(io1::scale<double>(amounts, factors, groups, out, residuals),
+                       "io1::scale: amount at index 9 out of range.", std::overflow_error);
+  CHECK(std::vector<io1::money128::value_type>(8, 0) == residuals);
+
+  // in place: the results written before the overflow is reported are not read again
+  for (std::size_t threads : {1, 4})
+  {
+    auto in_place = amounts;
+    CHECK_THROWS_WITH_AS(io1::scale<double>(in_place, factors, groups, in_place, residuals,
+                                            io1::rounding::half_even, threads),
+                         "io1::scale: amount at index 9 out of range.", std::overflow_error);
+    CHECK_EQ(0_money, in_place[9]);
+    CHECK_EQ(rounded[10], in_place[10]);
+  }
+}
@@ -0,0 +1,68 @@
+#include "io1/money_rounding.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+TEST_CASE("Rounding modes")
+{
+  using io1::rounding;
+  using io1::detail::divide_rounded;
+
+  // 2.5, 3.5, 2.4, 2.6 and their opposites
+  constexpr std::int64_t numerators[] = {25, 35, 24, 26, -25, -35, -24, -26};
+  constexpr struct
+  {
+    rounding mode;
+    std::int64_t expected[8];
+  } cases[] = {
+      {rounding::toward_zero, {2, 3, 2, 2, -2, -3, -2, -2}},
+      {rounding::away_from_zero, {3, 4, 3, 3, -3, -4, -3, -3}},
+      {rounding::floor, {2, 3, 2, 2, -3, -4, -3, -3}},
+      {rounding::ceiling, {3, 4, 3, 3, -2, -3, -2, -2}},
+      {rounding::half_down, {2, 3, 2, 3, -2, -3, -2, -3}},
+      {rounding::half_up, {3, 4, 2, 3, -3, -4, -2, -3}},
+      {rounding::half_even, {2, 4, 2, 3, -2, -4, -2, -3}},
+  };
+
+  for (auto const & [mode, expected] : cases)
+  {
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+      CHECK_EQ(expected[i], divide_rounded<std::int64_t>(numerators[i], 10, mode));
+      CHECK(expected[i] == divide_rounded<io1::detail::int128_t>(numerators[i], 10, mode));
+    }
+  }
+
+  static_assert(7 == divide_rounded<std::int64_t>(70, 10, rounding::half_even));
+  static_assert(-7 == divide_rounded<std::int64_t>(-65, 10, rounding::half_up));
+}
+
+TEST_CASE("Exact multiplication and division")
+{
+  static_assert(io1::money{333} == io1::muldiv(10.00_money, 1, 3));
+  static_assert(io1::money{334} == io1::muldiv(10.00_money, 1, 3, io1::rounding::ceiling));
+  static_assert(io1::money{-334} == io1::muldiv(10.00_money, -1, 3, io1::rounding::away_from_zero));
+  static_assert(io1::money{-333} == io1::muldiv(10.00_money, 1, -3, io1::rounding::half_up));
+
+  // the intermediate product does not fit in 64 bits
+  constexpr auto max = std::numeric_limits<std::int64_t>::max();
+  CHECK_EQ(io1::money{max}, io1::muldiv(io1::money{max}, max, max));
+  CHECK_EQ(io1::money{max / 3}, io1::muldiv(io1::money{max}, 1'000'000'007, 3'000'000'021));
+  CHECK_THROWS_AS((void)io1::muldiv(io1::money{max}, 3, 2), std::overflow_error);
+  CHECK_THROWS_AS((void)io1::muldiv(io1::money{max / 2 + 2}, -2, 1), std::overflow_error);
+  CHECK_EQ(io1::money{std::numeric_limits<std::int64_t>::lowest()}, io1::muldiv(io1::money{max / 2 + 1}, -2, 1));
+
+  // the lowest terms have no 64-bit opposite
+  auto const lowest = std::numeric_limits<std::int64_t>::lowest();
+  CHECK_EQ(io1::money{-1}, io1::muldiv(io1::money{2}, 1, lowest / 2, io1::rounding::floor));
+  CHECK_EQ(io1::money{-3}, io1::muldiv(io1::money{-3}, lowest, lowest));
+  CHECK_EQ(io1::money{1}, io1::muldiv(io1::money{-1}, 1, lowest, io1::rounding::ceiling));
+  CHECK_EQ(io1::money{0}, io1::muldiv(io1::money{-1}, 1, lowest, io1::rounding::floor));
+  CHECK_THROWS_AS((void)io1::muldiv(io1::money{lowest}, -1, 1), std::overflow_error);
+  CHECK_THROWS_AS((void)io1::muldiv(io1::money{1}, lowest, -1), std::overflow_error);
+}
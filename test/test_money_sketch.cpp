@@ -0,0 +1,128 @@
+#include "io1/money_sketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  // mostly small payments, a long tail of large ones and a few refunds
+  std::vector<io1::money> generate_amounts(std::size_t size)
+  {
+    std::mt19937_64 gen(42);
+    std::lognormal_distribution<double> payments(8., 1.5);
+    std::bernoulli_distribution refund(0.05);
+    std::vector<io1::money> result;
+    result.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      auto const amount = io1::money(std::llround(payments(gen)));
+      result.push_back(refund(gen) ? -amount : amount);
+    }
+    return result;
+  }
+
+  io1::money exact_quantile(std::vector<io1::money> const & sorted, double q)
+  {
+    auto const rank = std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::ceil(q * static_cast<double>(sorted.size()))), 1, sorted.size());
+    return sorted[rank - 1];
+  }
+
+  template <class Sketch>
+  void check_summary(Sketch const & sketch, std::vector<io1::money> const & sorted)
+  {
+    CHECK_EQ(sorted.size(), sketch.count());
+    CHECK_EQ(sorted.front(), sketch.min());
+    CHECK_EQ(sorted.back(), sketch.max());
+    typename Sketch::sum_type sum = 0;
+    for (auto const m : sorted) sum += m.data();
+    CHECK(sum == sketch.sum());
+  }
+
+  constexpr double quantiles[] = {0., 0.01, 0.1, 0.5, 0.9, 0.99, 0.999, 1.};
+} // namespace
+
+TEST_CASE("Histogram sketch")
+{
+  auto const values = generate_amounts(200'000);
+  auto sorted = values;
+  std::ranges::sort(sorted);
+
+  io1::money_histogram<8> histogram;
+  histogram.insert(values);
+  check_summary(histogram, sorted);
+
+  for (auto const q : quantiles)
+  {
+    auto const exact = exact_quantile(sorted, q).data();
+    auto const approx = histogram.quantile(q).data();
+    CHECK_LE(std::abs(approx - exact), std::abs(exact) / 256 + 1);
+  }
+
+  // values below 2^SignificantBits are exact
+  io1::money_histogram<8> small;
+  for (auto const m : {-3_money, 0_money, 7_money, 255_money, 255_money}) small.insert(m);
+  CHECK_EQ(-3_money, small.quantile(0.2));
+  CHECK_EQ(0_money, small.quantile(0.4));
+  CHECK_EQ(7_money, small.quantile(0.6));
+  CHECK_EQ(255_money, small.quantile(0.61));
+
+  // extreme values
+  io1::money_histogram<4> extremes;
+  extremes.insert(-9'223'372'036'854'775'807_money - 1_money);
+  extremes.insert(9'223'372'036'854'775'807_money);
+  CHECK_EQ(-9'223'372'036'854'775'807_money - 1_money, extremes.quantile(0.5));
+  CHECK_LE(9'223'372'036'854'775'807_money - extremes.quantile(1.), io1::div(9'223'372'036'854'775'807_money, 16).quot);
+  CHECK(extremes.sum() == -1);
+}
+
+TEST_CASE("KLL sketch")
+{
+  auto const values = generate_amounts(200'000);
+  auto sorted = values;
+  std::ranges::sort(sorted);
+
+  io1::money_kll_sketch<200> sketch;
+  sketch.insert(values);
+  check_summary(sketch, sorted);
+  CHECK_LT(sketch.retained(), 1000);
+
+  for (auto const q : quantiles)
+  {
+    // the rank of the answer must be close to the requested one
+    auto const approx = sketch.quantile(q);
+    auto const low = static_cast<double>(std::ranges::lower_bound(sorted, approx) - sorted.begin());
+    auto const high = static_cast<double>(std::ranges::upper_bound(sorted, approx) - sorted.begin());
+    auto const target = q * static_cast<double>(sorted.size());
+    auto const tolerance = 0.02 * static_cast<double>(sorted.size());
+    CHECK_LE(low - tolerance, target);
+    CHECK_GE(high + tolerance, target);
+  }
+}
+
+TEST_CASE("Sketch merge")
+{
+  auto const values = generate_amounts(300'000);
+  auto sorted = values;
+  std::ranges::sort(sorted);
+
+  io1::money_histogram<8> sequential;
+  sequential.insert(values);
+  auto const parallel = io1::make_sketch<io1::money_histogram<8>>(values, 4);
+  check_summary(parallel, sorted);
+  for (auto const q : quantiles) CHECK_EQ(sequential.quantile(q), parallel.quantile(q));
+
+  auto const kll = io1::make_sketch<io1::money_kll_sketch<200>>(values, 4);
+  check_summary(kll, sorted);
+  auto const median = kll.quantile(0.5);
+  auto const rank = static_cast<double>(std::ranges::lower_bound(sorted, median) - sorted.begin());
+  CHECK_LE(std::abs(rank / static_cast<double>(sorted.size()) - 0.5), 0.02);
+}
@@ -0,0 +1,83 @@
+#include "io1/money_sort.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  std::vector<io1::money> random_amounts(std::size_t size, std::int64_t low, std::int64_t high)
+  {
+    std::mt19937_64 gen(size);
+    std::uniform_int_distribution<std::int64_t> dist(low, high);
+    std::vector<io1::money> result;
+    result.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) result.emplace_back(dist(gen));
+    return result;
+  }
+} // namespace
+
+TEST_CASE("Radix sort")
+{
+  constexpr auto min = std::numeric_limits<std::int64_t>::lowest();
+  constexpr auto max = std::numeric_limits<std::int64_t>::max();
+
+  for (std::size_t const size : {0, 1, 2, 64, 65, 1000, 300'000})
+  {
+    for (std::size_t const threads : {1, 4})
+    {
+      for (auto const & [low, high] : {std::pair<std::int64_t, std::int64_t>{min, max}, {-100'00, 100'00}, {0, 255}})
+      {
+        auto values = random_amounts(size, low, high);
+        auto expected = values;
+        std::sort(expected.begin(), expected.end());
+
+        io1::radix_sort(values, threads);
+        CHECK(expected == values);
+      }
+    }
+  }
+
+  std::vector<io1::money> values{1_money, -9'223'372'036'854'775'807_money - 1_money, 0_money, -1_money,
+                                 9'223'372'036'854'775'807_money};
+  io1::radix_sort(values);
+  CHECK(std::ranges::is_sorted(values));
+  CHECK_EQ(-9'223'372'036'854'775'807_money - 1_money, values.front());
+  CHECK_EQ(9'223'372'036'854'775'807_money, values.back());
+}
+
+TEST_CASE("Radix sort with payload")
+{
+  for (std::size_t const size : {10, 1000, 300'000})
+  {
+    for (std::size_t const threads : {1, 3})
+    {
+      // few distinct amounts so that stability matters
+      auto const values = random_amounts(size, -50, 50);
+
+      auto keys = values;
+      std::vector<std::uint32_t> payload(size);
+      for (std::size_t i = 0; i < size; ++i) payload[i] = static_cast<std::uint32_t>(i);
+
+      io1::radix_sort(std::span<io1::money>(keys), std::span<std::uint32_t>(payload), threads);
+
+      std::vector<std::uint32_t> expected(payload.size());
+      for (std::size_t i = 0; i < size; ++i) expected[i] = static_cast<std::uint32_t>(i);
+      std::stable_sort(expected.begin(), expected.end(),
+                       [&values](std::uint32_t lhs, std::uint32_t rhs) { return values[lhs] < values[rhs]; });
+      CHECK(expected == payload);
+      CHECK(std::ranges::equal(keys, payload, {}, {}, [&values](std::uint32_t i) { return values[i]; }));
+
+      auto const indices = io1::radix_sort_indices(values, threads);
+      CHECK(std::ranges::equal(expected, indices));
+    }
+  }
+}
@@ -0,0 +1,164 @@
+#include "io1/money_tax.hpp"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  constexpr io1::tax_rate rates[] = {{20, 100}, {55, 1'000}, {10, 100}, {0, 100}};
+
+  struct invoice_lines
+  {
+    std::vector<std::uint64_t> invoices;
+    std::vector<std::uint16_t> rate_ids;
+    std::vector<io1::money> net;
+
+    void add(std::uint64_t invoice, std::uint16_t rate, io1::money amount)
+    {
+      invoices.push_back(invoice);
+      rate_ids.push_back(rate);
+      net.push_back(amount);
+    }
+
+    [[nodiscard]] io1::tax_result compute(io1::tax_rounding rule, std::size_t threads = 0) const
+    {
+      return io1::compute_tax(invoices, rate_ids, net, rates, rule, io1::rounding::half_even, threads);
+    }
+  };
+
+  // Lines sum to subtotals, subtotals to totals, and each line is within a unit of its own rounded tax.
+  std::size_t inconsistencies(invoice_lines const & lines, io1::tax_result const & result, io1::tax_rounding rule)
+  {
+    std::size_t count = 0;
+    std::map<std::pair<std::uint64_t, std::uint16_t>, std::pair<io1::money, io1::money>> groups;
+    for (std::size_t i = 0; i < lines.net.size(); ++i)
+    {
+      auto const & rate = rates[lines.rate_ids[i]];
+      auto const own = io1::muldiv(lines.net[i], rate.numerator, rate.denominator);
+      auto const gap = (result.tax[i] - own).data();
+      if (gap < -1 || gap > 1 || (io1::tax_rounding::per_line == rule && 0 != gap)) { ++count; }
+      if (lines.net[i] + result.tax[i] != result.gross[i]) { ++count; }
+
+      auto & group = groups[{lines.invoices[i], lines.rate_ids[i]}];
+      group.first += lines.net[i];
+      group.second += result.tax[i];
+    }
+
+    std::map<std::uint64_t, std::pair<io1::money, io1::money>> invoices;
+    for (auto const & subtotal : result.subtotals)
+    {
+      auto const & [net, tax] = groups.at({subtotal.invoice, subtotal.rate});
+      auto const & rate = rates[subtotal.rate];
+      if (net != subtotal.net || tax != subtotal.tax) { ++count; }
+      if (io1::tax_rounding::per_invoice == rule && io1::muldiv(net, rate.numerator, rate.denominator) != tax)
+      {
+        ++count;
+      }
+      invoices[subtotal.invoice].first += net;
+      invoices[subtotal.invoice].second += tax;
+    }
+    if (groups.size() != result.subtotals.size() || invoices.size() != result.totals.size()) { ++count; }
+
+    for (auto const & total : result.totals)
+    {
+      auto const & [net, tax] = invoices.at(total.invoice);
+      if (net != total.net || tax != total.tax || net + tax != total.gross) { ++count; }
+    }
+    return count;
+  }
+} // namespace
+
+TEST_CASE("Line and invoice rounding")
+{
+  invoice_lines lines;
+  lines.add(1, 2, 0.05_money);
+  lines.add(1, 2, 0.05_money);
+  lines.add(1, 0, 10.00_money);
+  lines.add(1, 2, 0.05_money);
+  lines.add(2, 1, -3.30_money);
+
+  // half a cent of tax per line: rounded per line it vanishes, on the invoice it does not
+  auto const per_line = lines.compute(io1::tax_rounding::per_line);
+  CHECK(std::vector{0_money, 0_money, 2.00_money, 0_money, -0.18_money} == per_line.tax);
+  CHECK(std::vector{0.05_money, 0.05_money, 12.00_money, 0.05_money, -3.48_money} == per_line.gross);
+  CHECK(std::vector<io1::tax_subtotal>{{.invoice = 1, .rate = 2, .net = 0.15_money, .tax = 0_money},
+                                       {.invoice = 1, .rate = 0, .net = 10.00_money, .tax = 2.00_money},
+                                       {.invoice = 2, .rate = 1, .net = -3.30_money, .tax = -0.18_money}} ==
+        per_line.subtotals);
+  CHECK(std::vector<io1::invoice_total>{{.invoice = 1, .net = 10.15_money, .tax = 2.00_money, .gross = 12.15_money},
+                                        {.invoice = 2, .net = -3.30_money, .tax = -0.18_money, .gross = -3.48_money}} ==
+        per_line.totals);
+
+  // 0.015 rounds to 0.02, given to the first lines on ties
+  auto const per_invoice = lines.compute(io1::tax_rounding::per_invoice);
+  CHECK(std::vector{0.01_money, 0.01_money, 2.00_money, 0_money, -0.18_money} == per_invoice.tax);
+  CHECK_EQ(0.02_money, per_invoice.subtotals[0].tax);
+  CHECK_EQ(2.02_money, per_invoice.totals[0].tax);
+  CHECK_EQ(12.17_money, per_invoice.totals[0].gross);
+}
+
+TEST_CASE("Rounding differences go to the lines that lost the most")
+{
+  invoice_lines lines;
+  lines.add(7, 1, 0.10_money); // 0.0055
+  lines.add(7, 1, 0.18_money); // 0.0099
+  lines.add(7, 1, 0.16_money); // 0.0088
+  lines.add(7, 1, 0.01_money); // 0.00055
+
+  // rounded per line: 0.01, 0.01, 0.01, 0, while the 0.45 sum has 0.02475 of tax
+  auto const result = lines.compute(io1::tax_rounding::per_invoice);
+  CHECK_EQ(0.02_money, result.subtotals[0].tax);
+  // one unit is taken back from the line that gained the most: 0.0055 rounded to 0.01
+  CHECK(std::vector{0_money, 0.01_money, 0.01_money, 0_money} == result.tax);
+}
+
+TEST_CASE("Taxes of a batch of invoices")
+{
+  std::mt19937_64 gen(40);
+  std::uniform_int_distribution<std::int64_t> amounts(-1'000, 100'000);
+  std::uniform_int_distribution<int> line_counts(1, 12);
+  std::uniform_int_distribution<std::size_t> rate_dist(0, std::size(rates) - 1);
+
+  invoice_lines lines;
+  for (std::uint64_t invoice = 0; invoice < 20'000; ++invoice)
+  {
+    for (auto i = line_counts(gen); 0 != i; --i)
+    {
+      lines.add(invoice * 3, static_cast<std::uint16_t>(rate_dist(gen)), io1::money{amounts(gen)});
+    }
+  }
+
+  for (auto const rule : {io1::tax_rounding::per_line, io1::tax_rounding::per_invoice})
+  {
+    auto const serial = lines.compute(rule, 1);
+    auto const parallel = lines.compute(rule, 4);
+    CHECK(serial.tax == parallel.tax);
+    CHECK(serial.gross == parallel.gross);
+    CHECK(serial.subtotals == parallel.subtotals);
+    CHECK(serial.totals == parallel.totals);
+    CHECK_EQ(0, inconsistencies(lines, parallel, rule));
+  }
+}
+
+TEST_CASE("Invalid tax rates")
+{
+  invoice_lines lines;
+  lines.add(1, 0, 1_money);
+  lines.add(1, 4, 1_money);
+  CHECK_THROWS_WITH_AS((void)lines.compute(io1::tax_rounding::per_line),
+                       "io1::compute_tax: unknown rate 4 at line 1.", std::invalid_argument);
+
+  io1::tax_rate const negative[] = {{-1, 100}};
+  std::vector<std::uint16_t> const rate_ids = {0};
+  CHECK_THROWS_AS((void)io1::compute_tax(std::vector<std::uint64_t>{1}, rate_ids, std::vector{1_money}, negative,
+                                         io1::tax_rounding::per_line),
+                  std::invalid_argument);
+}
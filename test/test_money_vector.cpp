@@ -0,0 +1,65 @@
+#include "io1/money_vector.hpp"
+
+#include <span>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  template <class L, class R>
+  concept multipliable = requires(L const & lhs, R const & rhs) { lhs * rhs; };
+} // namespace
+
+static_assert(!multipliable<io1::money_vector, io1::money_vector>, "Amounts cannot be multiplied together.");
+static_assert(!multipliable<io1::money_vector, io1::money>, "Amounts cannot be multiplied together.");
+static_assert(!multipliable<io1::money_vector, double>, "Floating factors only multiply from the left.");
+static_assert(multipliable<io1::money_vector, int>);
+static_assert(multipliable<int, io1::money_vector>);
+static_assert(multipliable<double, io1::money_vector>);
+
+TEST_CASE("Money vector arithmetic")
+{
+  io1::money_vector const gross{10.00_money, 20.00_money, -5.00_money, 0_money};
+  io1::money_vector const fees{0.50_money, 1.00_money, 0.25_money, 0_money};
+  io1::money_vector const adjustments{0.01_money, -0.02_money, 0_money, 3_money};
+
+  io1::money_vector const net = gross - fees + adjustments;
+  CHECK(io1::money_vector{9.51_money, 18.98_money, -5.25_money, 3_money} == net);
+
+  CHECK(io1::money_vector{-9.51_money, -18.98_money, 5.25_money, -3_money} == io1::money_vector(-net));
+  CHECK(io1::money_vector{20.00_money, 40.00_money, -10.00_money, 0_money} == io1::money_vector(gross * 2));
+  CHECK(io1::money_vector{30.00_money, 60.00_money, -15.00_money, 0_money} == io1::money_vector(3 * gross));
+  CHECK(io1::money_vector{19.00_money, 38.00_money, -10.50_money, 0_money} == io1::money_vector(2 * (gross - fees)));
+}
+
+TEST_CASE("Money vector rate scaling")
+{
+  io1::money_vector const amounts{1_money, 2_money, 3_money, -5_money, 12.00_money};
+  io1::money_vector const scaled = 1.2 * amounts;
+
+  REQUIRE_EQ(amounts.size(), scaled.size());
+  for (std::size_t i = 0; i < amounts.size(); ++i) CHECK_EQ(1.2 * amounts[i], scaled[i]);
+
+  io1::money_vector const discounted = 0.9 * (amounts + amounts);
+  for (std::size_t i = 0; i < amounts.size(); ++i) CHECK_EQ(0.9 * (amounts[i] + amounts[i]), discounted[i]);
+}
+
+TEST_CASE("Money vector evaluation into spans")
+{
+  std::vector<io1::money> const lhs{1_money, 2_money, 3_money};
+  std::vector<io1::money> rhs{10_money, 20_money, 30_money};
+
+  // in place update through a span
+  io1::evaluate(io1::money_column(rhs) - io1::money_column(lhs) * 2, std::span<io1::money>(rhs));
+  CHECK(std::vector<io1::money>{8_money, 16_money, 24_money} == rhs);
+
+  // assigning an expression that references the destination
+  io1::money_vector v{1_money, 2_money};
+  v = v + v;
+  CHECK(io1::money_vector{2_money, 4_money} == v);
+  v = io1::money_column(lhs) + io1::money_column(lhs);
+  CHECK(io1::money_vector{2_money, 4_money, 6_money} == v);
+}
@@ -0,0 +1,178 @@
+#include "io1/money.hpp"
+
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+
+namespace
+{
+  using int128 = io1::money128::value_type;
+
+  constexpr int128 pow10(int exponent) noexcept
+  {
+    int128 result = 1;
+    while (0 != exponent--) { result *= 10; }
+    return result;
+  }
+
+  class dollar_moneypunct : public std::moneypunct<char, false>
+  {
+  private:
+    int do_frac_digits() const override { return 2; };
+    std::string do_grouping() const override { return "\003"; };
+    std::string do_curr_symbol() const override { return "$"; };
+    std::string do_negative_sign() const override { return "-"; };
+    pattern do_pos_format() const override { return {symbol, sign, value, none}; };
+    pattern do_neg_format() const override { return {symbol, sign, value, none}; };
+  };
+} // namespace
+
+TEST_CASE("Storage widths")
+{
+  static_assert(std::is_same_v<io1::money, io1::basic_money<std::int64_t>>);
+  static_assert(sizeof(io1::money32) == 4 && sizeof(io1::money) == 8 && sizeof(io1::money128) == 16);
+  static_assert(std::is_trivial_v<io1::basic_money<std::int16_t>>);
+
+  static_assert(io1::money32{1'234} == 12.34_money32);
+  static_assert(io1::money32{std::numeric_limits<std::int32_t>::max()} == 2'147'483'647_money32);
+  static_assert(io1::money128{pow10(30)} == 1'000'000'000'000'000'000'000'000'000'000_money128);
+  static_assert(io1::money128{std::numeric_limits<int128>::max()} ==
+                170'141'183'460'469'231'731'687'303'715'884'105'727_money128);
+
+  // widening is implicit and exact
+  static_assert(std::is_convertible_v<io1::money32, io1::money>);
+  static_assert(std::is_convertible_v<io1::money, io1::money128>);
+  static_assert(!std::is_convertible_v<io1::money, io1::money32>);
+  static_assert(!std::is_constructible_v<io1::money32, io1::money>);
+  constexpr io1::money128 wide = -12.34_money32;
+  static_assert(io1::money128{-1'234} == wide);
+}
+
+TEST_CASE("Arithmetic of all widths")
+{
+  constexpr auto a = 10.50_money32;
+  static_assert(13.00_money32 == a + 2.50_money32);
+  static_assert(-10.50_money32 == -a);
+  static_assert(21.00_money32 == 2 * a);
+  static_assert(5.25_money32 == a / 2);
+  CHECK_THROWS_AS((void)(a / 4), io1::money32::InexactDivision);
+  CHECK_EQ(11.03_money32, 1.05 * a);
+  CHECK_EQ(7.00_money32, a / 1.5);
+
+  auto const d = div(10.00_money32, 3);
+  CHECK_EQ(3.33_money32, d.quot);
+  CHECK_EQ(0.01_money32, d.rem);
+
+  // amounts beyond 64 bits
+  auto const big = io1::money128{pow10(25)};
+  CHECK_EQ(io1::money128{pow10(25) * 3}, big * 3);
+  CHECK_EQ(io1::money128{pow10(25) + 1}, big + 1_money128);
+  CHECK_EQ(io1::money128{pow10(24) * 15}, 1.5 * big);
+  CHECK_EQ(io1::money128{pow10(24) * 5}, big / 2);
+  CHECK(big > io1::money128{io1::money{std::numeric_limits<std::int64_t>::max()}});
+
+  auto const wide_div = div(big + 1_money128, int128{10});
+  CHECK_EQ(io1::money128{pow10(24)}, wide_div.quot);
+  CHECK_EQ(1_money128, wide_div.rem);
+}
+
+TEST_CASE("Checked conversions")
+{
+  CHECK_EQ(12.34_money32, io1::money_cast<io1::money32>(12.34_money));
+  CHECK_EQ(io1::money32{std::numeric_limits<std::int32_t>::lowest()},
+           io1::money_cast<io1::money32>(io1::money{std::numeric_limits<std::int32_t>::lowest()}));
+  CHECK_THROWS_AS((void)io1::money_cast<io1::money32>(io1::money{std::numeric_limits<std::int32_t>::max() + 1LL}),
+                  std::overflow_error);
+  CHECK_THROWS_AS((void)io1::money_cast<io1::money>(io1::money128{pow10(20)}), std::overflow_error);
+  CHECK_EQ(-1_money, io1::money_cast<io1::money>(-1_money128));
+  CHECK_EQ(1_money128, io1::money_cast<io1::money128>(1_money32));
+}
+
+TEST_CASE("Batch narrowing")
+{
+  std::vector<io1::money> prices(1'000);
+  for (std::size_t i = 0; i < prices.size(); ++i)
+  {
+    prices[i] = io1::money{static_cast<std::int64_t>(i) * 997 - 50'000};
+  }
+
+  std::vector<io1::money32> compact(prices.size());
+  io1::money_cast<io1::money32>(prices, compact);
+  CHECK(std::ranges::equal(prices, compact, {}, &io1::money::data, &io1::money32::data));
+
+  std::vector<io1::money128> wide(prices.size());
+  io1::money_cast<io1::money128>(compact, wide);
+  CHECK(std::ranges::equal(prices, wide, {}, &io1::money::data, &io1::money128::data));
+
+  // nothing is written when an amount does not fit
+  prices[700] = io1::money{std::numeric_limits<std::int64_t>::lowest()};
+  std::vector<io1::money32> untouched(prices.size(), 1_money32);
+  CHECK_THROWS_WITH_AS(io1::money_cast<io1::money32>(prices, untouched),
+                       "io1::money_cast: amount at index 700 out of range.", std::overflow_error);
+  CHECK(std::ranges::all_of(untouched, [](io1::money32 m) { return 1_money32 == m; }));
+}
+
+TEST_CASE("Stream and format of all widths")
+{
+  auto const big = io1::money128{-pow10(30) - 5};
+
+  std::stringstream stream;
+  stream << big << ' ' << 12.34_money32;
+  CHECK_EQ("-1000000000000000000000000000005 1234", stream.str());
+
+  io1::money128 parsed{0};
+  io1::money32 small{0};
+  stream >> parsed >> small;
+  CHECK_EQ(big, parsed);
+  CHECK_EQ(12.34_money32, small);
+
+  std::istringstream too_big("170141183460469231731687303715884105728");
+  too_big >> parsed;
+  CHECK(too_big.fail());
+  CHECK_EQ(big, parsed);
+
+  CHECK_EQ("-1000000000000000000000000000005", std::format("{}", big));
+  CHECK_EQ("   1234", std::format("{:>7}", 12.34_money32));
+  CHECK_EQ("-10,000,000,000,000,000,000,000,000,000.05", std::format("{:pen_US}", big));
+
+  // the integer specifications of the standard
+  CHECK_EQ("-1000000000000000000000000000005", std::format("{:d}", big));
+  CHECK_EQ("+1234", std::format("{:+}", 12.34_money128));
+  CHECK_EQ(" 1234", std::format("{: d}", 12.34_money128));
+  CHECK_EQ("-0001234", std::format("{:08}", -12.34_money128));
+  CHECK_EQ("0x004d2", std::format("{:#07x}", 12.34_money128));
+  CHECK_EQ("-0X4D2", std::format("{:#X}", -12.34_money128));
+  CHECK_EQ("0b10011010010", std::format("{:#b}", 12.34_money128));
+  CHECK_EQ("02322 0 0", std::format("{:#o} {:#o} {:o}", 12.34_money128, 0_money128, 0_money128));
+  CHECK_EQ("**1234|1234    |  1234  ", std::format("{:*>6}|{:<8}|{:^8}", 12.34_money128, 12.34_money128,
+                                                   12.34_money128));
+  CHECK_EQ("    1234", std::format("{:8}", 12.34_money128));
+  CHECK_EQ("     +1234", std::format("{:>+010}", 12.34_money128));
+  CHECK_EQ("-80000000000000000000000000000000",
+           std::format("{:x}", io1::money128{std::numeric_limits<io1::money128::value_type>::min()}));
+  CHECK_THROWS_AS((void)std::vformat("{:.2}", std::make_format_args(big)), std::format_error);
+  CHECK_THROWS_AS((void)std::vformat("{:Ld}", std::make_format_args(big)), std::format_error);
+
+  std::locale const dollars(std::locale::classic(), new dollar_moneypunct);
+  CHECK_EQ("$-10,000,000,000,000,000,000,000,000,000.05", std::format(dollars, "{:#m}", big));
+  CHECK_EQ("$12.34", std::format(dollars, "{:#m}", 12.34_money32));
+
+  std::stringstream money_stream;
+  money_stream.imbue(dollars);
+  money_stream << io1::put_money(big);
+  CHECK_EQ("-10,000,000,000,000,000,000,000,000,000.05", money_stream.str());
+  io1::money128 read{0};
+  money_stream >> io1::get_money(read);
+  CHECK_EQ(big, read);
+}
@@ -0,0 +1,151 @@
+#include "io1/money_window.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+using namespace io1::literals;
+using namespace std::chrono_literals;
+
+namespace
+{
+  using time_point = io1::money_window<int>::time_point;
+
+  struct event
+  {
+    int key;
+    time_point time;
+    io1::money amount;
+  };
+
+  // Totals of the accepted events in [end - width, end), the slow way.
+  io1::window_total brute_force(std::vector<event> const & accepted, int key, time_point end,
+                                std::chrono::milliseconds width)
+  {
+    io1::window_total total;
+    for (auto const & e : accepted)
+    {
+      if (e.key == key && end - width <= e.time && e.time < end)
+      {
+        total.sum += e.amount.data();
+        ++total.count;
+      }
+    }
+    return total;
+  }
+} // namespace
+
+TEST_CASE("Tumbling windows")
+{
+  io1::money_window<std::string> window({.width = 1min, .step = 1min, .lateness = 10s});
+  time_point const t0{std::chrono::hours{24 * 365}};
+
+  CHECK_EQ(time_point::min(), window.closed_until());
+  CHECK(window.add("a", t0 + 5s, 1.00_money));
+  CHECK(window.add("b", t0 + 30s, 2.00_money));
+  CHECK(window.add("a", t0 + 65s, 4.00_money));
+  CHECK_EQ(t0, window.closed_until());
+  CHECK_EQ(io1::window_total{}, window.total("a"));
+
+  // late by less than the lateness: still counted
+  CHECK(window.add("a", t0 + 58s, 8.00_money));
+  window.advance(t0 + 70s);
+  CHECK_EQ(t0 + 1min, window.closed_until());
+  CHECK_EQ((io1::window_total{.sum = 900, .count = 2}), window.total("a"));
+  CHECK_EQ((io1::window_total{.sum = 200, .count = 1}), window.total("b"));
+  CHECK_EQ(io1::window_total{}, window.total("c"));
+
+  // too late
+  CHECK_FALSE(window.add("a", t0 + 59s, 16.00_money));
+  CHECK_EQ(1, window.dropped());
+  CHECK_EQ((io1::window_total{.sum = 900, .count = 2}), window.total("a"));
+
+  std::map<std::string, io1::window_total> totals;
+  window.for_each([&totals](std::string const & key, io1::window_total const & total) { totals[key] = total; });
+  CHECK_EQ(2, totals.size());
+
+  window.advance(t0 + 2min + 10s);
+  CHECK_EQ((io1::window_total{.sum = 400, .count = 1}), window.total("a"));
+  CHECK_EQ(io1::window_total{}, window.total("b"));
+  totals.clear();
+  window.for_each([&totals](std::string const & key, io1::window_total const & total) { totals[key] = total; });
+  CHECK_EQ(1, totals.size());
+
+  // idle keys are forgotten and their memory reused
+  CHECK_EQ(1, window.expire());
+  CHECK_EQ(1, window.size());
+  CHECK(window.add("c", t0 + 2min + 10s, 1_money));
+  window.advance(t0 + 10min);
+  CHECK_EQ(2, window.expire());
+  CHECK_EQ(0, window.size());
+
+  CHECK_THROWS_AS(io1::money_window<int>({.width = 1min, .step = 7s}), std::invalid_argument);
+  CHECK_THROWS_AS(io1::money_window<int>({.width = 1min, .step = 0s}), std::invalid_argument);
+  CHECK_THROWS_AS(io1::money_window<int>({.width = 1min, .step = 1s, .lateness = -1s}), std::invalid_argument);
+}
+
+TEST_CASE("Same totals as brute force")
+{
+  std::mt19937_64 gen(49);
+  for (auto const options : {io1::window_options{.width = 60ms, .step = 60ms, .lateness = 0ms},
+                             io1::window_options{.width = 60ms, .step = 10ms, .lateness = 25ms},
+                             io1::window_options{.width = 100ms, .step = 1ms, .lateness = 200ms}})
+  {
+    io1::money_window<int> window(options);
+    window.reserve(10);
+    std::vector<event> accepted;
+    std::uniform_int_distribution<int> keys(0, 9);
+    std::uniform_int_distribution<std::int64_t> jitter(-300, 30);
+    std::uniform_int_distribution<std::int64_t> amounts(-1'000'000, 1'000'000);
+
+    auto now = time_point{-5'000ms}; // panes before the epoch too
+    auto latest = time_point::min();
+    for (int i = 0; i < 5'000; ++i)
+    {
+      event const e{keys(gen), now + std::chrono::milliseconds{jitter(gen)}, io1::money{amounts(gen)}};
+      auto const late = time_point::min() != latest && e.time < latest - options.lateness;
+      CHECK_EQ(!late, window.add(e.key, e.time, e.amount));
+      if (!late)
+      {
+        accepted.push_back(e);
+        latest = std::max(latest, e.time);
+      }
+      now += 1ms;
+      if (0 == i % 7)
+      {
+        auto const time = now + std::chrono::milliseconds{jitter(gen) + 20};
+        window.advance(time);
+        latest = std::max(latest, time);
+      }
+      if (0 == i % 97) { window.expire(); }
+
+      if (0 == i % 5)
+      {
+        auto const key = keys(gen);
+        CHECK_EQ(brute_force(accepted, key, window.closed_until(), options.width), window.total(key));
+      }
+    }
+    CHECK_EQ(5'000 - accepted.size(), window.dropped());
+  }
+}
+
+TEST_CASE("Totals beyond the range of amounts")
+{
+  io1::money_window<int> window({.width = 1h, .step = 1min});
+  auto const max = io1::money{std::numeric_limits<std::int64_t>::max()};
+  for (int i = 0; i < 60; ++i)
+  {
+    window.add(1, time_point{std::chrono::minutes{i}}, max);
+    window.add(1, time_point{std::chrono::minutes{i}}, max);
+  }
+  window.advance(time_point{1h});
+  auto const sum = 120 * static_cast<io1::money128::value_type>(max.data());
+  CHECK_EQ((io1::window_total{.sum = sum, .count = 120}), window.total(1));
+}